@@ -0,0 +1,76 @@
+/**
+ * Tests the commands that expose the files of a WiredTiger backup cursor to a syncing node:
+ * replSetBeginBackup, replSetReadBackupFile and replSetEndBackup.
+ */
+(function() {
+    "use strict";
+
+    // This test can only be run if the storageEngine is wiredTiger
+    if (jsTest.options().storageEngine && jsTest.options().storageEngine !== "wiredTiger") {
+        jsTestLog("Skipping test because storageEngine is not wiredTiger");
+        return;
+    }
+
+    var rst = new ReplSetTest({nodes: 1});
+    rst.startSet();
+    rst.initiate();
+
+    var primary = rst.getPrimary();
+    var adminDB = primary.getDB("admin");
+    assert.writeOK(primary.getDB("test").foo.insert({x: 1}, {writeConcern: {w: 1, j: true}}));
+
+    // Nothing can be read before the backup has started.
+    assert.commandFailedWithCode(
+        adminDB.runCommand({replSetReadBackupFile: "WiredTiger", offset: 0}),
+        ErrorCodes.IllegalOperation);
+
+    var res = assert.commandWorked(adminDB.runCommand({replSetBeginBackup: 1}));
+    assert(res.lastAppliedOpTime, tojson(res));
+    assert.gt(res.files.length, 0, tojson(res));
+
+    // Only one backup may be in progress, including one started by fsyncLock.
+    assert.commandFailedWithCode(adminDB.runCommand({replSetBeginBackup: 1}),
+                                 ErrorCodes.IllegalOperation);
+    assert.commandFailed(adminDB.runCommand({fsync: 1, lock: 1}));
+    assert(!adminDB.currentOp().fsyncLock);
+
+    // Every file can be read to the end in chunks.
+    res.files.forEach(function(file) {
+        var offset = 0;
+        var eof = false;
+        while (!eof) {
+            var chunk = assert.commandWorked(adminDB.runCommand(
+                {replSetReadBackupFile: file.filename, offset: offset, length: 64 * 1024}));
+            offset += chunk.data.length();
+            eof = chunk.eof;
+        }
+        assert.gte(offset, file.fileSize, tojson(file));
+    });
+
+    // Files outside of the backup cannot be read.
+    assert.commandFailedWithCode(
+        adminDB.runCommand({replSetReadBackupFile: "mongod.lock", offset: 0}), ErrorCodes.BadValue);
+    assert.commandFailedWithCode(
+        adminDB.runCommand({replSetReadBackupFile: "../mongod.lock", offset: 0}),
+        ErrorCodes.BadValue);
+
+    assert.commandWorked(adminDB.runCommand({replSetEndBackup: 1}));
+    assert.commandFailedWithCode(adminDB.runCommand({replSetEndBackup: 1}),
+                                 ErrorCodes.IllegalOperation);
+
+    // Writes and fsyncLock work again once the backup has ended.
+    assert.commandWorked(adminDB.runCommand({fsync: 1, lock: 1}));
+    assert.commandWorked(adminDB.fsyncUnlock());
+
+    // A backup whose files are no longer read is ended once its lease runs out.
+    assert.commandWorked(adminDB.runCommand({setParameter: 1, replSetBackupLeaseSecs: 1}));
+    assert.commandWorked(adminDB.runCommand({replSetBeginBackup: 1}));
+    assert.soon(function() {
+        return adminDB.runCommand({fsync: 1, lock: 1}).ok;
+    }, "backup was not ended after its lease ran out", 5 * 60 * 1000);
+    assert.commandWorked(adminDB.fsyncUnlock());
+    assert.commandFailedWithCode(adminDB.runCommand({replSetEndBackup: 1}),
+                                 ErrorCodes.IllegalOperation);
+
+    rst.stopSet();
+})();
@@ -24,10 +24,26 @@ function testSecondaryMetrics(secondary, opCount, offset) {
     assert(ss.metrics.repl.preload.docs.totalMillis >= 0, "preload.docs time missing");
     assert(ss.metrics.repl.preload.docs.num >= 0, "preload.indexes num missing");
     assert(ss.metrics.repl.preload.indexes.totalMillis >= 0, "preload.indexes time missing");
+    assert(ss.metrics.repl.preload.nextBatch.hits >= 0, "preload.nextBatch.hits missing");
+    assert(ss.metrics.repl.preload.nextBatch.misses >= 0, "preload.nextBatch.misses missing");
 
     assert(ss.metrics.repl.apply.batches.num > 0, "no batches");
     assert(ss.metrics.repl.apply.batches.totalMillis >= 0, "missing batch time");
     assert.eq(ss.metrics.repl.apply.ops, opCount + offset, "wrong number of applied ops");
+    assert(ss.metrics.repl.apply.opsCoalesced >= 0, "opsCoalesced missing");
+
+    var pipeline = ss.metrics.repl.apply.pipeline;
+    ["batchFormation",
+     "batcherWaitingForApplier",
+     "applierWaitingForBatch",
+     "writerAssignment",
+     "oplogWrite",
+     "apply",
+     "finalize"]
+        .forEach(function(stage) {
+            assert(pipeline[stage].num > 0, "no batches through pipeline stage " + stage);
+            assert(pipeline[stage].totalMillis >= 0, "missing time for pipeline stage " + stage);
+        });
 }
 
 var rt = new ReplSetTest({name: "server_status_metrics", nodes: 2, oplogSize: 100});
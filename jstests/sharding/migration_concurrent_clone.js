@@ -0,0 +1,149 @@
+//
+// Tests that the recipient of a migration clones the chunk over several concurrent streams
+// (migrateCloneConcurrency > 1) and that the migration stays correct when one of the streams fails,
+// when the migration is aborted in the middle of the clone and when a document is deleted after a
+// stream has claimed its record id, but before it has read it.
+//
+
+load('./jstests/libs/chunk_manipulation_util.js');
+
+(function() {
+    'use strict';
+
+    var staticMongod = MongoRunner.runMongod({});  // For startParallelOps.
+
+    var st = new ShardingTest({shards: 2, mongos: 1});
+
+    var mongos = st.s0;
+    var admin = mongos.getDB("admin");
+    var coll = mongos.getCollection("db.coll");
+
+    assert.commandWorked(admin.runCommand({enableSharding: coll.getDB() + ""}));
+    st.ensurePrimaryShard(coll.getDB() + "", st.shard0.shardName);
+    assert.commandWorked(admin.runCommand({shardCollection: coll + "", key: {_id: 1}}));
+
+    // Documents of 1MB each, so that the chunk is cloned in several batches, which the streams
+    // claim concurrently
+    var numDocs = 64;
+    var payload = new Array(1024 * 1024).join('x');
+    for (var i = 0; i < numDocs; i++) {
+        assert.writeOK(coll.insert({_id: i, payload: payload}));
+    }
+
+    assert.commandWorked(
+        st.shard1.adminCommand({setParameter: 1, migrateCloneConcurrency: 4}));
+
+    var moveChunkCmd = {moveChunk: coll + "", find: {_id: 0}, to: st.shard1.shardName};
+
+    var isMigrateCloneOp = function(op) {
+        var cmd = op.query || op.command;
+        return cmd && cmd._migrateClone;
+    };
+
+    var waitForMigrateCloneOp = function() {
+        assert.soon(function() {
+            return st.shard0.getDB('admin').currentOp().inprog.some(isMigrateCloneOp);
+        }, "the recipient never started cloning");
+    };
+
+    var assertChunkOnShard = function(shard) {
+        assert.eq(1,
+                  mongos.getDB("config").chunks.count({ns: coll + "", shard: shard.shardName}));
+    };
+
+    var waitForRecipientToBeInactive = function() {
+        assert.soon(function() {
+            return !st.shard1.adminCommand({_recvChunkStatus: 1}).active;
+        }, "the recipient never finished the migration");
+    };
+
+    jsTest.log("A failing stream fails the migration and stops the other streams");
+
+    assert.commandWorked(st.shard1.adminCommand(
+        {configureFailPoint: 'failMigrateCloneStream', mode: {times: 1}}));
+
+    assert.commandFailed(admin.runCommand(moveChunkCmd));
+
+    assert.commandWorked(
+        st.shard1.adminCommand({configureFailPoint: 'failMigrateCloneStream', mode: 'off'}));
+
+    waitForRecipientToBeInactive();
+
+    // The donor aborts the migration once it sees the failure, which may overwrite the state
+    var recipientStatus = st.shard1.adminCommand({_recvChunkStatus: 1});
+    assert.contains(recipientStatus.state, ["fail", "abort"], tojson(recipientStatus));
+
+    assertChunkOnShard(st.shard0);
+    assert.eq(numDocs, coll.count());
+
+    jsTest.log("Aborting the migration in the middle of the clone stops all streams");
+
+    assert.commandWorked(st.shard0.adminCommand(
+        {configureFailPoint: 'migrateCloneHangAfterClaimingBatch', mode: 'alwaysOn'}));
+
+    var joinAbortedMoveChunk = startParallelShell(
+        'assert.commandFailed(db.adminCommand(' + tojson(moveChunkCmd) + '));', st.s0.port);
+
+    waitForMigrateCloneOp();
+
+    // Interrupting the donor makes it abort the migration on the recipient, while the streams are
+    // still waiting for their batches
+    var moveChunkOps = st.shard0.getDB('admin').currentOp().inprog.filter(function(op) {
+        return op.query && op.query.moveChunk;
+    });
+    assert.eq(1, moveChunkOps.length, tojson(moveChunkOps));
+    assert.commandWorked(st.shard0.getDB('admin').killOp(moveChunkOps[0].opid));
+
+    assert.soon(function() {
+        return st.shard1.adminCommand({_recvChunkStatus: 1}).state == "abort";
+    }, "the recipient never aborted the migration");
+
+    assert.commandWorked(st.shard0.adminCommand(
+        {configureFailPoint: 'migrateCloneHangAfterClaimingBatch', mode: 'off'}));
+
+    joinAbortedMoveChunk();
+    waitForRecipientToBeInactive();
+
+    assert.eq("abort", st.shard1.adminCommand({_recvChunkStatus: 1}).state);
+    assertChunkOnShard(st.shard0);
+    assert.eq(numDocs, coll.count());
+
+    jsTest.log("A document deleted after its record id was claimed is not cloned");
+
+    assert.commandWorked(st.shard0.adminCommand(
+        {configureFailPoint: 'migrateCloneHangAfterClaimingBatch', mode: 'alwaysOn'}));
+
+    var joinMoveChunk = moveChunkParallel(
+        staticMongod, st.s0.host, {_id: 0}, null, coll.getFullName(), st.shard1.shardName);
+
+    waitForMigrateCloneOp();
+
+    // The first batch starts with the first inserted document. Storage engines without document
+    // level locking block the delete until the batch has been read, so only wait for it to start.
+    var joinDelete = startParallelShell(
+        'assert.writeOK(db.getSiblingDB("db").coll.remove({_id: 0}));', st.s0.port);
+
+    assert.soon(function() {
+        if (st.shard0.getDB('db').coll.count({_id: 0}) == 0) {
+            return true;
+        }
+
+        return st.shard0.getDB('admin').currentOp().inprog.some(function(op) {
+            return op.op == "remove" && op.ns == coll + "" && op.waitingForLock;
+        });
+    }, "the document was never deleted");
+
+    assert.commandWorked(st.shard0.adminCommand(
+        {configureFailPoint: 'migrateCloneHangAfterClaimingBatch', mode: 'off'}));
+
+    joinDelete();
+    joinMoveChunk();
+
+    assertChunkOnShard(st.shard1);
+    assert.eq(numDocs - 1, coll.count());
+    assert.eq(numDocs - 1, st.shard1.getDB('db').coll.count());
+    assert.eq(null, st.shard1.getDB('db').coll.findOne({_id: 0}));
+
+    st.stop();
+
+})();
@@ -1,6 +1,6 @@
 //
 // Tests that serverStatus includes a migration status when called on the source shard of an active
-// migration.
+// migration and one for each of several concurrent migrations of the same collection.
 //
 
 load('./jstests/libs/chunk_manipulation_util.js');
@@ -10,7 +10,7 @@ load('./jstests/libs/chunk_manipulation_util.js');
 
     var staticMongod = MongoRunner.runMongod({});  // For startParallelOps.
 
-    var st = new ShardingTest({shards: 2, mongos: 1});
+    var st = new ShardingTest({shards: 3, mongos: 1});
 
     var mongos = st.s0;
     var admin = mongos.getDB("admin");
@@ -48,6 +48,9 @@ load('./jstests/libs/chunk_manipulation_util.js');
     // Source shard should return a migration status.
     var shard0ServerStatus = st.shard0.getDB('admin').runCommand({serverStatus: 1});
     assert(shard0ServerStatus.sharding.migrations);
+    assert.eq(1, shard0ServerStatus.sharding.activeMigrations.length);
+    assert.eq(shard0ServerStatus.sharding.migrations,
+              shard0ServerStatus.sharding.activeMigrations[0]);
     assertMigrationStatusOnServerStatus(shard0ServerStatus,
                                         st.shard0.shardName,
                                         st.shard1.shardName,
@@ -70,6 +73,47 @@ load('./jstests/libs/chunk_manipulation_util.js');
     // Migration is over, should no longer get a migration status.
     var shard0ServerStatus = st.shard0.getDB('admin').runCommand({serverStatus: 1});
     assert(!shard0ServerStatus.sharding.migrations);
+    assert(!shard0ServerStatus.sharding.activeMigrations);
+
+    // Disjoint chunks of the same collection can be donated concurrently and each of them is
+    // reported.
+    assert.commandWorked(
+        st.shard0.adminCommand({setParameter: 1, maxConcurrentOutgoingMigrations: 2}));
+    assert.commandWorked(admin.runCommand({split: coll + "", middle: {_id: -10}}));
+
+    pauseMoveChunkAtStep(st.shard0, moveChunkStepNames.startedMoveChunk);
+
+    var joinFirstMoveChunk = moveChunkParallel(
+        staticMongod, st.s0.host, {_id: -20}, null, coll.getFullName(), st.shard1.shardName);
+    var joinSecondMoveChunk = moveChunkParallel(
+        staticMongod, st.s0.host, {_id: -5}, null, coll.getFullName(), st.shard2.shardName);
+
+    assert.soon(function() {
+        shard0ServerStatus = st.shard0.getDB('admin').runCommand({serverStatus: 1});
+        return shard0ServerStatus.sharding.activeMigrations &&
+            shard0ServerStatus.sharding.activeMigrations.length == 2;
+    }, "both migrations should be reported as active");
+
+    assert(shard0ServerStatus.sharding.migrations);
+    var reportedChunks = shard0ServerStatus.sharding.activeMigrations.map(function(migration) {
+        assert.eq(st.shard0.shardName, migration.source);
+        assert.eq(true, migration.isDonorShard);
+        assert.eq(coll + "", migration.collection);
+        return tojson(migration.chunk.min) + " -> " + migration.destination;
+    }).sort();
+    assert.eq([tojson({"_id": {"$minKey": 1}}) + " -> " + st.shard1.shardName,
+               tojson({"_id": -10}) + " -> " + st.shard2.shardName].sort(),
+              reportedChunks);
+
+    unpauseMoveChunkAtStep(st.shard0, moveChunkStepNames.startedMoveChunk);
+    joinFirstMoveChunk();
+    joinSecondMoveChunk();
+
+    shard0ServerStatus = st.shard0.getDB('admin').runCommand({serverStatus: 1});
+    assert(!shard0ServerStatus.sharding.migrations);
+    assert(!shard0ServerStatus.sharding.activeMigrations);
+
+    assert.eq(0, mongos.getDB("config").chunks.count({ns: coll + "", shard: st.shard0.shardName}));
 
     st.stop();
 
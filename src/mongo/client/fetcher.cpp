@@ -338,6 +338,8 @@ void Fetcher::_callback(const RemoteCommandCallbackArgs& rcbd, const char* batch
 
     batchData.otherFields.metadata = std::move(rcbd.response.metadata);
     batchData.elapsedMillis = rcbd.response.elapsedMillis.value_or(Milliseconds{0});
+    batchData.compressedSizeBytes = rcbd.response.compressedSizeBytes;
+    batchData.decompressedSizeBytes = rcbd.response.decompressedSizeBytes;
     {
         stdx::lock_guard<stdx::mutex> lk(_mutex);
         batchData.first = _first;
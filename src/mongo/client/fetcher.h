@@ -73,6 +73,11 @@ public:
         } otherFields;
         Milliseconds elapsedMillis = Milliseconds(0);
         bool first = false;
+
+        // Sizes in bytes of the reply as read from the network and after decompression. Both are
+        // zero unless the reply arrived compressed.
+        int compressedSizeBytes = 0;
+        int decompressedSizeBytes = 0;
     };
 
     using QueryResponseStatus = StatusWith<Fetcher::QueryResponse>;
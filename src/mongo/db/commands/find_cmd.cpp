@@ -380,6 +380,7 @@ public:
         // expected collection version
         auto css = CollectionShardingState::get(txn, nss);
         css->checkShardVersionOrThrow(txn);
+        css->onReadOp(txn, *exec->getCanonicalQuery());
 
         // Set up the cursor for getMore.
         CursorId cursorId = 0;
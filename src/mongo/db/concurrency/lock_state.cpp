@@ -269,6 +269,12 @@ void Locker::setGlobalThrottling(class TicketHolder* reading, class TicketHolder
     ticketHolders[MODE_IX] = writing;
 }
 
+/* static */
+bool Locker::areWriteTicketsExhausted() {
+    TicketHolder* holder = ticketHolders[MODE_IX];
+    return holder && holder->available() <= 0;
+}
+
 template <bool IsForMMAPV1>
 LockerImpl<IsForMMAPV1>::LockerImpl() : _id(idCounter.addAndFetch(1)), _wuowNestingLevel(0) {}
 
@@ -69,6 +69,12 @@ public:
      */
     static void setGlobalThrottling(class TicketHolder* reading, class TicketHolder* writing);
 
+    /**
+     * Returns whether every ticket for global lock attempts in MODE_IX is in use, so that further
+     * writers have to queue. Always false if throttling has not been set up.
+     */
+    static bool areWriteTicketsExhausted();
+
     /**
      * State for reporting the number of active and queued reader and writer clients.
      */
@@ -37,6 +37,8 @@
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/index_create.h"
+#include "mongo/db/concurrency/locker.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/exec/working_set_common.h"
@@ -54,6 +56,7 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/range_arithmetic.h"
+#include "mongo/db/range_deletion_pacer.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/s/collection_metadata.h"
@@ -69,6 +72,7 @@
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -82,6 +86,29 @@ using std::stringstream;
 
 using logger::LogComponent;
 
+namespace {
+
+/**
+ * Returns how far the majority of the replica set is behind the writes this node has applied, or
+ * zero if this node is not a member of a replica set. Optimes carry seconds, so this is as precise.
+ */
+Milliseconds getMajorityReplicationLag(OperationContext* txn) {
+    auto replCoord = repl::ReplicationCoordinator::get(txn);
+    if (replCoord->getReplicationMode() != repl::ReplicationCoordinator::modeReplSet) {
+        return Milliseconds(0);
+    }
+
+    const repl::OpTime lastApplied = replCoord->getMyLastAppliedOpTime();
+    const repl::OpTime lastCommitted = replCoord->getLastCommittedOpTime();
+    if (lastCommitted.isNull() || lastApplied <= lastCommitted) {
+        return Milliseconds(0);
+    }
+
+    return Seconds(lastApplied.getTimestamp().getSecs() - lastCommitted.getTimestamp().getSecs());
+}
+
+}  // namespace
+
 void Helpers::ensureIndex(OperationContext* txn,
                           Collection* collection,
                           BSONObj keyPattern,
@@ -355,9 +382,29 @@ long long Helpers::removeRange(OperationContext* txn,
 
     Milliseconds millisWaitingForReplication{0};
 
-    while (1) {
-        // Scoping for write lock.
-        {
+    // Documents are deleted in batches, each in a single storage transaction, sized by the pacer
+    RangeDeletionPacer pacer(ns);
+
+    // Where the next batch resumes scanning the index. Documents before it have been deleted
+    // already, so starting over at 'min' would walk past their index entries again.
+    BSONObj resumeMin = min;
+    const ShardKeyPattern shardKeyPattern(range.keyPattern);
+
+    bool finished = false;
+    while (!finished) {
+        // The index scan below does not yield, so this is where the deletion can be killed
+        txn->checkForInterrupt();
+
+        int batchDocs = 0;
+        long long batchBytes = 0;
+
+        // Scoping for write lock. A write conflict rolls back the whole batch, which is then
+        // retried from where it started.
+        MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+            batchDocs = 0;
+            batchBytes = 0;
+            finished = false;
+
             AutoGetCollection ctx(txn, NamespaceString(ns), MODE_IX, MODE_IX);
             Collection* collection = ctx.getCollection();
             if (!collection)
@@ -371,92 +418,127 @@ long long Helpers::removeRange(OperationContext* txn,
                 return -1;
             }
 
+            // The lock is held for the whole batch, so the scan must not yield
             unique_ptr<PlanExecutor> exec(
                 InternalPlanner::indexScan(txn,
                                            collection,
                                            desc,
-                                           min,
+                                           resumeMin,
                                            max,
                                            boundInclusion,
                                            PlanExecutor::YIELD_MANUAL,
                                            InternalPlanner::FORWARD,
                                            InternalPlanner::IXSCAN_FETCH));
-            exec->setYieldPolicy(PlanExecutor::YIELD_AUTO, collection);
-
-            RecordId rloc;
-            BSONObj obj;
-            PlanExecutor::ExecState state;
-            // This may yield so we cannot touch nsd after this.
-            state = exec->getNext(&obj, &rloc);
-            if (PlanExecutor::IS_EOF == state) {
-                break;
-            }
-
-            if (PlanExecutor::FAILURE == state || PlanExecutor::DEAD == state) {
-                warning(LogComponent::kSharding)
-                    << PlanExecutor::statestr(state) << " - cursor error while trying to delete "
-                    << min << " to " << max << " in " << ns << ": "
-                    << WorkingSetCommon::toStatusString(obj)
-                    << ", stats: " << Explain::getWinningPlanStats(exec.get()) << endl;
-                break;
-            }
-
-            verify(PlanExecutor::ADVANCED == state);
 
             WriteUnitOfWork wuow(txn);
 
-            if (onlyRemoveOrphanedDocs) {
-                // Do a final check in the write lock to make absolutely sure that our
-                // collection hasn't been modified in a way that invalidates our migration
-                // cleanup.
-
-                // We should never be able to turn off the sharding state once enabled, but
-                // in the future we might want to.
-                verify(ShardingState::get(txn)->enabled());
-
-                bool docIsOrphan;
-
-                // In write lock, so will be the most up-to-date version
-                auto metadataNow = CollectionShardingState::get(txn, ns)->getMetadata();
-                if (metadataNow) {
-                    ShardKeyPattern kp(metadataNow->getKeyPattern());
-                    BSONObj key = kp.extractShardKeyFromDoc(obj);
-                    docIsOrphan =
-                        !metadataNow->keyBelongsToMe(key) && !metadataNow->keyIsPending(key);
-                } else {
-                    docIsOrphan = false;
+            BSONObj lastDeleted;
+            while (!pacer.isBatchFull(batchDocs, batchBytes)) {
+                RecordId rloc;
+                BSONObj obj;
+                PlanExecutor::ExecState state = exec->getNext(&obj, &rloc);
+                if (PlanExecutor::IS_EOF == state) {
+                    finished = true;
+                    break;
                 }
 
-                if (!docIsOrphan) {
+                if (PlanExecutor::FAILURE == state || PlanExecutor::DEAD == state) {
                     warning(LogComponent::kSharding)
-                        << "aborting migration cleanup for chunk " << min << " to " << max
-                        << (metadataNow ? (string) " at document " + obj.toString() : "")
-                        << ", collection " << ns << " has changed " << endl;
+                        << PlanExecutor::statestr(state)
+                        << " - cursor error while trying to delete " << min << " to " << max
+                        << " in " << ns << ": " << WorkingSetCommon::toStatusString(obj)
+                        << ", stats: " << Explain::getWinningPlanStats(exec.get()) << endl;
+                    finished = true;
                     break;
                 }
-            }
 
-            NamespaceString nss(ns);
-            if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesFor(nss)) {
-                warning() << "stepped down from primary while deleting chunk; "
-                          << "orphaning data in " << ns << " in range [" << redact(min) << ", "
-                          << redact(max) << ")";
-                return numDeleted;
-            }
+                verify(PlanExecutor::ADVANCED == state);
+
+                if (onlyRemoveOrphanedDocs) {
+                    // Do a final check in the write lock to make absolutely sure that our
+                    // collection hasn't been modified in a way that invalidates our migration
+                    // cleanup.
+
+                    // We should never be able to turn off the sharding state once enabled, but
+                    // in the future we might want to.
+                    verify(ShardingState::get(txn)->enabled());
+
+                    bool docIsOrphan;
+
+                    // In write lock, so will be the most up-to-date version
+                    auto metadataNow = CollectionShardingState::get(txn, ns)->getMetadata();
+                    if (metadataNow) {
+                        ShardKeyPattern kp(metadataNow->getKeyPattern());
+                        BSONObj key = kp.extractShardKeyFromDoc(obj);
+                        docIsOrphan =
+                            !metadataNow->keyBelongsToMe(key) && !metadataNow->keyIsPending(key);
+                    } else {
+                        docIsOrphan = false;
+                    }
+
+                    if (!docIsOrphan) {
+                        warning(LogComponent::kSharding)
+                            << "aborting migration cleanup for chunk " << min << " to " << max
+                            << (metadataNow ? (string) " at document " + obj.toString() : "")
+                            << ", collection " << ns << " has changed " << endl;
+                        finished = true;
+                        break;
+                    }
+                }
+
+                NamespaceString nss(ns);
+                if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesFor(nss)) {
+                    warning() << "stepped down from primary while deleting chunk; "
+                              << "orphaning data in " << ns << " in range [" << redact(min)
+                              << ", " << redact(max) << ")";
+                    return numDeleted;
+                }
+
+                if (callback)
+                    callback->goingToDelete(obj);
+
+                // The document is gone once deleted, so keep the shard key it was indexed under
+                const BSONObj shardKey = shardKeyPattern.extractShardKeyFromDoc(obj);
+                batchBytes += obj.objsize();
+
+                // The scan is positioned on the index entry of the document being deleted, so it
+                // must be saved across the delete and repositioned afterwards
+                exec->saveState();
+                OpDebug* const nullOpDebug = nullptr;
+                collection->deleteDocument(txn, rloc, nullOpDebug, fromMigrate);
+                ++batchDocs;
 
-            if (callback)
-                callback->goingToDelete(obj);
+                lastDeleted = shardKey.getOwned();
+
+                if (!exec->restoreState()) {
+                    warning(LogComponent::kSharding)
+                        << "index scan was killed while deleting " << min << " to " << max
+                        << " in " << ns;
+                    finished = true;
+                    break;
+                }
+            }
 
-            OpDebug* const nullOpDebug = nullptr;
-            collection->deleteDocument(txn, rloc, nullOpDebug, fromMigrate);
             wuow.commit();
-            numDeleted++;
+            numDeleted += batchDocs;
+
+            // Other documents may share the shard key of the last one deleted, so resume at the
+            // start of that key rather than after it
+            if (!lastDeleted.isEmpty()) {
+                resumeMin = Helpers::toKeyFormat(
+                    KeyPattern(desc->keyPattern()).extendRangeBound(lastDeleted, false));
+            }
         }
+        MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "removeRange", ns);
+
+        if (batchDocs == 0)
+            break;
 
         // TODO remove once the yielding below that references this timer has been removed
         Timer secondaryThrottleTime;
 
-        if (writeConcern.shouldWaitForOtherNodes() && numDeleted > 0) {
+        Milliseconds batchReplicationWait(0);
+        if (writeConcern.shouldWaitForOtherNodes()) {
             repl::ReplicationCoordinator::StatusAndDuration replStatus =
                 repl::getGlobalReplicationCoordinator()->awaitReplication(
                     txn,
@@ -468,8 +550,25 @@ long long Helpers::removeRange(OperationContext* txn,
             } else {
                 uassertStatusOK(replStatus.status);
             }
+            batchReplicationWait = replStatus.duration;
             millisWaitingForReplication += replStatus.duration;
         }
+
+        // Without secondaryThrottle the deleter never waits for the secondaries, so how far they
+        // are behind is measured separately
+        const Milliseconds batchReplicationLag = writeConcern.shouldWaitForOtherNodes()
+            ? Milliseconds(0)
+            : getMajorityReplicationLag(txn);
+
+        // Give way to foreground writes and lagging secondaries before the next batch
+        const Milliseconds pause = pacer.noteBatch(batchDocs,
+                                                   batchBytes,
+                                                   batchReplicationWait,
+                                                   batchReplicationLag,
+                                                   Locker::areWriteTicketsExhausted());
+        if (!finished && pause > Milliseconds(0)) {
+            sleepmillis(durationCount<Milliseconds>(pause));
+        }
     }
 
     if (writeConcern.shouldWaitForOtherNodes())
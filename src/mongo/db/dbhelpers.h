@@ -168,7 +168,9 @@ struct Helpers {
      *
      * Returns -1 when no usable index exists
      *
-     * Does oplog the individual document deletions.
+     * Does oplog the individual document deletions. Documents are deleted in batches sized by
+     * RangeDeletionPacer, each in a single storage transaction, and 'writeConcern' is waited for
+     * once per batch.
      * // TODO: Refactor this mechanism, it is growing too large
      */
     static long long removeRange(OperationContext* txn,
@@ -135,7 +135,7 @@ CollectionShardingState::DeleteState OpObserver::aboutToDelete(OperationContext*
     }
 
     auto css = CollectionShardingState::get(txn, ns.ns());
-    deleteState.isMigrating = css->isDocumentInMigratingChunk(txn, doc);
+    deleteState.sourceMgr = css->getMigrationSourceManagerForDocument(txn, doc);
 
     return deleteState;
 }
@@ -41,9 +41,11 @@
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_geo_near.h"
+#include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/document_source_match.h"
 #include "mongo/db/pipeline/document_source_out.h"
 #include "mongo/db/pipeline/document_source_project.h"
+#include "mongo/db/pipeline/document_source_sort.h"
 #include "mongo/db/pipeline/document_source_unwind.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
@@ -182,6 +184,7 @@ intrusive_ptr<Pipeline> Pipeline::splitForSharded() {
     // efficiency of the final pipeline. Be Careful!
     Optimizations::Sharded::findSplitPoint(shardPipeline.get(), this);
     Optimizations::Sharded::moveFinalUnwindFromShardsToMerger(shardPipeline.get(), this);
+    Optimizations::Sharded::pushTopKSortOnGroupKeyToShards(shardPipeline.get(), this);
     Optimizations::Sharded::limitFieldsSentFromShardsToMerger(shardPipeline.get(), this);
 
     return shardPipeline;
@@ -222,6 +225,37 @@ void Pipeline::Optimizations::Sharded::moveFinalUnwindFromShardsToMerger(Pipelin
     }
 }
 
+void Pipeline::Optimizations::Sharded::pushTopKSortOnGroupKeyToShards(Pipeline* shardPipe,
+                                                                      Pipeline* mergePipe) {
+    if (shardPipe->_sources.empty() || mergePipe->_sources.size() < 2) {
+        return;
+    }
+
+    // The shards must end with the partial $group which the merger's leading $group finishes.
+    if (!dynamic_cast<DocumentSourceGroup*>(shardPipe->_sources.back().get()) ||
+        !dynamic_cast<DocumentSourceGroup*>(mergePipe->_sources.front().get())) {
+        return;
+    }
+
+    auto sort = dynamic_cast<DocumentSourceSort*>(std::next(mergePipe->_sources.begin())->get());
+    if (!sort || sort->getLimit() < 0) {
+        return;
+    }
+
+    // Only a sort which leads with the group key orders the groups the same way on every shard
+    // and in the merger, and never ties two different groups. Any group in the final top k then
+    // is in the top k of partial groups of every shard that has it, so the shards can drop the
+    // rest of their partial groups without losing anything that contributes to the result.
+    const BSONObj sortPattern = sort->serializeSortKey(false).toBson();
+    if (sortPattern.firstElementFieldName() != StringData("_id") ||
+        !sortPattern.firstElement().isNumber()) {
+        return;
+    }
+
+    shardPipe->_sources.push_back(
+        DocumentSourceSort::create(shardPipe->pCtx, sortPattern, sort->getLimit()));
+}
+
 void Pipeline::Optimizations::Sharded::limitFieldsSentFromShardsToMerger(Pipeline* shardPipe,
                                                                          Pipeline* mergePipe) {
     DepsTracker mergeDeps(
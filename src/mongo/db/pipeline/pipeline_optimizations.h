@@ -60,6 +60,13 @@ public:
      */
     static void moveFinalUnwindFromShardsToMerger(Pipeline* shardPipe, Pipeline* mergePipe);
 
+    /**
+     * If the merger finishes a $group and then sorts the groups by their _id with a limit, has the
+     * shards sort their partial groups the same way and send only the first 'limit' of them. This
+     * cuts down on network traffic and on the number of partial groups the merger has to combine.
+     */
+    static void pushTopKSortOnGroupKeyToShards(Pipeline* shardPipe, Pipeline* mergePipe);
+
     /**
      * Adds a stage to the end of shardPipe explicitly requesting all fields that mergePipe
      * needs. This is only done if it heuristically determines that it is needed. This
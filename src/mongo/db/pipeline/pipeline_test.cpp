@@ -1059,6 +1059,81 @@ class ShardedSortMatchProjSkipLimBecomesMatchTopKSortSkipProj : public Base {
 
 }  // namespace limitFieldsSentFromShardsToMerger
 
+namespace pushTopKSortOnGroupKeyToShards {
+
+class SortOnGroupKeyWithLimit : public Base {
+    string inputPipeJson() {
+        return "[{$group: {_id: '$a', c: {$sum: '$b'}}}"
+               ",{$sort: {_id: -1, c: 1}}"
+               ",{$limit: 5}"
+               "]";
+    }
+    string shardPipeJson() {
+        return "[{$group: {_id: '$a', c: {$sum: '$b'}}}"
+               ",{$sort: {sortKey: {_id: -1, c: 1}, limit: 5}}"
+               "]";
+    }
+    string mergePipeJson() {
+        return "[{$group: {_id: '$$ROOT._id', c: {$sum: '$$ROOT.c'}, $doingMerge: true}}"
+               ",{$sort: {sortKey: {_id: -1, c: 1}, limit: 5}}"
+               "]";
+    }
+};
+
+class SortOnAccumulatorNotPushed : public Base {
+    // The shards cannot tell which groups have the largest totals from their partial sums.
+    string inputPipeJson() {
+        return "[{$group: {_id: '$a', c: {$sum: '$b'}}}"
+               ",{$sort: {c: -1, _id: 1}}"
+               ",{$limit: 5}"
+               "]";
+    }
+    string shardPipeJson() {
+        return "[{$group: {_id: '$a', c: {$sum: '$b'}}}]";
+    }
+    string mergePipeJson() {
+        return "[{$group: {_id: '$$ROOT._id', c: {$sum: '$$ROOT.c'}, $doingMerge: true}}"
+               ",{$sort: {sortKey: {c: -1, _id: 1}, limit: 5}}"
+               "]";
+    }
+};
+
+class SortOnGroupKeySubfieldNotPushed : public Base {
+    // Different groups can tie on part of their key, so a shard could cut one of them off.
+    string inputPipeJson() {
+        return "[{$group: {_id: {a: '$a', b: '$b'}}}"
+               ",{$sort: {'_id.a': 1}}"
+               ",{$limit: 5}"
+               "]";
+    }
+    string shardPipeJson() {
+        return "[{$group: {_id: {a: '$a', b: '$b'}}}]";
+    }
+    string mergePipeJson() {
+        return "[{$group: {_id: '$$ROOT._id', $doingMerge: true}}"
+               ",{$sort: {sortKey: {'_id.a': 1}, limit: 5}}"
+               "]";
+    }
+};
+
+class SortWithoutLimitNotPushed : public Base {
+    string inputPipeJson() {
+        return "[{$group: {_id: '$a'}}"
+               ",{$sort: {_id: 1}}"
+               "]";
+    }
+    string shardPipeJson() {
+        return "[{$group: {_id: '$a'}}]";
+    }
+    string mergePipeJson() {
+        return "[{$group: {_id: '$$ROOT._id', $doingMerge: true}}"
+               ",{$sort: {sortKey: {_id: 1}}}"
+               "]";
+    }
+};
+
+}  // namespace pushTopKSortOnGroupKeyToShards
+
 namespace coalesceLookUpAndUnwind {
 
 class ShouldCoalesceUnwindOnAs : public Base {
@@ -1485,6 +1560,11 @@ public:
         add<Optimizations::Sharded::moveFinalUnwindFromShardsToMerger::TwoUnwind>();
         add<Optimizations::Sharded::moveFinalUnwindFromShardsToMerger::UnwindNotFinal>();
         add<Optimizations::Sharded::moveFinalUnwindFromShardsToMerger::UnwindWithOther>();
+        add<Optimizations::Sharded::pushTopKSortOnGroupKeyToShards::SortOnGroupKeyWithLimit>();
+        add<Optimizations::Sharded::pushTopKSortOnGroupKeyToShards::SortOnAccumulatorNotPushed>();
+        add<Optimizations::Sharded::pushTopKSortOnGroupKeyToShards::
+                SortOnGroupKeySubfieldNotPushed>();
+        add<Optimizations::Sharded::pushTopKSortOnGroupKeyToShards::SortWithoutLimitNotPushed>();
         add<Optimizations::Sharded::limitFieldsSentFromShardsToMerger::NeedWholeDoc>();
         add<Optimizations::Sharded::limitFieldsSentFromShardsToMerger::JustNeedsId>();
         add<Optimizations::Sharded::limitFieldsSentFromShardsToMerger::JustNeedsNonId>();
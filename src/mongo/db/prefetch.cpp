@@ -42,8 +42,10 @@
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/db/storage/mmap_v1/mmap.h"
+#include "mongo/db/storage/storage_engine.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -140,6 +142,42 @@ void prefetchRecordPages(OperationContext* txn, Database* db, const char* ns, co
         }
     }
 }
+
+// Read the current version of the document an update or delete will modify, and the index
+// entries it will change, through the storage engine's cursors so that they are in its cache
+// when the op is applied. Used for storage engines that do not memory map their data files.
+void prefetchDocumentAndIndexPages(OperationContext* txn,
+                                   Database* db,
+                                   Collection* collection,
+                                   const ReplSettings::IndexPrefetchConfig& prefetchConfig,
+                                   const char* ns,
+                                   const BSONObj& obj) {
+    BSONElement _id;
+    // Capped collections typically do not have an _id index for findById() to use.
+    if (!obj.getObjectID(_id) || collection->isCapped()) {
+        prefetchIndexPages(txn, collection, prefetchConfig, obj);
+        return;
+    }
+
+    BSONObj doc;
+    {
+        TimerHolder timer(&prefetchDocStats);
+        try {
+            // Goes through the _id index, so this also covers PREFETCH_ID_ONLY.
+            if (!Helpers::findById(txn, db, ns, _id.wrap(), doc)) {
+                return;
+            }
+        } catch (const DBException& e) {
+            LOG(2) << "ignoring exception in prefetchDocumentAndIndexPages(): " << redact(e);
+            return;
+        }
+    }
+
+    // The current version of the document holds every index key the op will remove.
+    if (prefetchConfig == ReplSettings::IndexPrefetchConfig::PREFETCH_ALL) {
+        prefetchIndexPages(txn, collection, prefetchConfig, doc);
+    }
+}
 }  // namespace
 
 // prefetch for an oplog operation
@@ -165,10 +203,10 @@ void prefetchPagesForReplicatedOp(OperationContext* txn, Database* db, const BSO
     BSONObj obj = op.getObjectField(opField);
     const char* ns = op.getStringField("ns");
 
-    // This will have to change for engines other than MMAP V1, because they might not have
-    // means for directly prefetching pages from the collection. For this purpose, acquire S
-    // lock on the database, instead of optimizing with IS.
-    Lock::CollectionLock collLock(txn->lockState(), ns, MODE_S);
+    // MMAP V1 prefetches pages directly from the collection's mapped files, for which it needs
+    // an S lock on the collection. Other engines only read through cursors, so IS is enough.
+    const bool isMmapV1 = txn->getServiceContext()->getGlobalStorageEngine()->isMmapV1();
+    Lock::CollectionLock collLock(txn->lockState(), ns, isMmapV1 ? MODE_S : MODE_IS);
 
     Collection* collection = db->getCollection(ns);
     if (!collection) {
@@ -177,6 +215,16 @@ void prefetchPagesForReplicatedOp(OperationContext* txn, Database* db, const BSO
 
     LOG(4) << "index prefetch for op " << *opType;
 
+    if (!isMmapV1) {
+        if (*opType == 'i') {
+            // There is no document yet, but the insert still seeks into each index.
+            prefetchIndexPages(txn, collection, prefetchConfig, obj);
+        } else {
+            prefetchDocumentAndIndexPages(txn, db, collection, prefetchConfig, ns, obj);
+        }
+        return;
+    }
+
     // should we prefetch index pages on updates? if the update is in-place and doesn't change
     // indexed values, it is actually slower - a lot slower if there are a dozen indexes or
     // lots of multikeys.  possible variations (not all mutually exclusive):
@@ -653,6 +653,7 @@ std::string runQuery(OperationContext* txn,
     // collection version
     auto css = CollectionShardingState::get(txn, nss);
     css->checkShardVersionOrThrow(txn);
+    css->onReadOp(txn, *exec->getCanonicalQuery());
 
     // Fill out CurOp based on query results. If we have a cursorid, we will fill out CurOp with
     // this cursorid later.
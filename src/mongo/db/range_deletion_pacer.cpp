@@ -0,0 +1,155 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/range_deletion_pacer.h"
+
+#include <algorithm>
+#include <map>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+namespace {
+
+// Maximum number of documents deleted in a single storage transaction. A value of 1 deletes one
+// document at a time.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchSize, int, 128);
+
+// Maximum size of the documents deleted in a single storage transaction.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxBatchBytes, int, 1024 * 1024);
+
+// Replication wait after which a batch is considered to make secondaries fall behind.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterTargetReplicationLagMillis, int, 1000);
+
+// Pause between batches after backing off.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBackoffMillis, int, 100);
+
+int maxBatchSize() {
+    return std::max(rangeDeleterBatchSize.load(), 1);
+}
+
+struct NamespaceProgress {
+    int activeDeletions = 0;
+    long long deletedDocs = 0;
+    long long deletedBytes = 0;
+    long long batches = 0;
+    long long backoffs = 0;
+    long long waitForReplMillis = 0;
+    int batchSize = 0;
+    Date_t lastBatch;
+};
+
+stdx::mutex progressMutex;
+std::map<std::string, NamespaceProgress> progressByNamespace;
+
+}  // namespace
+
+RangeDeletionPacer::RangeDeletionPacer(std::string ns)
+    : _ns(std::move(ns)), _batchSize(maxBatchSize()) {
+    stdx::lock_guard<stdx::mutex> lk(progressMutex);
+    NamespaceProgress& progress = progressByNamespace[_ns];
+    ++progress.activeDeletions;
+    progress.batchSize = _batchSize;
+}
+
+RangeDeletionPacer::~RangeDeletionPacer() {
+    stdx::lock_guard<stdx::mutex> lk(progressMutex);
+    auto it = progressByNamespace.find(_ns);
+    invariant(it != progressByNamespace.end());
+    if (--it->second.activeDeletions == 0) {
+        progressByNamespace.erase(it);
+    }
+}
+
+bool RangeDeletionPacer::isBatchFull(int numDocs, long long numBytes) const {
+    return numDocs >= getBatchSize() || numBytes >= rangeDeleterMaxBatchBytes.load();
+}
+
+Milliseconds RangeDeletionPacer::noteBatch(int numDocs,
+                                           long long numBytes,
+                                           Milliseconds replicationWait,
+                                           Milliseconds replicationLag,
+                                           bool writeTicketsExhausted) {
+    const int maxSize = maxBatchSize();
+    const Milliseconds targetLag(rangeDeleterTargetReplicationLagMillis.load());
+    const bool backOff =
+        writeTicketsExhausted || replicationWait > targetLag || replicationLag > targetLag;
+
+    Milliseconds pause(0);
+    if (backOff) {
+        _batchSize = std::max(std::min(_batchSize, maxSize) / 2, 1);
+        pause = Milliseconds(std::max(rangeDeleterBackoffMillis.load(), 0));
+    } else {
+        _batchSize = std::min(_batchSize + std::max(maxSize / 8, 1), maxSize);
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(progressMutex);
+    NamespaceProgress& progress = progressByNamespace[_ns];
+    progress.deletedDocs += numDocs;
+    progress.deletedBytes += numBytes;
+    ++progress.batches;
+    if (backOff) {
+        ++progress.backoffs;
+    }
+    progress.waitForReplMillis += durationCount<Milliseconds>(replicationWait);
+    progress.batchSize = _batchSize;
+    progress.lastBatch = Date_t::now();
+
+    return pause;
+}
+
+int RangeDeletionPacer::getBatchSize() const {
+    // The maximum may have been lowered since the last batch
+    return std::min(_batchSize, maxBatchSize());
+}
+
+void RangeDeletionPacer::appendProgress(BSONObjBuilder* builder) {
+    stdx::lock_guard<stdx::mutex> lk(progressMutex);
+    for (const auto& entry : progressByNamespace) {
+        const NamespaceProgress& progress = entry.second;
+
+        BSONObjBuilder nsBuilder(builder->subobjStart(entry.first));
+        nsBuilder.append("activeDeletions", progress.activeDeletions);
+        nsBuilder.append("deletedDocs", progress.deletedDocs);
+        nsBuilder.append("deletedBytes", progress.deletedBytes);
+        nsBuilder.append("batches", progress.batches);
+        nsBuilder.append("backoffs", progress.backoffs);
+        nsBuilder.append("waitForReplMillis", progress.waitForReplMillis);
+        nsBuilder.append("batchSize", progress.batchSize);
+        if (progress.lastBatch > Date_t()) {
+            nsBuilder.append("lastBatch", progress.lastBatch);
+        }
+        nsBuilder.doneFast();
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,101 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+/**
+ * Sizes the storage transactions in which orphaned documents of a range are deleted, and records
+ * the progress of range deletions per namespace.
+ *
+ * Batches start at rangeDeleterBatchSize documents. Whenever a batch takes longer than
+ * rangeDeleterTargetReplicationLagMillis to replicate, the majority of the replica set lags further
+ * behind than that, or foreground writers are queued on write tickets once it commits, the batch
+ * size is halved and the deleter pauses for
+ * rangeDeleterBackoffMillis. Otherwise the batch size grows back by an eighth of the maximum per
+ * batch.
+ *
+ * A pacer is used by a single deleter at a time, but the progress of all namespaces may be
+ * reported concurrently.
+ */
+class RangeDeletionPacer {
+    MONGO_DISALLOW_COPYING(RangeDeletionPacer);
+
+public:
+    explicit RangeDeletionPacer(std::string ns);
+    ~RangeDeletionPacer();
+
+    /**
+     * Returns whether a batch which holds 'numDocs' documents totalling 'numBytes' must be
+     * committed before deleting any more documents.
+     */
+    bool isBatchFull(int numDocs, long long numBytes) const;
+
+    /**
+     * Records a committed batch and sizes the next one. 'replicationWait' is how long it took for
+     * the batch to replicate, or zero if the deleter did not wait for it, 'replicationLag' how far
+     * the majority of the replica set was behind after the batch, or zero if not measured, and
+     * 'writeTicketsExhausted' whether foreground writers were queued on write tickets afterwards.
+     *
+     * Returns how long the deleter should pause, without holding any locks, before starting the
+     * next batch.
+     */
+    Milliseconds noteBatch(int numDocs,
+                           long long numBytes,
+                           Milliseconds replicationWait,
+                           Milliseconds replicationLag,
+                           bool writeTicketsExhausted);
+
+    /**
+     * Returns the number of documents in the next batch.
+     */
+    int getBatchSize() const;
+
+    /**
+     * Appends the progress of the range deletions of each namespace, which has any active, keyed by
+     * namespace. A namespace is reported from when its first deletion starts until its last one
+     * finishes.
+     */
+    static void appendProgress(BSONObjBuilder* builder);
+
+private:
+    const std::string _ns;
+
+    // Number of documents in the next batch, never more than rangeDeleterBatchSize
+    int _batchSize;
+};
+
+}  // namespace mongo
@@ -0,0 +1,122 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/range_deletion_pacer.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+// Matches the defaults of the rangeDeleter server parameters
+const int kMaxBatchSize = 128;
+const long long kMaxBatchBytes = 1024 * 1024;
+const Milliseconds kBackoff(100);
+
+TEST(RangeDeletionPacerTest, FirstBatchHasMaximumSize) {
+    RangeDeletionPacer pacer("test.first");
+    ASSERT_EQ(kMaxBatchSize, pacer.getBatchSize());
+
+    ASSERT_FALSE(pacer.isBatchFull(kMaxBatchSize - 1, kMaxBatchBytes - 1));
+    ASSERT_TRUE(pacer.isBatchFull(kMaxBatchSize, 0));
+    ASSERT_TRUE(pacer.isBatchFull(1, kMaxBatchBytes));
+}
+
+TEST(RangeDeletionPacerTest, BacksOffWhenReplicationLags) {
+    RangeDeletionPacer pacer("test.replLag");
+    ASSERT_EQ(kBackoff, pacer.noteBatch(kMaxBatchSize, 1000, Seconds(2), Milliseconds(0), false));
+    ASSERT_EQ(kMaxBatchSize / 2, pacer.getBatchSize());
+
+    ASSERT_EQ(kBackoff,
+              pacer.noteBatch(kMaxBatchSize / 2, 500, Seconds(2), Milliseconds(0), false));
+    ASSERT_EQ(kMaxBatchSize / 4, pacer.getBatchSize());
+}
+
+TEST(RangeDeletionPacerTest, BacksOffWhenMajorityLags) {
+    RangeDeletionPacer pacer("test.majorityLag");
+    ASSERT_EQ(kBackoff, pacer.noteBatch(kMaxBatchSize, 1000, Milliseconds(0), Seconds(2), false));
+    ASSERT_EQ(kMaxBatchSize / 2, pacer.getBatchSize());
+
+    ASSERT_EQ(Milliseconds(0),
+              pacer.noteBatch(kMaxBatchSize / 2, 500, Milliseconds(0), Seconds(1), false));
+}
+
+TEST(RangeDeletionPacerTest, BacksOffWhenWriteTicketsExhausted) {
+    RangeDeletionPacer pacer("test.tickets");
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(kBackoff,
+                  pacer.noteBatch(pacer.getBatchSize(), 0, Milliseconds(0), Milliseconds(0), true));
+    }
+
+    // Never goes below a single document
+    ASSERT_EQ(1, pacer.getBatchSize());
+}
+
+TEST(RangeDeletionPacerTest, GrowsBackUpToMaximum) {
+    RangeDeletionPacer pacer("test.grow");
+    pacer.noteBatch(kMaxBatchSize, 0, Milliseconds(0), Milliseconds(0), true);
+    ASSERT_EQ(kMaxBatchSize / 2, pacer.getBatchSize());
+
+    ASSERT_EQ(Milliseconds(0),
+              pacer.noteBatch(kMaxBatchSize / 2, 0, Milliseconds(10), Milliseconds(0), false));
+    ASSERT_EQ(kMaxBatchSize / 2 + kMaxBatchSize / 8, pacer.getBatchSize());
+
+    for (int i = 0; i < 10; ++i) {
+        pacer.noteBatch(pacer.getBatchSize(), 0, Milliseconds(0), Milliseconds(0), false);
+    }
+    ASSERT_EQ(kMaxBatchSize, pacer.getBatchSize());
+}
+
+TEST(RangeDeletionPacerTest, ReportsProgressPerNamespace) {
+    {
+        RangeDeletionPacer pacer("test.progress");
+        pacer.noteBatch(10, 1000, Milliseconds(5), Milliseconds(0), false);
+        pacer.noteBatch(5, 500, Seconds(2), Milliseconds(0), false);
+
+        BSONObjBuilder builder;
+        RangeDeletionPacer::appendProgress(&builder);
+        BSONObj progress = builder.obj().getObjectField("test.progress");
+        ASSERT_EQ(1, progress["activeDeletions"].numberInt());
+        ASSERT_EQ(15, progress["deletedDocs"].numberLong());
+        ASSERT_EQ(1500, progress["deletedBytes"].numberLong());
+        ASSERT_EQ(2, progress["batches"].numberLong());
+        ASSERT_EQ(1, progress["backoffs"].numberLong());
+        ASSERT_EQ(2005, progress["waitForReplMillis"].numberLong());
+        ASSERT_EQ(pacer.getBatchSize(), progress["batchSize"].numberInt());
+    }
+
+    // The namespace is not reported anymore once its last deletion finishes
+    BSONObjBuilder builder;
+    RangeDeletionPacer::appendProgress(&builder);
+    ASSERT_FALSE(builder.obj().hasField("test.progress"));
+}
+
+}  // namespace
+}  // namespace mongo
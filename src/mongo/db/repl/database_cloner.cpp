@@ -62,6 +62,10 @@ const char* kOptionsFieldName = "options";
 // The number of attempts for the listCollections commands.
 MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncListCollectionsAttempts, int, 3);
 
+// The number of collections in a database that may be cloned at the same time. Values less than
+// 1 are treated as 1, which clones collections one after another.
+MONGO_EXPORT_SERVER_PARAMETER(maxNumConcurrentInitialSyncCollectionCloners, int, 1);
+
 /**
  * Default listCollections predicate.
  */
@@ -346,18 +350,32 @@ void DatabaseCloner::_listCollectionsCallback(const StatusWith<Fetcher::QueryRes
         }
     }
 
-    // Start first collection cloner.
-    _currentCollectionClonerIter = _collectionCloners.begin();
+    // Start the first batch of collection cloners.
+    _nextCollectionClonerIter = _collectionCloners.begin();
+    _startCollectionClonerStatus = _startCollectionCloners_inlock();
+    if (!_startCollectionClonerStatus.isOK() && _stats.activeCollections == 0) {
+        _finishCallback_inlock(lk, _startCollectionClonerStatus);
+        return;
+    }
+}
 
-    LOG(1) << "    cloning collection " << _currentCollectionClonerIter->getSourceNamespace();
+Status DatabaseCloner::_startCollectionCloners_inlock() {
+    const size_t maxActive = std::max(1, maxNumConcurrentInitialSyncCollectionCloners.load());
+    while (_stats.activeCollections < maxActive &&
+           _nextCollectionClonerIter != _collectionCloners.end()) {
+        auto&& cloner = *_nextCollectionClonerIter++;
 
-    Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
-    if (!startStatus.isOK()) {
-        LOG(1) << "    failed to start collection cloning on "
-               << _currentCollectionClonerIter->getSourceNamespace() << ": " << redact(startStatus);
-        _finishCallback_inlock(lk, startStatus);
-        return;
+        LOG(1) << "    cloning collection " << cloner.getSourceNamespace();
+
+        Status startStatus = _startCollectionCloner(cloner);
+        if (!startStatus.isOK()) {
+            LOG(1) << "    failed to start collection cloning on " << cloner.getSourceNamespace()
+                   << ": " << redact(startStatus);
+            return startStatus;
+        }
+        ++_stats.activeCollections;
     }
+    return Status::OK();
 }
 
 void DatabaseCloner::_collectionClonerCallback(const Status& status, const NamespaceString& nss) {
@@ -380,19 +398,23 @@ void DatabaseCloner::_collectionClonerCallback(const Status& status, const Names
     lk.unlock();
     _collectionWork(newStatus, nss);
     lk.lock();
-    _currentCollectionClonerIter++;
+    invariant(_stats.activeCollections > 0);
+    --_stats.activeCollections;
 
-    if (_currentCollectionClonerIter != _collectionCloners.end()) {
-        Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
-        if (!startStatus.isOK()) {
-            LOG(1) << "    failed to start collection cloning on "
-                   << _currentCollectionClonerIter->getSourceNamespace() << ": "
-                   << redact(startStatus);
-            _finishCallback_inlock(lk, startStatus);
-            return;
-        }
+    if (_startCollectionClonerStatus.isOK()) {
+        _startCollectionClonerStatus = _startCollectionCloners_inlock();
+    }
+
+    // Wait for the remaining collection cloners before reporting completion.
+    if (_stats.activeCollections > 0) {
+        return;
+    }
+
+    if (!_startCollectionClonerStatus.isOK()) {
+        _finishCallback_inlock(lk, _startCollectionClonerStatus);
         return;
     }
+    invariant(_nextCollectionClonerIter == _collectionCloners.end());
 
     Status finalStatus(Status::OK());
     if (_failedNamespaces.size() > 0) {
@@ -440,6 +462,7 @@ BSONObj DatabaseCloner::Stats::toBSON() const {
 void DatabaseCloner::Stats::append(BSONObjBuilder* builder) const {
     builder->appendNumber("collections", collections);
     builder->appendNumber("clonedCollections", clonedCollections);
+    builder->appendNumber("activeCollections", activeCollections);
     if (start != Date_t()) {
         builder->appendDate("start", start);
         if (end != Date_t()) {
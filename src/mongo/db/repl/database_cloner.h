@@ -67,6 +67,7 @@ public:
         Date_t end;
         size_t collections{0};
         size_t clonedCollections{0};
+        size_t activeCollections{0};
         std::vector<CollectionCloner::Stats> collectionStats;
 
         std::string toString() const;
@@ -169,9 +170,17 @@ private:
                                   Fetcher::NextAction* nextAction,
                                   BSONObjBuilder* getMoreBob);
 
+    /**
+     * Starts collection cloners in listCollections order until
+     * 'maxNumConcurrentInitialSyncCollectionCloners' of them are active or there are no
+     * collections left to clone. Returns the status of the first cloner that failed to start.
+     */
+    Status _startCollectionCloners_inlock();
+
     /**
      * Forwards collection cloner result to client.
-     * Starts a new cloner on a different collection.
+     * Starts a new cloner on a different collection if one has not been started yet.
+     * Completes the database cloner once every started collection cloner has finished.
      */
     void _collectionClonerCallback(const Status& status, const NamespaceString& nss);
 
@@ -221,8 +230,10 @@ private:
     std::vector<BSONObj> _collectionInfos;                               // (M)
     std::vector<NamespaceString> _collectionNamespaces;                  // (M)
     std::list<CollectionCloner> _collectionCloners;                      // (M)
-    std::list<CollectionCloner>::iterator _currentCollectionClonerIter;  // (M)
+    std::list<CollectionCloner>::iterator _nextCollectionClonerIter;     // (M)
     std::vector<std::pair<Status, NamespaceString>> _failedNamespaces;   // (M)
+    // First error from starting a collection cloner. No further cloners are started once set.
+    Status _startCollectionClonerStatus = Status::OK();  // (M)
     CollectionCloner::ScheduleDbWorkFn
         _scheduleDbWorkFn;  // (RT) Function for scheduling database work using the executor.
     StartCollectionClonerFn _startCollectionCloner;  // (RT)
@@ -37,8 +37,10 @@
 #include "mongo/db/repl/base_cloner_test_fixture.h"
 #include "mongo/db/repl/database_cloner.h"
 #include "mongo/db/repl/storage_interface.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 namespace {
 
@@ -568,7 +570,7 @@ TEST_F(DatabaseClonerTest, FirstCollectionListIndexesFailed) {
     ASSERT_EQUALS(getDetectableErrorStatus(), getStatus());
     ASSERT_TRUE(_databaseCloner->isActive());
 
-    // Collection cloners are run serially for now.
+    // Collection cloners are run serially by default.
     // This affects the order of the network responses.
     {
         executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
@@ -620,7 +622,7 @@ TEST_F(DatabaseClonerTest, CreateCollections) {
     ASSERT_EQUALS(getDetectableErrorStatus(), getStatus());
     ASSERT_TRUE(_databaseCloner->isActive());
 
-    // Collection cloners are run serially for now.
+    // Collection cloners are run serially by default.
     // This affects the order of the network responses.
     {
         executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
@@ -664,4 +666,126 @@ TEST_F(DatabaseClonerTest, CreateCollections) {
     stats.commitCalled = true;
 }
 
+TEST_F(DatabaseClonerTest, CreateCollectionsConcurrently) {
+    const auto& serverParams = ServerParameterSet::getGlobal()->getMap();
+    ServerParameter* maxConcurrentCloners =
+        serverParams.find("maxNumConcurrentInitialSyncCollectionCloners")->second;
+    ASSERT_OK(maxConcurrentCloners->setFromString("2"));
+    ON_BLOCK_EXIT([&] { ASSERT_OK(maxConcurrentCloners->setFromString("1")); });
+
+    ASSERT_OK(_databaseCloner->startup());
+
+    const std::vector<BSONObj> sourceInfos = {BSON("name"
+                                                   << "a"
+                                                   << "options"
+                                                   << BSONObj()),
+                                              BSON("name"
+                                                   << "b"
+                                                   << "options"
+                                                   << BSONObj()),
+                                              BSON("name"
+                                                   << "c"
+                                                   << "options"
+                                                   << BSONObj())};
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createListCollectionsResponse(
+            0, BSON_ARRAY(sourceInfos[0] << sourceInfos[1] << sourceInfos[2])));
+    }
+    ASSERT_EQUALS(getDetectableErrorStatus(), getStatus());
+    ASSERT_TRUE(_databaseCloner->isActive());
+    ASSERT_EQUALS(2U, _databaseCloner->getStats().activeCollections);
+
+    // The first two collection cloners are started together, so their requests are interleaved.
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createCountResponse(0));
+        processNetworkResponse(createCountResponse(0));
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    }
+    ASSERT_TRUE(_databaseCloner->isActive());
+
+    // Finishing the first collection starts the cloner for the third one.
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createCursorResponse(0, BSONArray()));
+    }
+    ASSERT_TRUE(_databaseCloner->isActive());
+    ASSERT_EQUALS(2U, _databaseCloner->getStats().activeCollections);
+    ASSERT_EQUALS(1U, _databaseCloner->getStats().clonedCollections);
+
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createCursorResponse(0, BSONArray()));
+        processNetworkResponse(createCountResponse(0));
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    }
+    ASSERT_TRUE(_databaseCloner->isActive());
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createCursorResponse(0, BSONArray()));
+    }
+
+    _databaseCloner->join();
+    ASSERT_OK(getStatus());
+    ASSERT_FALSE(_databaseCloner->isActive());
+    ASSERT_EQUALS(0U, _databaseCloner->getStats().activeCollections);
+    ASSERT_EQUALS(3U, _databaseCloner->getStats().clonedCollections);
+
+    ASSERT_EQUALS(3U, _collections.size());
+    for (auto&& info : sourceInfos) {
+        auto collInfo = _collections[NamespaceString(dbname, info.getStringField("name"))];
+        ASSERT_OK(collInfo.status);
+        ASSERT_TRUE(collInfo.stats.commitCalled);
+    }
+}
+
+TEST_F(DatabaseClonerTest, StartCollectionClonerFailedWhileOtherClonerActive) {
+    const auto& serverParams = ServerParameterSet::getGlobal()->getMap();
+    ServerParameter* maxConcurrentCloners =
+        serverParams.find("maxNumConcurrentInitialSyncCollectionCloners")->second;
+    ASSERT_OK(maxConcurrentCloners->setFromString("2"));
+    ON_BLOCK_EXIT([&] { ASSERT_OK(maxConcurrentCloners->setFromString("1")); });
+
+    ASSERT_OK(_databaseCloner->startup());
+    const Status errStatus{ErrorCodes::OperationFailed,
+                           "StartCollectionClonerFailedWhileOtherClonerActive injected failure."};
+
+    _databaseCloner->setStartCollectionClonerFn([errStatus](CollectionCloner& cloner) -> Status {
+        if (cloner.getSourceNamespace().coll() == "b") {
+            return errStatus;
+        }
+        return cloner.startup();
+    });
+
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createListCollectionsResponse(0,
+                                                             BSON_ARRAY(BSON("name"
+                                                                             << "a"
+                                                                             << "options"
+                                                                             << BSONObj())
+                                                                        << BSON("name"
+                                                                                << "b"
+                                                                                << "options"
+                                                                                << BSONObj()))));
+    }
+
+    // The database cloner must not complete until the cloner for 'a' has finished.
+    ASSERT_EQUALS(getDetectableErrorStatus(), getStatus());
+    ASSERT_TRUE(_databaseCloner->isActive());
+
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createCountResponse(0));
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+        processNetworkResponse(createCursorResponse(0, BSONArray()));
+    }
+    _databaseCloner->join();
+    ASSERT_FALSE(_databaseCloner->isActive());
+    ASSERT_EQUALS(errStatus, getStatus());
+    ASSERT_OK(_collections[NamespaceString{"db.a"}].status);
+}
+
 }  // namespace
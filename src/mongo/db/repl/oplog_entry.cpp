@@ -58,6 +58,8 @@ OplogEntry::OplogEntry(BSONObj rawInput) : raw(std::move(rawInput)) {
             version = elem;
         } else if (name == "o") {
             o = elem;
+        } else if (name == "t") {
+            term = elem;
         }
     }
 }
@@ -97,7 +99,13 @@ BSONElement OplogEntry::getIdElement() const {
 }
 
 OpTime OplogEntry::getOpTime() const {
-    return fassertStatusOK(34436, OpTime::parseFromOplogEntry(raw));
+    // Build the OpTime from the elements found by the constructor. Anything unusual goes through
+    // the full parser so that malformed entries fail the same way.
+    const bool termIsInteger = term.type() == NumberLong || term.type() == NumberInt;
+    if (MONGO_unlikely(ts.type() != bsonTimestamp || (!term.eoo() && !termIsInteger))) {
+        return fassertStatusOK(34436, OpTime::parseFromOplogEntry(raw));
+    }
+    return OpTime(ts.timestamp(), term.eoo() ? OpTime::kUninitializedTerm : term.numberLong());
 }
 
 Seconds OplogEntry::getTimestampSecs() const {
@@ -43,6 +43,10 @@ namespace repl {
  *
  * All unowned members (such as StringDatas and BSONElements) point into the raw BSON.
  * All StringData members are guaranteed to be NUL terminated.
+ *
+ * The raw BSON is only copied if it is not owned. Entries fetched from a sync source share
+ * ownership of the network reply they arrived in, so building an OplogEntry from them neither
+ * copies the document nor searches it for a field more than once.
  */
 struct OplogEntry {
     // Current oplog version, should be the value of the v field in all oplog entries.
@@ -72,6 +76,7 @@ struct OplogEntry {
     BSONElement o;
     BSONElement o2;
     BSONElement ts;
+    BSONElement term;
 };
 
 std::ostream& operator<<(std::ostream& s, const OplogEntry& o);
@@ -36,6 +36,7 @@
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/rpc/metadata/server_selection_metadata.h"
 #include "mongo/stdx/memory.h"
@@ -55,6 +56,19 @@ namespace {
 
 MONGO_FP_DECLARE(stopOplogFetcher);
 
+// Number of oplog entries to request in each find and getMore. Zero requests as many entries as fit
+// in a single reply, which the sync source limits to BSONObjMaxUserSize bytes. Without an explicit
+// batch size, the initial find would only return the server's default of 101 documents.
+MONGO_EXPORT_SERVER_PARAMETER(oplogFetcherBatchSize, int, 0);
+
+// 16MB max batch size / 12 byte min doc size * 10 (for good measure)
+const int kUnlimitedBatchSize = (BSONObjMaxUserSize / 12) * 10;
+
+int getBatchSize() {
+    const int batchSize = oplogFetcherBatchSize.load();
+    return batchSize > 0 ? batchSize : kUnlimitedBatchSize;
+}
+
 /**
  * Calculates await data timeout based on the current replica set configuration.
  */
@@ -81,6 +95,7 @@ BSONObj makeFindCommandObject(DataReplicatorExternalState* dataReplicatorExterna
     cmdBob.append("tailable", true);
     cmdBob.append("oplogReplay", true);
     cmdBob.append("awaitData", true);
+    cmdBob.append("batchSize", getBatchSize());
     cmdBob.append("maxTimeMS", durationCount<Milliseconds>(Minutes(1)));  // 1 min initial find.
     auto opTimeWithTerm = dataReplicatorExternalState->getCurrentTermAndLastCommittedOpTime();
     if (opTimeWithTerm.value != OpTime::kUninitializedTerm) {
@@ -99,6 +114,7 @@ BSONObj makeGetMoreCommandObject(DataReplicatorExternalState* dataReplicatorExte
     BSONObjBuilder cmdBob;
     cmdBob.append("getMore", cursorId);
     cmdBob.append("collection", nss.coll());
+    cmdBob.append("batchSize", getBatchSize());
     cmdBob.append("maxTimeMS", durationCount<Milliseconds>(fetcherMaxTimeMS));
     auto opTimeWithTerm = dataReplicatorExternalState->getCurrentTermAndLastCommittedOpTime();
     if (opTimeWithTerm.value != OpTime::kUninitializedTerm) {
@@ -177,6 +193,17 @@ ServerStatusMetricField<Counter64> displayOpsRead("repl.network.ops", &opsReadSt
 // The bytes read via the oplog reader
 Counter64 networkByteStats;
 ServerStatusMetricField<Counter64> displayBytesRead("repl.network.bytes", &networkByteStats);
+// The batches that arrived compressed, and their sizes as received and after decompression. The
+// ratio of the two byte counts is the compression ratio achieved on the oplog stream.
+Counter64 compressedBatchStats;
+ServerStatusMetricField<Counter64> displayCompressedBatches("repl.network.compression.batches",
+                                                            &compressedBatchStats);
+Counter64 compressedByteStats;
+ServerStatusMetricField<Counter64> displayCompressedBytes(
+    "repl.network.compression.compressedBytes", &compressedByteStats);
+Counter64 decompressedByteStats;
+ServerStatusMetricField<Counter64> displayDecompressedBytes(
+    "repl.network.compression.decompressedBytes", &decompressedByteStats);
 
 }  // namespace
 
@@ -468,6 +495,11 @@ void OplogFetcher::_callback(const Fetcher::QueryResponseStatus& result,
     // Increment stats. We read all of the docs in the query.
     opsReadStats.increment(info.networkDocumentCount);
     networkByteStats.increment(info.networkDocumentBytes);
+    if (queryResponse.compressedSizeBytes) {
+        compressedBatchStats.increment();
+        compressedByteStats.increment(queryResponse.compressedSizeBytes);
+        decompressedByteStats.increment(queryResponse.decompressedSizeBytes);
+    }
 
     // Record time for each batch.
     getmoreReplStats.recordMillis(durationCount<Milliseconds>(queryResponse.elapsedMillis));
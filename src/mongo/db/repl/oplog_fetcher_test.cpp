@@ -326,6 +326,8 @@ void _checkDefaultCommandObjectFields(BSONObj cmdObj) {
     ASSERT_TRUE(cmdObj.getBoolField("oplogReplay"));
     ASSERT_TRUE(cmdObj.getBoolField("awaitData"));
     ASSERT_EQUALS(60000, cmdObj.getIntField("maxTimeMS"));
+    // The initial find must not be limited to the server's default first batch of 101 documents.
+    ASSERT_EQUALS((BSONObjMaxUserSize / 12) * 10, cmdObj.getIntField("batchSize"));
 }
 
 TEST_F(
@@ -743,6 +745,7 @@ RemoteCommandRequest OplogFetcherTest::testTwoBatchHandling(bool isV1ElectionPro
     ASSERT_EQUALS(nss.coll(), request.cmdObj["collection"].String());
     ASSERT_EQUALS(int(durationCount<Milliseconds>(oplogFetcher.getAwaitDataTimeout_forTest())),
                   request.cmdObj.getIntField("maxTimeMS"));
+    ASSERT_EQUALS((BSONObjMaxUserSize / 12) * 10, request.cmdObj.getIntField("batchSize"));
 
     ASSERT_EQUALS(2U, lastEnqueuedDocuments.size());
     ASSERT_BSONOBJ_EQ(thirdEntry, lastEnqueuedDocuments[0]);
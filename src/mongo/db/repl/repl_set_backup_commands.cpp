@@ -0,0 +1,330 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kReplication
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <boost/filesystem/operations.hpp>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "mongo/bson/util/bson_extract.h"
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/repl/optime.h"
+#include "mongo/db/repl/repl_set_command.h"
+#include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/storage_engine.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/background.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace repl {
+
+/**
+ * Commands that let a new member copy the data files of this node instead of cloning every
+ * collection logically. The copying node runs replSetBeginBackup, reads every listed file with
+ * replSetReadBackupFile and finishes with replSetEndBackup. The files hold every write up to
+ * 'lastAppliedOpTime', and possibly some later ones, so the copying node must apply the oplog
+ * from there.
+ *
+ * The backup holds a lease which every replSetReadBackupFile renews. If the copying node goes away
+ * and the lease runs out, the backup is ended so that it does not pin checkpoints and log files,
+ * or block fsyncLock, forever.
+ */
+namespace {
+
+// Upper bound on the data returned by a single replSetReadBackupFile.
+const long long kMaxReadBackupFileBytes = 8 * 1024 * 1024;
+
+// How long a backup started by replSetBeginBackup lasts without a replSetReadBackupFile. Expired
+// backups are ended by a periodic task, which runs about once a minute.
+MONGO_EXPORT_SERVER_PARAMETER(replSetBackupLeaseSecs, int, 5 * 60);
+
+// True while the storage engine is in backup mode on behalf of replSetBeginBackup, as opposed to
+// fsyncLock. Only changed while holding the global lock in exclusive mode.
+bool backupStartedByCommand = false;
+
+// When the lease of the backup started by replSetBeginBackup runs out, or Date_t() if there is
+// none. Protected by backupLeaseMutex, since it is renewed without the global lock held
+// exclusively.
+stdx::mutex backupLeaseMutex;
+Date_t backupLeaseExpiry;
+
+void renewBackupLease() {
+    stdx::lock_guard<stdx::mutex> lk(backupLeaseMutex);
+    backupLeaseExpiry = Date_t::now() + Seconds(std::max(replSetBackupLeaseSecs.load(), 1));
+}
+
+void clearBackupLease() {
+    stdx::lock_guard<stdx::mutex> lk(backupLeaseMutex);
+    backupLeaseExpiry = Date_t();
+}
+
+bool isBackupLeaseExpired() {
+    stdx::lock_guard<stdx::mutex> lk(backupLeaseMutex);
+    return backupLeaseExpiry != Date_t() && backupLeaseExpiry <= Date_t::now();
+}
+
+/**
+ * Ends the backup started by replSetBeginBackup once its lease has run out.
+ */
+class BackupLeaseReaper : public PeriodicTask {
+public:
+    std::string taskName() const final {
+        return "BackupLeaseReaper";
+    }
+
+    void taskDoWork() final {
+        if (!isBackupLeaseExpired()) {
+            return;
+        }
+
+        Client::initThreadIfNotAlready();
+        const ServiceContext::UniqueOperationContext txnPtr = cc().makeOperationContext();
+        OperationContext* txn = txnPtr.get();
+
+        ScopedTransaction transaction(txn, MODE_X);
+        Lock::GlobalWrite global(txn->lockState());
+
+        // The backup may have been ended, or the lease renewed, while waiting for the lock.
+        if (!backupStartedByCommand || !isBackupLeaseExpired()) {
+            return;
+        }
+
+        getGlobalServiceContext()->getGlobalStorageEngine()->endBackup(txn);
+        backupStartedByCommand = false;
+        clearBackupLease();
+        warning() << "Left backup mode for a file copy because no file was read for "
+                  << replSetBackupLeaseSecs.load() << " seconds";
+    }
+} backupLeaseReaper;
+
+class CmdReplSetBeginBackup : public ReplSetCommand {
+public:
+    CmdReplSetBeginBackup() : ReplSetCommand("replSetBeginBackup") {}
+
+private:
+    bool run(OperationContext* txn,
+             const std::string&,
+             BSONObj& cmdObj,
+             int,
+             std::string& errmsg,
+             BSONObjBuilder& result) final {
+        Status status = getGlobalReplicationCoordinator()->checkReplEnabledForCommand(&result);
+        if (!status.isOK()) {
+            return appendCommandStatus(result, status);
+        }
+
+        ScopedTransaction transaction(txn, MODE_X);
+        Lock::GlobalWrite global(txn->lockState());
+        if (backupStartedByCommand) {
+            return appendCommandStatus(
+                result,
+                {ErrorCodes::IllegalOperation,
+                 "A backup started by replSetBeginBackup is already in progress"});
+        }
+
+        // Make every write so far durable, as fsyncLock does, so that the listed files hold them
+        // whether or not the journal is enabled.
+        StorageEngine* storageEngine = getGlobalServiceContext()->getGlobalStorageEngine();
+        try {
+            storageEngine->flushAllFiles(true);
+        } catch (const DBException& ex) {
+            return appendCommandStatus(result, ex.toStatus());
+        }
+
+        MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+            status = storageEngine->beginBackup(txn);
+        }
+        MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "replSetBeginBackup", "global");
+        if (!status.isOK()) {
+            return appendCommandStatus(result, status);
+        }
+
+        auto swFiles = storageEngine->getBackupFiles(txn);
+        if (!swFiles.isOK()) {
+            storageEngine->endBackup(txn);
+            return appendCommandStatus(result, swFiles.getStatus());
+        }
+
+        const boost::filesystem::path dbpath(storageGlobalParams.dbpath);
+        BSONArrayBuilder filesBuilder;
+        for (auto&& filename : swFiles.getValue()) {
+            boost::system::error_code ec;
+            const auto fileSize = boost::filesystem::file_size(dbpath / filename, ec);
+            if (ec) {
+                storageEngine->endBackup(txn);
+                return appendCommandStatus(
+                    result,
+                    {ErrorCodes::FileNotOpen,
+                     str::stream() << "Unable to get size of backup file " << filename << ": "
+                                   << ec.message()});
+            }
+            filesBuilder.append(BSON("filename" << filename << "fileSize"
+                                                << static_cast<long long>(fileSize)));
+        }
+        backupStartedByCommand = true;
+        renewBackupLease();
+
+        // Read once the backup cursor is open. Nothing can be written while the global lock is
+        // held, so the files hold every write up to this optime, and possibly writes whose batch
+        // has not advanced it yet.
+        const OpTime lastAppliedOpTime =
+            getGlobalReplicationCoordinator()->getMyLastAppliedOpTime();
+
+        log() << "Entered backup mode for a file copy of " << swFiles.getValue().size()
+              << " files as of " << lastAppliedOpTime;
+
+        lastAppliedOpTime.append(&result, "lastAppliedOpTime");
+        result.append("files", filesBuilder.arr());
+        return true;
+    }
+} cmdReplSetBeginBackup;
+
+class CmdReplSetReadBackupFile : public ReplSetCommand {
+public:
+    CmdReplSetReadBackupFile() : ReplSetCommand("replSetReadBackupFile") {}
+
+private:
+    bool run(OperationContext* txn,
+             const std::string&,
+             BSONObj& cmdObj,
+             int,
+             std::string& errmsg,
+             BSONObjBuilder& result) final {
+        std::string filename;
+        Status status = bsonExtractStringField(cmdObj, getName(), &filename);
+        if (!status.isOK()) {
+            return appendCommandStatus(result, status);
+        }
+        long long offset;
+        status = bsonExtractIntegerField(cmdObj, "offset", &offset);
+        if (!status.isOK()) {
+            return appendCommandStatus(result, status);
+        }
+        long long length;
+        status = bsonExtractIntegerFieldWithDefault(
+            cmdObj, "length", kMaxReadBackupFileBytes, &length);
+        if (!status.isOK()) {
+            return appendCommandStatus(result, status);
+        }
+        if (offset < 0 || length <= 0) {
+            return appendCommandStatus(
+                result,
+                {ErrorCodes::BadValue, "'offset' must be non-negative and 'length' positive"});
+        }
+        length = std::min(length, kMaxReadBackupFileBytes);
+
+        // Keeps the backup cursor, and therefore the file, alive while it is being read.
+        ScopedTransaction transaction(txn, MODE_IS);
+        Lock::GlobalLock global(txn->lockState(), MODE_IS, UINT_MAX);
+        if (!backupStartedByCommand) {
+            return appendCommandStatus(
+                result, {ErrorCodes::IllegalOperation, "replSetBeginBackup has not been run"});
+        }
+        renewBackupLease();
+
+        // Only files that are part of the backup may be read.
+        auto swFiles = getGlobalServiceContext()->getGlobalStorageEngine()->getBackupFiles(txn);
+        if (!swFiles.isOK()) {
+            return appendCommandStatus(result, swFiles.getStatus());
+        }
+        const auto& files = swFiles.getValue();
+        if (std::find(files.begin(), files.end(), filename) == files.end()) {
+            return appendCommandStatus(
+                result,
+                {ErrorCodes::BadValue, str::stream() << filename << " is not a backup file"});
+        }
+
+        const std::string path =
+            (boost::filesystem::path(storageGlobalParams.dbpath) / filename).string();
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        if (!file) {
+            return appendCommandStatus(
+                result,
+                {ErrorCodes::FileNotOpen, str::stream() << "Unable to open backup file " << path});
+        }
+        std::unique_ptr<char[]> buffer(new char[length]);
+        file.seekg(offset);
+        file.read(buffer.get(), length);
+        const auto bytesRead = file.gcount();
+        if (file.bad()) {
+            return appendCommandStatus(
+                result,
+                {ErrorCodes::FileStreamFailed,
+                 str::stream() << "Error reading backup file " << path << " at offset " << offset});
+        }
+
+        result.appendBinData("data", bytesRead, BinDataGeneral, buffer.get());
+        result.append("eof", file.eof());
+        return true;
+    }
+} cmdReplSetReadBackupFile;
+
+class CmdReplSetEndBackup : public ReplSetCommand {
+public:
+    CmdReplSetEndBackup() : ReplSetCommand("replSetEndBackup") {}
+
+private:
+    bool run(OperationContext* txn,
+             const std::string&,
+             BSONObj& cmdObj,
+             int,
+             std::string& errmsg,
+             BSONObjBuilder& result) final {
+        ScopedTransaction transaction(txn, MODE_X);
+        Lock::GlobalWrite global(txn->lockState());
+        if (!backupStartedByCommand) {
+            return appendCommandStatus(
+                result, {ErrorCodes::IllegalOperation, "replSetBeginBackup has not been run"});
+        }
+
+        getGlobalServiceContext()->getGlobalStorageEngine()->endBackup(txn);
+        backupStartedByCommand = false;
+        clearBackupLease();
+        log() << "Left backup mode for a file copy";
+        return true;
+    }
+} cmdReplSetEndBackup;
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
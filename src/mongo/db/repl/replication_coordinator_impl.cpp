@@ -229,37 +229,62 @@ private:
     WaiterList* _list;
 };
 
+ReplicationCoordinatorImpl::WaiterList::WriteConcernKey
+ReplicationCoordinatorImpl::WaiterList::_getWriteConcernKey(WaiterType waiter) {
+    if (!waiter->writeConcern) {
+        return WriteConcernKey();
+    }
+    return WriteConcernKey(waiter->writeConcern->wMode,
+                           waiter->writeConcern->wNumNodes,
+                           static_cast<int>(waiter->writeConcern->syncMode));
+}
+
 void ReplicationCoordinatorImpl::WaiterList::add_inlock(WaiterType waiter) {
-    _list.push_back(waiter);
+    _queues[_getWriteConcernKey(waiter)].emplace(waiter->opTime, waiter);
 }
 
 void ReplicationCoordinatorImpl::WaiterList::signalAndRemoveIf_inlock(
     stdx::function<bool(WaiterType)> func) {
-    std::vector<WaiterType>::iterator it = _list.end();
-    while (true) {
-        it = std::find_if(_list.begin(), _list.end(), func);
-        if (it == _list.end()) {
-            break;
+    for (auto queueIt = _queues.begin(); queueIt != _queues.end();) {
+        auto& queue = queueIt->second;
+        auto it = queue.begin();
+        while (it != queue.end() && func(it->second)) {
+            auto waiter = it->second;
+            it = queue.erase(it);
+            waiter->notify();
+        }
+        if (queue.empty()) {
+            queueIt = _queues.erase(queueIt);
+        } else {
+            ++queueIt;
         }
-        (*it)->notify();
-        std::swap(*it, _list.back());
-        _list.pop_back();
     }
 }
 
 void ReplicationCoordinatorImpl::WaiterList::signalAndRemoveAll_inlock() {
-    for (auto& waiter : _list) {
-        waiter->notify();
+    for (auto& queue : _queues) {
+        for (auto& waiter : queue.second) {
+            waiter.second->notify();
+        }
     }
-    _list.clear();
+    _queues.clear();
 }
 
 bool ReplicationCoordinatorImpl::WaiterList::remove_inlock(WaiterType waiter) {
-    auto it = std::find(_list.begin(), _list.end(), waiter);
-    if (it != _list.end()) {
-        std::swap(*it, _list.back());
-        _list.pop_back();
-        return true;
+    auto queueIt = _queues.find(_getWriteConcernKey(waiter));
+    if (queueIt == _queues.end()) {
+        return false;
+    }
+    auto& queue = queueIt->second;
+    auto range = queue.equal_range(waiter->opTime);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == waiter) {
+            queue.erase(it);
+            if (queue.empty()) {
+                _queues.erase(queueIt);
+            }
+            return true;
+        }
     }
     return false;
 }
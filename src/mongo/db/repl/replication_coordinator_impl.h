@@ -28,7 +28,10 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
+#include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -483,13 +486,23 @@ private:
         void add_inlock(WaiterType waiter);
         // Returns whether waiter is found and removed.
         bool remove_inlock(WaiterType waiter);
-        // Signals and removes all waiters that satisfy the condition.
+        // Signals and removes all waiters that satisfy the condition. The condition must hold for
+        // a waiter whenever it holds for a waiter with the same write concern and a later OpTime,
+        // so only waiters up to the first unsatisfied one of each write concern are checked.
         void signalAndRemoveIf_inlock(stdx::function<bool(WaiterType)> fun);
         // Signals and removes all waiters from the list.
         void signalAndRemoveAll_inlock();
 
     private:
-        std::vector<WaiterType> _list;
+        // Write concern mode, number of nodes and sync mode of a waiter.
+        using WriteConcernKey = std::tuple<std::string, int, int>;
+        // Waiters ordered by the OpTime they are waiting for.
+        using WaiterQueue = std::multimap<OpTime, WaiterType>;
+
+        static WriteConcernKey _getWriteConcernKey(WaiterType waiter);
+
+        // Waiters grouped by write concern. Empty queues are removed.
+        std::map<WriteConcernKey, WaiterQueue> _queues;
     };
 
     // Struct that holds information about nodes in this replication group, mainly used for
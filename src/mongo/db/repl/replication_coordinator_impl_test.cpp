@@ -1195,6 +1195,73 @@ TEST_F(ReplCoordTest, NodeReturnsOkWhenAWriteConcernWithNoTimeoutHasBeenSatisfie
     awaiter.reset();
 }
 
+TEST_F(ReplCoordTest, NodeWakesManyWriteConcernWaitersAsReplicationProgresses) {
+    assertStartSuccess(BSON("_id"
+                            << "mySet"
+                            << "version"
+                            << 2
+                            << "members"
+                            << BSON_ARRAY(BSON("host"
+                                               << "node1:12345"
+                                               << "_id"
+                                               << 0)
+                                          << BSON("host"
+                                                  << "node2:12345"
+                                                  << "_id"
+                                                  << 1)
+                                          << BSON("host"
+                                                  << "node3:12345"
+                                                  << "_id"
+                                                  << 2))),
+                       HostAndPort("node1", 12345));
+    ASSERT(getReplCoord()->setFollowerMode(MemberState::RS_SECONDARY));
+    getReplCoord()->setMyLastAppliedOpTime(OpTimeWithTermOne(100, 0));
+    getReplCoord()->setMyLastDurableOpTime(OpTimeWithTermOne(100, 0));
+    simulateSuccessfulV1Election();
+
+    // Waiters for every optime up to kNumOpTimes, each with w:2 and w:3. Progress of the
+    // secondaries is reported one optime at a time, so each update satisfies only a few of them.
+    const int kNumOpTimes = 100;
+    WriteConcernOptions writeConcernTwo;
+    writeConcernTwo.wTimeout = WriteConcernOptions::kNoTimeout;
+    writeConcernTwo.wNumNodes = 2;
+    WriteConcernOptions writeConcernThree = writeConcernTwo;
+    writeConcernThree.wNumNodes = 3;
+
+    std::vector<std::unique_ptr<ReplicationAwaiter>> awaitersTwo;
+    std::vector<std::unique_ptr<ReplicationAwaiter>> awaitersThree;
+    for (int i = 1; i <= kNumOpTimes; ++i) {
+        awaitersTwo.push_back(
+            stdx::make_unique<ReplicationAwaiter>(getReplCoord(), getServiceContext()));
+        awaitersTwo.back()->setOpTime(OpTimeWithTermOne(100, i));
+        awaitersTwo.back()->setWriteConcern(writeConcernTwo);
+        awaitersTwo.back()->start();
+        awaitersThree.push_back(
+            stdx::make_unique<ReplicationAwaiter>(getReplCoord(), getServiceContext()));
+        awaitersThree.back()->setOpTime(OpTimeWithTermOne(100, i));
+        awaitersThree.back()->setWriteConcern(writeConcernThree);
+        awaitersThree.back()->start();
+    }
+
+    Timer timer;
+    getReplCoord()->setMyLastAppliedOpTime(OpTimeWithTermOne(100, kNumOpTimes));
+    getReplCoord()->setMyLastDurableOpTime(OpTimeWithTermOne(100, kNumOpTimes));
+    for (int i = 1; i <= kNumOpTimes; ++i) {
+        ASSERT_OK(getReplCoord()->setLastAppliedOptime_forTest(2, 1, OpTimeWithTermOne(100, i)));
+    }
+    for (auto&& awaiter : awaitersTwo) {
+        ASSERT_OK(awaiter->getResult().status);
+    }
+    for (int i = 1; i <= kNumOpTimes; ++i) {
+        ASSERT_OK(getReplCoord()->setLastAppliedOptime_forTest(2, 2, OpTimeWithTermOne(100, i)));
+    }
+    for (auto&& awaiter : awaitersThree) {
+        ASSERT_OK(awaiter->getResult().status);
+    }
+    log() << "Woke " << 2 * kNumOpTimes << " write concern waiters in " << timer.millis()
+          << "ms";
+}
+
 TEST_F(ReplCoordTest, NodeReturnsWriteConcernFailedWhenAWriteConcernTimesOutBeforeBeingSatisified) {
     assertStartSuccess(BSON("_id"
                             << "mySet"
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
 #include "mongo/db/jsobj.h"
@@ -73,6 +75,24 @@ public:
      */
     virtual BSONObj findOne(const NamespaceString& nss, const BSONObj& filter) const = 0;
 
+    /**
+     * Fetches the documents whose _id is one of 'ids' from the sync source. Documents that do not
+     * exist on the sync source are left out of the result, which is in no particular order.
+     *
+     * The default implementation issues a findOne() for each _id.
+     */
+    virtual std::vector<BSONObj> findByIds(const NamespaceString& nss,
+                                           const std::vector<BSONElement>& ids) const {
+        std::vector<BSONObj> docs;
+        for (auto&& id : ids) {
+            BSONObj doc = findOne(nss, id.wrap("_id"));
+            if (!doc.isEmpty()) {
+                docs.push_back(doc);
+            }
+        }
+        return docs;
+    }
+
     /**
      * Clones a single collection from the sync source.
      */
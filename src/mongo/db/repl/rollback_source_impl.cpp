@@ -68,6 +68,31 @@ BSONObj RollbackSourceImpl::findOne(const NamespaceString& nss, const BSONObj& f
     return _getConnection()->findOne(nss.toString(), filter, NULL, QueryOption_SlaveOk).getOwned();
 }
 
+std::vector<BSONObj> RollbackSourceImpl::findByIds(const NamespaceString& nss,
+                                                   const std::vector<BSONElement>& ids) const {
+    BSONObjBuilder filter;
+    {
+        BSONObjBuilder idBuilder(filter.subobjStart("_id"));
+        BSONArrayBuilder inBuilder(idBuilder.subarrayStart("$in"));
+        for (auto&& id : ids) {
+            inBuilder.append(id);
+        }
+    }
+
+    std::unique_ptr<DBClientCursor> cursor =
+        _getConnection()->query(nss.toString(), filter.obj(), 0, 0, nullptr, QueryOption_SlaveOk);
+    uassert(ErrorCodes::HostUnreachable,
+            str::stream() << "query for rollback documents in " << nss.ns() << " failed",
+            cursor);
+
+    std::vector<BSONObj> docs;
+    docs.reserve(ids.size());
+    while (cursor->more()) {
+        docs.push_back(cursor->nextSafe().getOwned());
+    }
+    return docs;
+}
+
 void RollbackSourceImpl::copyCollectionFromRemote(OperationContext* txn,
                                                   const NamespaceString& nss) const {
     std::string errmsg;
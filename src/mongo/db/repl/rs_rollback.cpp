@@ -36,6 +36,7 @@
 #include <algorithm>
 #include <memory>
 
+#include "mongo/base/counter.h"
 #include "mongo/bson/bsonelement_comparator.h"
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/db/auth/authorization_manager.h"
@@ -45,6 +46,7 @@
 #include "mongo/db/catalog/document_validation.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbhelpers.h"
@@ -63,6 +65,7 @@
 #include "mongo/db/repl/rollback_source.h"
 #include "mongo/db/repl/rslog.h"
 #include "mongo/db/repl/storage_interface.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 
@@ -123,6 +126,27 @@ MONGO_FP_DECLARE(rollbackHangBeforeFinish);
 
 namespace {
 
+// The maximum number of documents of one collection to refetch from the sync source in one query.
+MONGO_EXPORT_SERVER_PARAMETER(rollbackRefetchBatchSize, int, 1000);
+
+// Upper bound on the size of the _id values in a single refetch query, well below the maximum
+// size of a query document.
+const int kMaxRefetchBatchIdBytes = 1024 * 1024;
+
+// Progress of rollbacks, summed over all rollbacks since startup: local oplog entries examined
+// while searching for the common point, and the documents refetched from the sync source together
+// with the number of queries it took. Compare samples taken before and after a rollback to see the
+// work it did.
+Counter64 localOpsScannedStats;
+ServerStatusMetricField<Counter64> displayLocalOpsScanned("repl.rollback.localOpsScanned",
+                                                          &localOpsScannedStats);
+Counter64 docsRefetchedStats;
+ServerStatusMetricField<Counter64> displayDocsRefetched("repl.rollback.refetch.docs",
+                                                        &docsRefetchedStats);
+Counter64 refetchBatchesStats;
+ServerStatusMetricField<Counter64> displayRefetchBatches("repl.rollback.refetch.batches",
+                                                         &refetchBatchesStats);
+
 class RSFatalException : public std::exception {
 public:
     RSFatalException(std::string m = "replica set fatal exception") : msg(m) {}
@@ -352,34 +376,64 @@ void syncFixUp(OperationContext* txn,
     BSONObj newMinValid;
 
     // fetch all the goodVersions of each document from current primary
-    DocID doc;
+    const size_t batchSize = std::max(1, rollbackRefetchBatchSize.load());
+    const char* ns = "";
     unsigned long long numFetched = 0;
     try {
-        for (set<DocID>::iterator it = fixUpInfo.toRefetch.begin(); it != fixUpInfo.toRefetch.end();
-             it++) {
-            doc = *it;
-
-            verify(!doc._id.eoo());
+        auto it = fixUpInfo.toRefetch.begin();
+        while (it != fixUpInfo.toRefetch.end()) {
+            // Documents are ordered by namespace, so each batch is a run of documents from the
+            // same collection.
+            ns = it->ns;
+            std::vector<BSONElement> ids;
+            int idBytes = 0;
+            auto batchEnd = it;
+            while (batchEnd != fixUpInfo.toRefetch.end() && strcmp(batchEnd->ns, ns) == 0 &&
+                   ids.size() < batchSize && idBytes < kMaxRefetchBatchIdBytes) {
+                verify(!batchEnd->_id.eoo());
+                ids.push_back(batchEnd->_id);
+                idBytes += batchEnd->_id.size();
+                ++batchEnd;
+            }
 
+            std::vector<BSONObj> goods;
             try {
-                // TODO : slow.  lots of round trips.
-                numFetched++;
-                BSONObj good = rollbackSource.findOne(NamespaceString(doc.ns), doc._id.wrap());
-                totalSize += good.objsize();
-                uassert(13410, "replSet too much data to roll back", totalSize < 300 * 1024 * 1024);
-
-                // note good might be eoo, indicating we should delete it
-                goodVersions[doc.ns][doc] = good;
+                numFetched += ids.size();
+                goods = rollbackSource.findByIds(NamespaceString(ns), ids);
             } catch (const DBException& ex) {
                 Status status = ex.toStatus();
                 // If the collection turned into a view, we might get an error trying to
                 // refetch documents, but these errors should be ignored, as we'll be creating
                 // the view during oplog replay.
-                if (status.code() == ErrorCodes::CommandNotSupportedOnView)
+                if (status.code() == ErrorCodes::CommandNotSupportedOnView) {
+                    it = batchEnd;
                     continue;
+                }
 
                 throw ex;
             }
+            refetchBatchesStats.increment();
+            docsRefetchedStats.increment(ids.size());
+
+            // Documents the sync source did not return no longer exist there, which an empty
+            // good version indicates.
+            auto& goodVersionsForNs = goodVersions[ns];
+            for (; it != batchEnd; ++it) {
+                goodVersionsForNs[*it] = BSONObj();
+            }
+            for (auto&& good : goods) {
+                totalSize += good.objsize();
+                uassert(13410, "replSet too much data to roll back", totalSize < 300 * 1024 * 1024);
+
+                DocID doc;
+                doc.ownedObj = good;
+                doc.ns = ns;
+                doc._id = good["_id"];
+                auto goodVersion = goodVersionsForNs.find(doc);
+                if (goodVersion != goodVersionsForNs.end()) {
+                    goodVersion->second = good;
+                }
+            }
         }
         newMinValid = rollbackSource.getLastOperation();
         if (newMinValid.isEmpty()) {
@@ -388,8 +442,8 @@ void syncFixUp(OperationContext* txn,
         }
     } catch (const DBException& e) {
         LOG(1) << "rollback re-get objects: " << redact(e);
-        error() << "rollback couldn't re-get ns:" << doc.ns << " _id:" << redact(doc._id) << ' '
-                << numFetched << '/' << fixUpInfo.toRefetch.size();
+        error() << "rollback couldn't re-get from ns:" << ns << ' ' << numFetched << '/'
+                << fixUpInfo.toRefetch.size();
         throw e;
     }
 
@@ -858,6 +912,7 @@ Status _syncRollback(OperationContext* txn,
         log() << "rollback 2 FindCommonPoint";
         try {
             auto processOperationForFixUp = [&how](const BSONObj& operation) {
+                localOpsScannedStats.increment();
                 return refetch(how, operation);
             };
             auto res = syncRollBackLocalOperations(
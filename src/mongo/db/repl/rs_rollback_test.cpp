@@ -53,9 +53,11 @@
 #include "mongo/db/repl/rs_rollback.h"
 #include "mongo/db/repl/storage_interface.h"
 #include "mongo/db/repl/storage_interface_mock.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context_d_test_fixture.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace {
 
@@ -887,6 +889,108 @@ TEST_F(RSRollbackTest, RollbackApplyOpsCommand) {
         << result;
 }
 
+TEST_F(RSRollbackTest, RollbackRefetchesDocumentsInBatches) {
+    createOplog(_txn.get());
+
+    const auto& serverParams = ServerParameterSet::getGlobal()->getMap();
+    ServerParameter* batchSizeParam = serverParams.find("rollbackRefetchBatchSize")->second;
+    ASSERT_OK(batchSizeParam->setFromString("3"));
+    ON_BLOCK_EXIT([&] { ASSERT_OK(batchSizeParam->setFromString("1000")); });
+
+    {
+        AutoGetOrCreateDb autoDb(_txn.get(), "test", MODE_X);
+        mongo::WriteUnitOfWork wuow(_txn.get());
+        auto coll = autoDb.getDb()->createCollection(_txn.get(), "test.t");
+        ASSERT(coll);
+        OpDebug* const nullOpDebug = nullptr;
+        ASSERT_OK(
+            coll->insertDocument(_txn.get(), BSON("_id" << 1 << "v" << 2), nullOpDebug, false));
+        ASSERT_OK(
+            coll->insertDocument(_txn.get(), BSON("_id" << 2 << "v" << 4), nullOpDebug, false));
+        ASSERT_OK(coll->insertDocument(_txn.get(), BSON("_id" << 4), nullOpDebug, false));
+        wuow.commit();
+    }
+    const auto commonOperation =
+        std::make_pair(BSON("ts" << Timestamp(Seconds(1), 0) << "h" << 1LL), RecordId(1));
+    auto makeOperation = [](int secs, const char* opType, BSONObj o, BSONObj o2) {
+        BSONObjBuilder bob;
+        bob.append("ts", Timestamp(Seconds(secs), 0));
+        bob.append("h", 1LL);
+        bob.append("op", opType);
+        bob.append("ns", "test.t");
+        bob.append("o", o);
+        if (!o2.isEmpty()) {
+            bob.append("o2", o2);
+        }
+        return std::make_pair(bob.obj(), RecordId(secs));
+    };
+    const auto updateOperation1 =
+        makeOperation(2, "u", BSON("_id" << 1 << "v" << 2), BSON("_id" << 1));
+    const auto updateOperation2 =
+        makeOperation(3, "u", BSON("_id" << 2 << "v" << 4), BSON("_id" << 2));
+    const auto deleteOperation = makeOperation(4, "d", BSON("_id" << 3), BSONObj());
+    const auto insertOperation = makeOperation(5, "i", BSON("_id" << 4), BSONObj());
+
+    class RollbackSourceLocal : public RollbackSourceMock {
+    public:
+        RollbackSourceLocal(std::unique_ptr<OplogInterface> oplog)
+            : RollbackSourceMock(std::move(oplog)) {}
+
+        BSONObj findOne(const NamespaceString& nss, const BSONObj& filter) const override {
+            FAIL("Unexpected findOne request") << filter;
+            return {};
+        }
+
+        std::vector<BSONObj> findByIds(const NamespaceString& nss,
+                                       const std::vector<BSONElement>& ids) const override {
+            ASSERT_EQUALS("test.t", nss.ns());
+            batchSizes.push_back(ids.size());
+            std::vector<BSONObj> docs;
+            for (auto&& id : ids) {
+                switch (id.numberInt()) {
+                    case 1:
+                        docs.push_back(BSON("_id" << 1 << "v" << 1));
+                        break;
+                    case 2:
+                        docs.push_back(BSON("_id" << 2 << "v" << 3));
+                        break;
+                    case 3:
+                        docs.push_back(BSON("_id" << 3 << "v" << 5));
+                        break;
+                }
+            }
+            return docs;
+        }
+
+        mutable std::vector<size_t> batchSizes;
+    } rollbackSource(std::unique_ptr<OplogInterface>(new OplogInterfaceMock({commonOperation})));
+
+    ASSERT_OK(syncRollback(
+        _txn.get(),
+        OplogInterfaceMock({insertOperation,
+                            deleteOperation,
+                            updateOperation2,
+                            updateOperation1,
+                            commonOperation}),
+        rollbackSource,
+        _coordinator,
+        noSleep));
+    ASSERT_EQUALS(2U, rollbackSource.batchSizes.size());
+    ASSERT_EQUALS(3U, rollbackSource.batchSizes[0]);
+    ASSERT_EQUALS(1U, rollbackSource.batchSizes[1]);
+
+    AutoGetCollectionForRead acr(_txn.get(), "test.t");
+    BSONObj result;
+    ASSERT(Helpers::findOne(_txn.get(), acr.getCollection(), BSON("_id" << 1), result));
+    ASSERT_EQUALS(1, result["v"].numberInt()) << result;
+    ASSERT(Helpers::findOne(_txn.get(), acr.getCollection(), BSON("_id" << 2), result));
+    ASSERT_EQUALS(3, result["v"].numberInt()) << result;
+    ASSERT(Helpers::findOne(_txn.get(), acr.getCollection(), BSON("_id" << 3), result));
+    ASSERT_EQUALS(5, result["v"].numberInt()) << result;
+    ASSERT_FALSE(Helpers::findOne(_txn.get(), acr.getCollection(), BSON("_id" << 4), result))
+        << result;
+}
+
 TEST_F(RSRollbackTest, RollbackCreateCollectionCommand) {
     createOplog(_txn.get());
     auto commonOperation =
@@ -36,6 +36,7 @@
 #include "third_party/murmurhash3/MurmurHash3.h"
 #include <boost/functional/hash.hpp>
 #include <memory>
+#include <vector>
 
 #include "mongo/base/counter.h"
 #include "mongo/bson/bsonelement_comparator.h"
@@ -69,6 +70,7 @@
 #include "mongo/db/service_context.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -134,10 +136,24 @@ public:
     }
 } exportedBatchLimitOperationsParam;
 
+// When true, an update made redundant by a later update to the same document in the same batch is
+// not applied. Both are still written to the oplog.
+MONGO_EXPORT_SERVER_PARAMETER(replCoalesceUpdatesInBatch, bool, true);
+
+// When true, on storage engines other than MMAP V1 a prefetcher thread reads the documents and
+// index entries of the next batch while the applier is still applying the current one.
+MONGO_EXPORT_SERVER_PARAMETER(replPrefetchNextBatch, bool, false);
+
 // The oplog entries applied
 Counter64 opsAppliedStats;
 ServerStatusMetricField<Counter64> displayOpsApplied("repl.apply.ops", &opsAppliedStats);
 
+// The oplog entries that were not applied because a later update in the same batch superseded them.
+// These are also counted in repl.apply.ops.
+Counter64 opsCoalescedStats;
+ServerStatusMetricField<Counter64> displayOpsCoalesced("repl.apply.opsCoalesced",
+                                                       &opsCoalescedStats);
+
 // Number of times we tried to go live as a secondary.
 Counter64 attemptsToBecomeSecondary;
 ServerStatusMetricField<Counter64> displayAttemptsToBecomeSecondary(
@@ -146,6 +162,42 @@ ServerStatusMetricField<Counter64> displayAttemptsToBecomeSecondary(
 // Number and time of each ApplyOps worker pool round
 TimerStats applyBatchStats;
 ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches", &applyBatchStats);
+
+// Time spent in each stage of the pipeline between the oplog buffer and the applied batch. The
+// batcher thread forms batch N+1 while the applier thread works on batch N, so the two "Waiting"
+// stages show which side is the bottleneck.
+TimerStats batchFormationStats;
+ServerStatusMetricField<TimerStats> displayBatchFormation("repl.apply.pipeline.batchFormation",
+                                                          &batchFormationStats);
+TimerStats batcherWaitStats;
+ServerStatusMetricField<TimerStats> displayBatcherWait(
+    "repl.apply.pipeline.batcherWaitingForApplier", &batcherWaitStats);
+TimerStats applierWaitStats;
+ServerStatusMetricField<TimerStats> displayApplierWait(
+    "repl.apply.pipeline.applierWaitingForBatch", &applierWaitStats);
+TimerStats writerAssignmentStats;
+ServerStatusMetricField<TimerStats> displayWriterAssignment(
+    "repl.apply.pipeline.writerAssignment", &writerAssignmentStats);
+TimerStats oplogWriteStats;
+ServerStatusMetricField<TimerStats> displayOplogWrite("repl.apply.pipeline.oplogWrite",
+                                                      &oplogWriteStats);
+TimerStats writerApplyStats;
+ServerStatusMetricField<TimerStats> displayWriterApply("repl.apply.pipeline.apply",
+                                                       &writerApplyStats);
+TimerStats batchFinalizeStats;
+ServerStatusMetricField<TimerStats> displayBatchFinalize("repl.apply.pipeline.finalize",
+                                                         &batchFinalizeStats);
+
+// Ops of the next batch that the batcher prefetched before the applier started on the batch
+// (hits), and those it did not get to in time (misses). A low hit rate means the applier is
+// rarely busy long enough for prefetching to help.
+Counter64 prefetchNextBatchHits;
+ServerStatusMetricField<Counter64> displayPrefetchNextBatchHits("repl.preload.nextBatch.hits",
+                                                                &prefetchNextBatchHits);
+Counter64 prefetchNextBatchMisses;
+ServerStatusMetricField<Counter64> displayPrefetchNextBatchMisses("repl.preload.nextBatch.misses",
+                                                                  &prefetchNextBatchMisses);
+
 void initializePrefetchThread() {
     if (!Client::getCurrent()) {
         Client::initThreadIfNotAlready();
@@ -404,21 +456,17 @@ Status SyncTail::syncApply(OperationContext* txn,
 
 namespace {
 
-// The pool threads call this to prefetch each op
-void prefetchOp(const BSONObj& op) {
-    initializePrefetchThread();
-
+// Prefetches the pages 'op' will touch using the caller's operation context.
+void prefetchOpWithContext(OperationContext* txn, const BSONObj& op) {
     const char* ns = op.getStringField("ns");
     if (ns && (ns[0] != '\0')) {
         try {
             // one possible tweak here would be to stay in the read lock for this database
             // for multiple prefetches if they are for the same database.
-            const ServiceContext::UniqueOperationContext txnPtr = cc().makeOperationContext();
-            OperationContext& txn = *txnPtr;
-            AutoGetCollectionForRead ctx(&txn, ns);
+            AutoGetCollectionForRead ctx(txn, ns);
             Database* db = ctx.getDb();
             if (db) {
-                prefetchPagesForReplicatedOp(&txn, db, op);
+                prefetchPagesForReplicatedOp(txn, db, op);
             }
         } catch (const DBException& e) {
             LOG(2) << "ignoring exception in prefetchOp(): " << redact(e) << endl;
@@ -429,6 +477,14 @@ void prefetchOp(const BSONObj& op) {
     }
 }
 
+// The pool threads call this to prefetch each op
+void prefetchOp(const BSONObj& op) {
+    initializePrefetchThread();
+
+    const ServiceContext::UniqueOperationContext txnPtr = cc().makeOperationContext();
+    prefetchOpWithContext(txnPtr.get(), op);
+}
+
 // Doles out all the work to the reader pool threads and waits for them to complete
 void prefetchOps(const MultiApplier::Operations& ops, OldThreadPool* prefetcherPool) {
     invariant(prefetcherPool);
@@ -568,35 +624,111 @@ private:
     StringMap<CollectionProperties> _cache;
 };
 
+/**
+ * Adds the paths of the $set modifier in 'update' to 'setPaths', in the order they are listed.
+ * Returns false if 'update' is a replacement or uses any modifier other than a single $set.
+ */
+bool getSetPaths(const BSONObj& update, std::vector<StringData>* setPaths) {
+    if (update.nFields() != 1) {
+        return false;
+    }
+
+    const BSONElement modifier = update.firstElement();
+    if (modifier.fieldNameStringData() != "$set" || modifier.type() != Object) {
+        return false;
+    }
+
+    for (auto&& field : modifier.Obj()) {
+        setPaths->push_back(field.fieldNameStringData());
+    }
+    return true;
+}
+
+/**
+ * Returns true if applying the update 'later' on its own leaves a document in the same state,
+ * including the order of its fields, as applying the update 'earlier' followed by 'later'. Both
+ * must be updates to the same document.
+ *
+ * Replacement-style updates supersede any earlier update. A $set update supersedes an earlier
+ * $set update of exactly the same paths in the same order, since $set appends the fields it
+ * creates in the order they are listed: after {$set: {a: 1}} creates 'a', a later
+ * {$set: {b: 1, a: 2}} applied on its own would create 'b' before 'a'. An earlier update which
+ * may upsert is never superseded, since whether it creates the document decides what the later
+ * update applies to.
+ */
+bool updateSupersedes(const OplogEntry& later, const OplogEntry& earlier) {
+    invariant(later.opType == "u" && earlier.opType == "u");
+    if (later.o.type() != Object || earlier.o.type() != Object || later.o2.type() != Object ||
+        earlier.o2.type() != Object || !later.o2.Obj().binaryEqual(earlier.o2.Obj())) {
+        return false;
+    }
+
+    // Initial sync applies updates as upserts only if they carry 'b'.
+    if (earlier.raw["b"].booleanSafe()) {
+        return false;
+    }
+
+    const BSONObj laterUpdate = later.o.Obj();
+    if (!laterUpdate.isEmpty() && laterUpdate.firstElementFieldName()[0] != '$') {
+        return true;
+    }
+
+    std::vector<StringData> laterSetPaths;
+    std::vector<StringData> earlierSetPaths;
+    if (!getSetPaths(laterUpdate, &laterSetPaths) ||
+        !getSetPaths(earlier.o.Obj(), &earlierSetPaths)) {
+        return false;
+    }
+
+    return laterSetPaths == earlierSetPaths;
+}
+
 // This only modifies the isForCappedCollection field on each op. It does not alter the ops vector
-// in any other way.
+// in any other way. An update which is superseded by a later update to the same document in 'ops'
+// is left out of writerVectors.
 void fillWriterVectors(OperationContext* txn,
                        MultiApplier::Operations* ops,
                        std::vector<MultiApplier::OperationPtrs>* writerVectors) {
     const bool supportsDocLocking =
         getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking();
+    const bool coalesceUpdates = replCoalesceUpdatesInBatch.load();
     const uint32_t numWriters = writerVectors->size();
 
     CachedCollectionProperties collPropertiesCache;
 
+    // The most recent update to each document, keyed by the hash of its namespace and _id. Every
+    // op on a document has the same key, and ops on a document always go to the same writer.
+    struct LastUpdate {
+        const OplogEntry* op;
+        size_t positionInWriter;
+    };
+    stdx::unordered_map<uint32_t, LastUpdate> lastUpdates;
+    size_t numCoalesced = 0;
+
     for (auto&& op : *ops) {
         StringMapTraits::HashedKey hashedNs(op.ns);
         uint32_t hash = hashedNs.hash();
+        uint32_t docHash = 0;
+        bool trackDocument = false;
 
         if (op.isCrudOpType()) {
             auto collProperties = collPropertiesCache.getCollectionProperties(txn, hashedNs);
+            BSONElement id = op.getIdElement();
+            BSONElementComparator elementHasher(BSONElementComparator::FieldNamesMode::kIgnore,
+                                                collProperties.collator);
 
-            // For doc locking engines, include the _id of the document in the hash so we get
-            // parallelism even if all writes are to a single collection.
-            //
-            // For capped collections, this is illegal, since capped collections must preserve
-            // insertion order.
-            if (supportsDocLocking && !collProperties.isCapped) {
-                BSONElement id = op.getIdElement();
-                BSONElementComparator elementHasher(BSONElementComparator::FieldNamesMode::kIgnore,
-                                                    collProperties.collator);
+            // Capped collections must preserve insertion order, so their ops are neither spread
+            // across writers by _id nor coalesced.
+            if (!collProperties.isCapped && !id.eoo()) {
                 const size_t idHash = elementHasher.hash(id);
-                MurmurHash3_x86_32(&idHash, sizeof(idHash), hash, &hash);
+                MurmurHash3_x86_32(&idHash, sizeof(idHash), hashedNs.hash(), &docHash);
+                trackDocument = coalesceUpdates;
+
+                // For doc locking engines, include the _id of the document in the hash so we get
+                // parallelism even if all writes are to a single collection.
+                if (supportsDocLocking) {
+                    hash = docHash;
+                }
             }
 
             if (op.opType == "i" && collProperties.isCapped) {
@@ -604,12 +736,38 @@ void fillWriterVectors(OperationContext* txn,
                 // bulk insert them.
                 op.isForCappedCollection = true;
             }
+
+            if (trackDocument) {
+                auto it = lastUpdates.find(docHash);
+                if (it != lastUpdates.end() && op.opType == "u" && it->second.op->ns == op.ns &&
+                    elementHasher.evaluate(it->second.op->getIdElement() == id) &&
+                    updateSupersedes(op, *it->second.op)) {
+                    (*writerVectors)[hash % numWriters][it->second.positionInWriter] = nullptr;
+                    numCoalesced++;
+                }
+            }
         }
 
         auto& writer = (*writerVectors)[hash % numWriters];
         if (writer.empty())
             writer.reserve(8);  // skip a few growth rounds.
         writer.push_back(&op);
+
+        if (trackDocument) {
+            if (op.opType == "u") {
+                lastUpdates[docHash] = {&op, writer.size() - 1};
+            } else {
+                lastUpdates.erase(docHash);
+            }
+        }
+    }
+
+    if (numCoalesced) {
+        for (auto&& writer : *writerVectors) {
+            writer.erase(std::remove(writer.begin(), writer.end(), nullptr), writer.end());
+        }
+        opsAppliedStats.increment(numCoalesced);
+        opsCoalescedStats.increment(numCoalesced);
     }
 }
 
@@ -670,10 +828,14 @@ class SyncTail::OpQueueBatcher {
     MONGO_DISALLOW_COPYING(OpQueueBatcher);
 
 public:
-    OpQueueBatcher(SyncTail* syncTail) : _syncTail(syncTail), _thread([this] { run(); }) {}
+    OpQueueBatcher(SyncTail* syncTail)
+        : _syncTail(syncTail),
+          _prefetchThread([this] { _prefetchLoop(); }),
+          _thread([this] { run(); }) {}
     ~OpQueueBatcher() {
         invariant(_isDead);
         _thread.join();
+        _prefetchThread.join();
     }
 
     OpQueue getNextBatch(Seconds maxWaitTime) {
@@ -706,6 +868,10 @@ private:
         BatchLimits batchLimits;
         batchLimits.bytes = std::min(oplogMaxSize / 10, size_t(replBatchLimitBytes));
 
+        // MMAP V1 prefetches in multiApply() instead, under the parallel batch writer lock
+        const bool canPrefetchNextBatch =
+            !txn.getServiceContext()->getGlobalStorageEngine()->isMmapV1();
+
         while (true) {
             const auto slaveDelay = replCoord->getSlaveDelaySecs();
             batchLimits.slaveDelayLatestTimestamp = (slaveDelay > Seconds(0))
@@ -716,6 +882,7 @@ private:
             batchLimits.ops = replBatchLimitOperations.load();
 
             OpQueue ops;
+            Timer batchFormationTimer;
             // tryPopAndWaitForMore adds to ops and returns true when we need to end a batch early.
             while (!_syncTail->tryPopAndWaitForMore(&txn, &ops, batchLimits)) {
             }
@@ -734,30 +901,112 @@ private:
             if (ops.empty() && !ops.mustShutdown()) {
                 continue;  // Don't emit empty batches.
             }
+            batchFormationStats.record(batchFormationTimer);
+
+            std::vector<BSONObj> opsToPrefetch;
+            if (canPrefetchNextBatch && replPrefetchNextBatch.load()) {
+                opsToPrefetch.reserve(ops.getCount());
+                for (auto&& op : ops.getBatch()) {
+                    if (op.isCrudOpType()) {
+                        opsToPrefetch.push_back(op.raw);
+                    }
+                }
+            }
 
-            stdx::unique_lock<stdx::mutex> lk(_mutex);
-            // Block until the previous batch has been taken.
-            _cv.wait(lk, [&] { return _ops.empty(); });
-            _ops = std::move(ops);
-            _cv.notify_all();
-            if (_ops.mustShutdown()) {
-                _isDead = true;
-                return;
+            {
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                // Block until the previous batch has been taken.
+                Timer batcherWaitTimer;
+                _cv.wait(lk, [&] { return _ops.empty(); });
+                batcherWaitStats.record(batcherWaitTimer);
+                _ops = std::move(ops);
+                _cv.notify_all();
+                if (_ops.mustShutdown()) {
+                    _prefetchShutdown = true;
+                    _prefetchCv.notify_all();
+                    _isDead = true;
+                    return;
+                }
+
+                // Replaces the ops of an earlier batch, which the applier has taken already
+                if (!opsToPrefetch.empty()) {
+                    _opsToPrefetch = std::move(opsToPrefetch);
+                    _prefetchCv.notify_all();
+                }
             }
         }
     }
 
+    /**
+     * Body of the prefetcher thread. Prefetches the batches handed to it by the batcher, so that
+     * neither the batcher nor its operation context ever waits on the locks prefetching takes.
+     */
+    void _prefetchLoop() {
+        Client::initThread("ReplPrefetcher");
+        const ServiceContext::UniqueOperationContext txnPtr = cc().makeOperationContext();
+
+        // The applier holds the parallel batch writer lock while it applies the previous batch,
+        // which is when prefetching helps. Only this thread's reads skip it, and they are never
+        // returned to anyone.
+        txnPtr->lockState()->setShouldConflictWithSecondaryBatchApplication(false);
+
+        while (true) {
+            std::vector<BSONObj> ops;
+            {
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                _prefetchCv.wait(lk, [&] { return _prefetchShutdown || !_opsToPrefetch.empty(); });
+                if (_prefetchShutdown) {
+                    return;
+                }
+                ops = std::move(_opsToPrefetch);
+                _opsToPrefetch.clear();
+            }
+
+            _prefetchWaitingBatch(txnPtr.get(), ops);
+        }
+    }
+
+    /**
+     * Warms the storage engine cache for the ops of the batch waiting in '_ops' while the applier
+     * is still busy with the previous batch. Stops as soon as the applier takes the batch so that
+     * prefetching never races the writer threads.
+     */
+    void _prefetchWaitingBatch(OperationContext* txn, const std::vector<BSONObj>& ops) {
+        size_t numPrefetched = 0;
+        for (auto&& op : ops) {
+            {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                if (_ops.empty()) {
+                    break;
+                }
+            }
+            prefetchOpWithContext(txn, op);
+            // Do not hold on to a snapshot while the applier writes.
+            txn->recoveryUnit()->abandonSnapshot();
+            ++numPrefetched;
+        }
+        prefetchNextBatchHits.increment(numPrefetched);
+        prefetchNextBatchMisses.increment(ops.size() - numPrefetched);
+    }
+
     SyncTail* const _syncTail;
 
-    stdx::mutex _mutex;  // Guards _ops.
+    stdx::mutex _mutex;  // Guards _ops, _opsToPrefetch and _prefetchShutdown.
     stdx::condition_variable _cv;
     OpQueue _ops;
 
+    // The ops of the batch in '_ops', which the prefetcher thread has not picked up yet
+    stdx::condition_variable _prefetchCv;
+    std::vector<BSONObj> _opsToPrefetch;
+    bool _prefetchShutdown = false;
+
     // This only exists so the destructor invariants rather than deadlocking.
     // TODO remove once we trust noexcept enough to mark oplogApplication() as noexcept.
     bool _isDead = false;
 
-    stdx::thread _thread;  // Must be last so all other members are initialized before starting.
+    // These must be last so all other members are initialized before starting.
+    stdx::thread _prefetchThread;
+    stdx::thread _thread;
 };
 
 void SyncTail::oplogApplication(ReplicationCoordinator* replCoord) {
@@ -770,9 +1019,17 @@ void SyncTail::oplogApplication(ReplicationCoordinator* replCoord) {
             ? new ApplyBatchFinalizerForJournal(replCoord)
             : new ApplyBatchFinalizer(replCoord)};
 
+    // Runs from when the applier starts waiting for a batch until a non-empty one arrives, across
+    // all the empty polls in between.
+    boost::optional<Timer> applierWaitTimer;
+
     while (true) {  // Exits on message from OpQueueBatcher.
         tryToGoLiveAsASecondary(&txn, replCoord);
 
+        if (!applierWaitTimer) {
+            applierWaitTimer.emplace();
+        }
+
         // Blocks up to a second waiting for a batch to be ready to apply. If one doesn't become
         // ready in time, we'll loop again so we can do the above checks periodically.
         OpQueue ops = batcher.getNextBatch(Seconds(1));
@@ -792,6 +1049,8 @@ void SyncTail::oplogApplication(ReplicationCoordinator* replCoord) {
             }
             continue;  // This wasn't a real op. Don't try to apply it.
         }
+        applierWaitStats.record(*applierWaitTimer);
+        applierWaitTimer = boost::none;
 
         // Extract some info from ops that we'll need after releasing the batch below.
         const auto firstOpTimeInBatch =
@@ -818,6 +1077,7 @@ void SyncTail::oplogApplication(ReplicationCoordinator* replCoord) {
 
         // Update various things that care about our last applied optime. Tests rely on 2 happening
         // before 3 even though it isn't strictly necessary. The order of 1 doesn't matter.
+        TimerHolder finalizeTimer(&batchFinalizeStats);
         setNewTimestamp(lastOpTimeInBatch.getTimestamp());                        // 1
         StorageInterface::get(&txn)->setAppliedThrough(&txn, lastOpTimeInBatch);  // 2
         finalizer->record(lastOpTimeInBatch);                                     // 3
@@ -1276,16 +1536,24 @@ StatusWith<OpTime> multiApply(OperationContext* txn,
         std::vector<MultiApplier::OperationPtrs> writerVectors(workerPool->getNumThreads());
         ON_BLOCK_EXIT([&] { workerPool->join(); });
 
+        TimerHolder oplogWriteTimer(&oplogWriteStats);
         storage->setOplogDeleteFromPoint(txn, ops.front().ts.timestamp());
         scheduleWritesToOplog(txn, workerPool, ops);
-        fillWriterVectors(txn, &ops, &writerVectors);
+        {
+            // Runs on this thread while the pool writes the batch to the oplog.
+            TimerHolder writerAssignmentTimer(&writerAssignmentStats);
+            fillWriterVectors(txn, &ops, &writerVectors);
+        }
 
         workerPool->join();
+        oplogWriteTimer.recordMillis();
 
         storage->setOplogDeleteFromPoint(txn, Timestamp());
         storage->setMinValidToAtLeast(txn, ops.back().getOpTime());
 
+        TimerHolder applyTimer(&writerApplyStats);
         applyOps(writerVectors, workerPool, applyOperation, &statusVector);
+        workerPool->join();
     }
 
     // If any of the statuses is not ok, return error.
@@ -603,6 +603,125 @@ TEST_F(SyncTailTest, MultiApplyAssignsOperationsToWriterThreadsBasedOnNamespaceH
     ASSERT_BSONOBJ_EQ(op2.raw, operationsWrittenToOplog[1]);
 }
 
+std::vector<OplogEntry> _testMultiApplyUpdates(OperationContext* txn,
+                                                const MultiApplier::Operations& ops) {
+    OldThreadPool writerPool(2);
+    stdx::mutex mutex;
+    std::vector<OplogEntry> operationsApplied;
+    auto applyOperationFn = [&mutex, &operationsApplied](
+        MultiApplier::OperationPtrs* operationsForWriterThreadToApply) -> Status {
+        stdx::lock_guard<stdx::mutex> lock(mutex);
+        for (auto&& opPtr : *operationsForWriterThreadToApply) {
+            operationsApplied.push_back(*opPtr);
+        }
+        return Status::OK();
+    };
+
+    auto lastOpTime = unittest::assertGet(multiApply(txn, &writerPool, ops, applyOperationFn));
+    ASSERT_EQUALS(ops.back().getOpTime(), lastOpTime);
+
+    std::sort(operationsApplied.begin(),
+              operationsApplied.end(),
+              [](const OplogEntry& l, const OplogEntry& r) {
+                  return l.getOpTime() < r.getOpTime();
+              });
+    return operationsApplied;
+}
+
+TEST_F(SyncTailTest, MultiApplyCoalescesSupersededUpdatesToTheSameDocument) {
+    NamespaceString nss("test.t");
+    auto doc1 = BSON("_id" << 1);
+    auto doc2 = BSON("_id" << 2);
+    auto op1 = makeUpdateDocumentOplogEntry(
+        {Timestamp(Seconds(1), 0), 1LL}, nss, doc1, BSON("$set" << BSON("x" << 1)));
+    auto op2 = makeUpdateDocumentOplogEntry(
+        {Timestamp(Seconds(2), 0), 1LL}, nss, doc2, BSON("$set" << BSON("x" << 1)));
+    auto op3 = makeUpdateDocumentOplogEntry(
+        {Timestamp(Seconds(3), 0), 1LL}, nss, doc1, BSON("$set" << BSON("x" << 2)));
+    auto op4 = makeUpdateDocumentOplogEntry(
+        {Timestamp(Seconds(4), 0), 1LL}, nss, doc1, BSON("$set" << BSON("x" << 3 << "y" << 1)));
+    auto op5 = makeUpdateDocumentOplogEntry(
+        {Timestamp(Seconds(5), 0), 1LL}, nss, doc1, BSON("_id" << 1 << "z" << 1));
+
+    // op1 is superseded by op3. op4 also sets "y", so it does not supersede op3, but it is itself
+    // superseded by the replacement in op5.
+    auto operationsApplied = _testMultiApplyUpdates(_txn.get(), {op1, op2, op3, op4, op5});
+    ASSERT_EQUALS(3U, operationsApplied.size());
+    ASSERT_EQUALS(op2, operationsApplied[0]);
+    ASSERT_EQUALS(op3, operationsApplied[1]);
+    ASSERT_EQUALS(op5, operationsApplied[2]);
+}
+
+TEST_F(SyncTailTest, MultiApplyDoesNotCoalesceUpdatesSeparatedByAnotherOperationOnTheDocument) {
+    NamespaceString nss("test.t");
+    auto doc = BSON("_id" << 1);
+    auto op1 = makeUpdateDocumentOplogEntry(
+        {Timestamp(Seconds(1), 0), 1LL}, nss, doc, BSON("$set" << BSON("x" << 1)));
+    auto op2 = makeInsertDocumentOplogEntry({Timestamp(Seconds(2), 0), 1LL}, nss, doc);
+    auto op3 = makeUpdateDocumentOplogEntry(
+        {Timestamp(Seconds(3), 0), 1LL}, nss, doc, BSON("$set" << BSON("x" << 2)));
+
+    auto operationsApplied = _testMultiApplyUpdates(_txn.get(), {op1, op2, op3});
+    ASSERT_EQUALS(3U, operationsApplied.size());
+}
+
+TEST_F(SyncTailTest, MultiApplyDoesNotCoalesceUpdateThatSetsAPreviouslyUnsetField) {
+    // Unsetting and then setting a field moves it to the end of the document, which applying the
+    // second update on its own would not.
+    NamespaceString nss("test.t");
+    auto doc = BSON("_id" << 1);
+    auto op1 = makeUpdateDocumentOplogEntry(
+        {Timestamp(Seconds(1), 0), 1LL}, nss, doc, BSON("$unset" << BSON("x" << true)));
+    auto op2 = makeUpdateDocumentOplogEntry(
+        {Timestamp(Seconds(2), 0), 1LL}, nss, doc, BSON("$set" << BSON("x" << 2)));
+
+    auto operationsApplied = _testMultiApplyUpdates(_txn.get(), {op1, op2});
+    ASSERT_EQUALS(2U, operationsApplied.size());
+    ASSERT_EQUALS(op1, operationsApplied[0]);
+    ASSERT_EQUALS(op2, operationsApplied[1]);
+}
+
+TEST_F(SyncTailTest, MultiApplyDoesNotCoalesceUpdateThatCreatesFieldsInAnotherOrder) {
+    // The first update creates "a". Applying the second update on its own would create "b"
+    // before "a", while applying both leaves "a" before "b".
+    NamespaceString nss("test.t");
+    auto doc = BSON("_id" << 1);
+    auto op1 = makeUpdateDocumentOplogEntry(
+        {Timestamp(Seconds(1), 0), 1LL}, nss, doc, BSON("$set" << BSON("a" << 1)));
+    auto op2 = makeUpdateDocumentOplogEntry(
+        {Timestamp(Seconds(2), 0), 1LL}, nss, doc, BSON("$set" << BSON("b" << 1 << "a" << 2)));
+    auto op3 = makeUpdateDocumentOplogEntry(
+        {Timestamp(Seconds(3), 0), 1LL}, nss, doc, BSON("$set" << BSON("a" << 3 << "b" << 2)));
+
+    // The paths of op3 are those of op2 in another order, so it does not supersede op2 either.
+    auto operationsApplied = _testMultiApplyUpdates(_txn.get(), {op1, op2, op3});
+    ASSERT_EQUALS(3U, operationsApplied.size());
+    ASSERT_EQUALS(op1, operationsApplied[0]);
+    ASSERT_EQUALS(op2, operationsApplied[1]);
+    ASSERT_EQUALS(op3, operationsApplied[2]);
+}
+
+TEST_F(SyncTailTest, MultiApplyDoesNotCoalesceUpsert) {
+    NamespaceString nss("test.t");
+    auto doc = BSON("_id" << 1);
+    BSONObjBuilder bob;
+    bob.appendElements(OpTime(Timestamp(Seconds(1), 0), 1LL).toBSON());
+    bob.append("h", 1LL);
+    bob.append("op", "u");
+    bob.append("ns", nss.ns());
+    bob.append("o2", doc);
+    bob.append("o", BSON("$set" << BSON("x" << 1)));
+    bob.append("b", true);
+    OplogEntry op1(bob.obj());
+    auto op2 = makeUpdateDocumentOplogEntry(
+        {Timestamp(Seconds(2), 0), 1LL}, nss, doc, BSON("_id" << 1 << "x" << 2));
+
+    auto operationsApplied = _testMultiApplyUpdates(_txn.get(), {op1, op2});
+    ASSERT_EQUALS(2U, operationsApplied.size());
+    ASSERT_EQUALS(op1, operationsApplied[0]);
+    ASSERT_EQUALS(op2, operationsApplied[1]);
+}
+
 TEST_F(SyncTailTest, MultiSyncApplyUsesSyncApplyToApplyOperation) {
     NamespaceString nss("local." + _agent.getSuiteName() + "_" + _agent.getTestName());
     auto op = makeCreateCollectionOplogEntry({Timestamp(Seconds(1), 0), 1LL}, nss);
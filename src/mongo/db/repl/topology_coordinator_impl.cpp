@@ -32,6 +32,7 @@
 
 #include "mongo/db/repl/topology_coordinator_impl.h"
 
+#include <algorithm>
 #include <limits>
 
 #include "mongo/db/audit.h"
@@ -65,6 +66,15 @@ const Seconds TopologyCoordinatorImpl::VoteLease::leaseTime = Seconds(30);
 // must be before it will call for a priority takeover election.
 MONGO_EXPORT_STARTUP_SERVER_PARAMETER(priorityTakeoverFreshnessWindowSeconds, int, 2);
 
+// Whether a secondary switches away from a healthy sync source when another member scores clearly
+// better for syncSourceSwitchWindowSeconds. Off by default, because all secondaries score the same
+// heartbeat data and would otherwise tend to switch to the same member at about the same time.
+MONGO_EXPORT_SERVER_PARAMETER(enableSyncSourceSwitching, bool, false);
+
+// How long the same member must score clearly better than the current sync source before a
+// secondary switches to it.
+MONGO_EXPORT_SERVER_PARAMETER(syncSourceSwitchWindowSeconds, int, 60);
+
 namespace {
 
 template <typename T>
@@ -75,6 +85,16 @@ int indexOfIterator(const std::vector<T>& vec, typename std::vector<T>::const_it
 // Maximum number of retries for a failed heartbeat.
 const int kMaxHeartbeatRetries = 2;
 
+// Added to the sync source score of a member for each member that already syncs from it.
+const Milliseconds kSyncSourceLoadPenalty(10);
+
+// Added to the sync source score of a member for each second its applied optime is behind the
+// most recent applied optime of any up member.
+const Milliseconds kSyncSourceLagPenalty(10);
+
+// How much better than the current sync source another member must score to replace it.
+const Milliseconds kSyncSourceScoreMargin(20);
+
 /**
  * Returns true if the only up heartbeats are auth errors.
  */
@@ -132,6 +152,7 @@ TopologyCoordinatorImpl::TopologyCoordinatorImpl(Options options)
       _term(OpTime::kUninitializedTerm),
       _currentPrimaryIndex(-1),
       _forceSyncSourceIndex(-1),
+      _betterSyncSourceIndex(-1),
       _options(std::move(options)),
       _selfIndex(-1),
       _stepDownPending(false),
@@ -162,6 +183,9 @@ HostAndPort TopologyCoordinatorImpl::chooseNewSyncSource(Date_t now,
         return HostAndPort();
     }
 
+    _betterSyncSourceIndex = -1;
+    _betterSyncSourceSince = Date_t();
+
     // if we have a target we've requested to sync from, use it
     if (_forceSyncSourceIndex != -1) {
         invariant(_forceSyncSourceIndex < _rsConfig.getNumMembers());
@@ -212,7 +236,7 @@ HostAndPort TopologyCoordinatorImpl::chooseNewSyncSource(Date_t now,
         }
     }
 
-    // find the member with the lowest ping time that is ahead of me
+    // find the member with the best sync source score that is ahead of me
 
     // choose a time that will exclude no candidates by default, in case we don't see a primary
     OpTime oldestSyncOpTime;
@@ -233,6 +257,7 @@ HostAndPort TopologyCoordinatorImpl::chooseNewSyncSource(Date_t now,
     }
 
     int closestIndex = -1;
+    Milliseconds closestScore;
 
     // Make two attempts, with less restrictive rules the second time.
     //
@@ -313,12 +338,12 @@ HostAndPort TopologyCoordinatorImpl::chooseNewSyncSource(Date_t now,
                        << it->getAppliedOpTime().getTimestamp().toBSON();
                 continue;
             }
-            // Candidate cannot be more latent than anything we've already considered.
-            if ((closestIndex != -1) &&
-                (_getPing(itMemberConfig.getHostAndPort()) >
-                 _getPing(_rsConfig.getMemberAt(closestIndex).getHostAndPort()))) {
-                LOG(2) << "Cannot select sync source with higher latency than the best candidate: "
-                       << itMemberConfig.getHostAndPort();
+            // Candidate cannot score worse than anything we've already considered.
+            const Milliseconds score = _getSyncSourceScore(itIndex);
+            if ((closestIndex != -1) && (score > closestScore)) {
+                LOG(2) << "Cannot select sync source with a worse score than the best candidate: "
+                       << itMemberConfig.getHostAndPort() << ", score: " << score
+                       << ", best score: " << closestScore;
 
                 continue;
             }
@@ -331,6 +356,7 @@ HostAndPort TopologyCoordinatorImpl::chooseNewSyncSource(Date_t now,
             }
             // This candidate has passed all tests; set 'closestIndex'
             closestIndex = itIndex;
+            closestScore = score;
         }
         if (closestIndex != -1)
             break;  // no need for second attempt
@@ -1064,6 +1090,7 @@ HeartbeatResponseAction TopologyCoordinatorImpl::processHeartbeatResponse(
                << ", msg:  " << hbr.getHbMsg();
         hbData.setUpValues(now, member.getHostAndPort(), std::move(hbr));
     }
+    _updateBetterSyncSourceSince(now);
 
     HeartbeatResponseAction nextAction;
     if (_rsConfig.getProtocolVersion() == 0) {
@@ -1945,6 +1972,8 @@ void TopologyCoordinatorImpl::updateConfig(const ReplicaSetConfig& newConfig,
     _rsConfig = newConfig;
     _selfIndex = selfIndex;
     _forceSyncSourceIndex = -1;
+    _betterSyncSourceIndex = -1;
+    _betterSyncSourceSince = Date_t();
 
     if (_role == Role::leader) {
         if (_selfIndex == -1) {
@@ -2156,6 +2185,74 @@ Milliseconds TopologyCoordinatorImpl::_getPing(const HostAndPort& host) {
     return _pings[host].getMillis();
 }
 
+Milliseconds TopologyCoordinatorImpl::_getSyncSourceScore(int memberIndex) {
+    const HostAndPort& host = _rsConfig.getMemberAt(memberIndex).getHostAndPort();
+    int numSyncingFrom = 0;
+    long long latestSecs = 0;
+    for (const auto& hbdata : _hbdata) {
+        if (!hbdata.up()) {
+            continue;
+        }
+        if (hbdata.getSyncSource() == host) {
+            ++numSyncingFrom;
+        }
+        latestSecs = std::max(latestSecs, hbdata.getAppliedOpTime().getSecs());
+    }
+
+    const long long lagSecs = latestSecs - _hbdata.at(memberIndex).getAppliedOpTime().getSecs();
+
+    return _getPing(host) + kSyncSourceLoadPenalty * numSyncingFrom +
+        kSyncSourceLagPenalty * lagSecs;
+}
+
+void TopologyCoordinatorImpl::_updateBetterSyncSourceSince(Date_t now) {
+    const int currentSourceIndex =
+        _syncSource.empty() ? -1 : _rsConfig.findMemberIndexByHostAndPort(_syncSource);
+    if (currentSourceIndex == -1 || currentSourceIndex == _selfIndex || _selfIndex == -1 ||
+        !_rsConfig.isChainingAllowed() || !enableSyncSourceSwitching.load()) {
+        _betterSyncSourceIndex = -1;
+        _betterSyncSourceSince = Date_t();
+        return;
+    }
+
+    const OpTime currentSourceOpTime = _hbdata.at(currentSourceIndex).getAppliedOpTime();
+    const Milliseconds currentScore = _getSyncSourceScore(currentSourceIndex);
+    auto isBetterSyncSource = [&](int itIndex) {
+        if (itIndex == _selfIndex || itIndex == currentSourceIndex) {
+            return false;
+        }
+        // Only consider members that chooseNewSyncSource() would pick on its first attempt and
+        // that are at least as far along as the current sync source.
+        const MemberHeartbeatData& itData = _hbdata.at(itIndex);
+        const MemberConfig& itMemberConfig = _rsConfig.getMemberAt(itIndex);
+        if (!itData.up() || !itData.getState().readable() ||
+            (_selfConfig().isVoter() && !itMemberConfig.isVoter()) || itMemberConfig.isHidden() ||
+            _selfConfig().getSlaveDelay() < itMemberConfig.getSlaveDelay() ||
+            (_selfConfig().shouldBuildIndexes() && !itMemberConfig.shouldBuildIndexes()) ||
+            itData.getAppliedOpTime() < currentSourceOpTime ||
+            _memberIsBlacklisted(itMemberConfig, now)) {
+            return false;
+        }
+        return _getSyncSourceScore(itIndex) + kSyncSourceScoreMargin < currentScore;
+    };
+
+    // Keep timing the member we already track for as long as it stays clearly better, so that
+    // the switch window only completes when a single member has been better throughout it.
+    if (_betterSyncSourceIndex != -1 && isBetterSyncSource(_betterSyncSourceIndex)) {
+        return;
+    }
+
+    for (int itIndex = 0; itIndex < static_cast<int>(_hbdata.size()); ++itIndex) {
+        if (isBetterSyncSource(itIndex)) {
+            _betterSyncSourceIndex = itIndex;
+            _betterSyncSourceSince = now;
+            return;
+        }
+    }
+    _betterSyncSourceIndex = -1;
+    _betterSyncSourceSince = Date_t();
+}
+
 void TopologyCoordinatorImpl::_setElectionTime(const Timestamp& newElectionTime) {
     _electionTime = newElectionTime;
 }
@@ -2451,6 +2548,19 @@ bool TopologyCoordinatorImpl::shouldChangeSyncSource(const HostAndPort& currentS
         return true;
     }
 
+    // Change sync source if the same other member has scored clearly better than the current
+    // one, by the measure chooseNewSyncSource() uses, for long enough to not be a passing
+    // fluctuation.
+    if (enableSyncSourceSwitching.load() && currentSource == _syncSource &&
+        _betterSyncSourceIndex != -1 && _betterSyncSourceSince != Date_t() &&
+        now - _betterSyncSourceSince >= Seconds(syncSourceSwitchWindowSeconds.load())) {
+        log() << "re-evaluating sync source because "
+              << _rsConfig.getMemberAt(_betterSyncSourceIndex).getHostAndPort()
+              << " has been a better sync source than " << currentSource << " since "
+              << _betterSyncSourceSince;
+        return true;
+    }
+
     unsigned int currentSecs = currentSourceOpTime.getSecs();
     unsigned int goalSecs = currentSecs + durationCount<Seconds>(_options.maxSyncSourceLagSecs);
 
@@ -290,6 +290,15 @@ private:
     // Returns the current "ping" value for the given member by their address
     Milliseconds _getPing(const HostAndPort& host);
 
+    // Returns how costly it would be to sync from the member at "memberIndex"; lower is better.
+    // This is the member's ping time plus penalties for the members already syncing from it and
+    // for how far its applied optime is behind the most recent one among up members.
+    Milliseconds _getSyncSourceScore(int memberIndex);
+
+    // Records which member scores clearly better than our current sync source and since when, or
+    // clears both if no member does. A different member becoming better restarts the time.
+    void _updateBetterSyncSourceSince(Date_t now);
+
     // Determines if we will veto the member specified by "args.id", given that the last op
     // we have applied locally is "lastOpApplied".
     // If we veto, the errmsg will be filled in with a reason
@@ -399,6 +408,10 @@ private:
     std::map<HostAndPort, Date_t> _syncSourceBlacklist;
     // The next sync source to be chosen, requested via a replSetSyncFrom command
     int _forceSyncSourceIndex;
+    // The member that has scored clearly better than _syncSource, or -1 if none does
+    int _betterSyncSourceIndex;
+    // Since when _betterSyncSourceIndex has scored clearly better than _syncSource
+    Date_t _betterSyncSourceSince;
 
     // Options for this TopologyCoordinator
     Options _options;
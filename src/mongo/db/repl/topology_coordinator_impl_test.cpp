@@ -39,6 +39,7 @@
 #include "mongo/db/repl/topology_coordinator.h"
 #include "mongo/db/repl/topology_coordinator_impl.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/logger/logger.h"
 #include "mongo/rpc/metadata/repl_set_metadata.h"
 #include "mongo/unittest/unittest.h"
@@ -191,7 +192,8 @@ protected:
                                                 const std::string& setName,
                                                 MemberState memberState,
                                                 const OpTime& lastOpTimeSender,
-                                                Milliseconds roundTripTime = Milliseconds(1)) {
+                                                Milliseconds roundTripTime = Milliseconds(1),
+                                                const HostAndPort& syncingTo = HostAndPort()) {
         return _receiveHeartbeatHelper(Status::OK(),
                                        member,
                                        setName,
@@ -199,7 +201,8 @@ protected:
                                        Timestamp(),
                                        lastOpTimeSender,
                                        OpTime(),
-                                       roundTripTime);
+                                       roundTripTime,
+                                       syncingTo);
     }
 
 private:
@@ -210,13 +213,17 @@ private:
                                                     Timestamp electionTime,
                                                     const OpTime& lastOpTimeSender,
                                                     const OpTime& lastOpTimeReceiver,
-                                                    Milliseconds roundTripTime) {
+                                                    Milliseconds roundTripTime,
+                                                    const HostAndPort& syncingTo = HostAndPort()) {
         ReplSetHeartbeatResponse hb;
         hb.setConfigVersion(1);
         hb.setState(memberState);
         hb.setDurableOpTime(lastOpTimeSender);
         hb.setAppliedOpTime(lastOpTimeSender);
         hb.setElectionTime(electionTime);
+        if (!syncingTo.empty()) {
+            hb.setSyncingTo(syncingTo);
+        }
 
         StatusWith<ReplSetHeartbeatResponse> hbResponse = responseStatus.isOK()
             ? StatusWith<ReplSetHeartbeatResponse>(hb)
@@ -490,6 +497,323 @@ TEST_F(TopoCoordTest, NodeReturnsClosestValidSyncSourceAsSyncSource) {
 }
 
 
+TEST_F(TopoCoordTest, ChooseLessLoadedSyncSourceOverSlightlyCloserOne) {
+    updateConfig(BSON("_id"
+                      << "rs0"
+                      << "version"
+                      << 1
+                      << "members"
+                      << BSON_ARRAY(BSON("_id" << 10 << "host"
+                                               << "hself")
+                                    << BSON("_id" << 20 << "host"
+                                                  << "h1")
+                                    << BSON("_id" << 30 << "host"
+                                                  << "h2")
+                                    << BSON("_id" << 40 << "host"
+                                                  << "h3")
+                                    << BSON("_id" << 50 << "host"
+                                                  << "h4")
+                                    << BSON("_id" << 60 << "host"
+                                                  << "h5"))),
+                 0);
+    setSelfMemberState(MemberState::RS_SECONDARY);
+    Timestamp lastOpTimeWeApplied = Timestamp(1, 0);
+
+    // h1 is closest, but h3, h4 and h5 already sync from it. Those three are not ahead of us, so
+    // they are not candidates themselves.
+    for (int round = 0; round < 2; ++round) {
+        heartbeatFromMember(HostAndPort("h1"),
+                            "rs0",
+                            MemberState::RS_SECONDARY,
+                            OpTime(Timestamp(2, 0), 0),
+                            Milliseconds(5));
+        heartbeatFromMember(HostAndPort("h2"),
+                            "rs0",
+                            MemberState::RS_SECONDARY,
+                            OpTime(Timestamp(2, 0), 0),
+                            Milliseconds(10));
+        for (auto&& member : {"h3", "h4", "h5"}) {
+            heartbeatFromMember(HostAndPort(member),
+                                "rs0",
+                                MemberState::RS_SECONDARY,
+                                OpTime(Timestamp(1, 0), 0),
+                                Milliseconds(1),
+                                HostAndPort("h1"));
+        }
+    }
+
+    getTopoCoord().chooseNewSyncSource(
+        now()++, lastOpTimeWeApplied, TopologyCoordinator::ChainingPreference::kUseConfiguration);
+    ASSERT_EQUALS(HostAndPort("h2"), getTopoCoord().getSyncSourceAddress());
+
+    // Once most of the load moves to h2, h1 is preferred again.
+    for (auto&& member : {"h4", "h5"}) {
+        heartbeatFromMember(HostAndPort(member),
+                            "rs0",
+                            MemberState::RS_SECONDARY,
+                            OpTime(Timestamp(1, 0), 0),
+                            Milliseconds(1),
+                            HostAndPort("h2"));
+    }
+    getTopoCoord().chooseNewSyncSource(
+        now()++, lastOpTimeWeApplied, TopologyCoordinator::ChainingPreference::kUseConfiguration);
+    ASSERT_EQUALS(HostAndPort("h1"), getTopoCoord().getSyncSourceAddress());
+}
+
+TEST_F(TopoCoordTest, ChangeSyncSourceOnlyOnceABetterSyncSourceIsSustained) {
+    auto param = ServerParameterSet::getGlobal()->getMap().find("enableSyncSourceSwitching");
+    ASSERT(param != ServerParameterSet::getGlobal()->getMap().end());
+    ASSERT_OK(param->second->setFromString("true"));
+    ON_BLOCK_EXIT([&] { ASSERT_OK(param->second->setFromString("false")); });
+
+    updateConfig(BSON("_id"
+                      << "rs0"
+                      << "version"
+                      << 1
+                      << "members"
+                      << BSON_ARRAY(BSON("_id" << 10 << "host"
+                                               << "hself")
+                                    << BSON("_id" << 20 << "host"
+                                                  << "h1")
+                                    << BSON("_id" << 30 << "host"
+                                                  << "h2")
+                                    << BSON("_id" << 40 << "host"
+                                                  << "h3")
+                                    << BSON("_id" << 50 << "host"
+                                                  << "h4")
+                                    << BSON("_id" << 60 << "host"
+                                                  << "h5"))),
+                 0);
+    setSelfMemberState(MemberState::RS_SECONDARY);
+    Timestamp lastOpTimeWeApplied = Timestamp(1, 0);
+
+    auto heartbeatFromDownstreamMembers = [&](const HostAndPort& syncingTo) {
+        for (auto&& member : {"h3", "h4", "h5"}) {
+            heartbeatFromMember(HostAndPort(member),
+                                "rs0",
+                                MemberState::RS_SECONDARY,
+                                OpTime(Timestamp(1, 0), 0),
+                                Milliseconds(1),
+                                syncingTo);
+        }
+    };
+    for (int round = 0; round < 2; ++round) {
+        heartbeatFromMember(HostAndPort("h1"),
+                            "rs0",
+                            MemberState::RS_SECONDARY,
+                            OpTime(Timestamp(2, 0), 0),
+                            Milliseconds(5));
+        heartbeatFromMember(HostAndPort("h2"),
+                            "rs0",
+                            MemberState::RS_SECONDARY,
+                            OpTime(Timestamp(2, 0), 0),
+                            Milliseconds(10));
+        heartbeatFromDownstreamMembers(HostAndPort());
+    }
+    getTopoCoord().chooseNewSyncSource(
+        now()++, lastOpTimeWeApplied, TopologyCoordinator::ChainingPreference::kUseConfiguration);
+    ASSERT_EQUALS(HostAndPort("h1"), getTopoCoord().getSyncSourceAddress());
+
+    // h1 becomes loaded, but only briefly.
+    heartbeatFromDownstreamMembers(HostAndPort("h1"));
+    ASSERT_FALSE(getTopoCoord().shouldChangeSyncSource(
+        HostAndPort("h1"), OpTime(), makeMetadata(), now()));
+    heartbeatFromDownstreamMembers(HostAndPort());
+    now() += Seconds(60);
+    ASSERT_FALSE(getTopoCoord().shouldChangeSyncSource(
+        HostAndPort("h1"), OpTime(), makeMetadata(), now()));
+
+    // h1 stays loaded for the whole switch window.
+    heartbeatFromDownstreamMembers(HostAndPort("h1"));
+    now() += Seconds(30);
+    ASSERT_FALSE(getTopoCoord().shouldChangeSyncSource(
+        HostAndPort("h1"), OpTime(), makeMetadata(), now()));
+    now() += Seconds(30);
+    startCapturingLogMessages();
+    ASSERT_TRUE(getTopoCoord().shouldChangeSyncSource(
+        HostAndPort("h1"), OpTime(), makeMetadata(), now()));
+    stopCapturingLogMessages();
+    ASSERT_EQUALS(1, countLogLinesContaining("re-evaluating sync source"));
+
+    getTopoCoord().chooseNewSyncSource(
+        now()++, lastOpTimeWeApplied, TopologyCoordinator::ChainingPreference::kUseConfiguration);
+    ASSERT_EQUALS(HostAndPort("h2"), getTopoCoord().getSyncSourceAddress());
+}
+
+TEST_F(TopoCoordTest, ChooseUpToDateSyncSourceOverSlightlyCloserLaggingOne) {
+    updateConfig(BSON("_id"
+                      << "rs0"
+                      << "version"
+                      << 1
+                      << "members"
+                      << BSON_ARRAY(BSON("_id" << 10 << "host"
+                                               << "hself")
+                                    << BSON("_id" << 20 << "host"
+                                                  << "h1")
+                                    << BSON("_id" << 30 << "host"
+                                                  << "h2"))),
+                 0);
+    setSelfMemberState(MemberState::RS_SECONDARY);
+    Timestamp lastOpTimeWeApplied = Timestamp(1, 0);
+
+    // h1 is closest, but its applied optime is 8 seconds behind h2's.
+    for (int round = 0; round < 2; ++round) {
+        heartbeatFromMember(HostAndPort("h1"),
+                            "rs0",
+                            MemberState::RS_SECONDARY,
+                            OpTime(Timestamp(2, 0), 0),
+                            Milliseconds(5));
+        heartbeatFromMember(HostAndPort("h2"),
+                            "rs0",
+                            MemberState::RS_SECONDARY,
+                            OpTime(Timestamp(10, 0), 0),
+                            Milliseconds(10));
+    }
+
+    getTopoCoord().chooseNewSyncSource(
+        now()++, lastOpTimeWeApplied, TopologyCoordinator::ChainingPreference::kUseConfiguration);
+    ASSERT_EQUALS(HostAndPort("h2"), getTopoCoord().getSyncSourceAddress());
+}
+
+TEST_F(TopoCoordTest, RestartSyncSourceSwitchWindowWhenADifferentMemberBecomesBetter) {
+    auto param = ServerParameterSet::getGlobal()->getMap().find("enableSyncSourceSwitching");
+    ASSERT(param != ServerParameterSet::getGlobal()->getMap().end());
+    ASSERT_OK(param->second->setFromString("true"));
+    ON_BLOCK_EXIT([&] { ASSERT_OK(param->second->setFromString("false")); });
+
+    updateConfig(BSON("_id"
+                      << "rs0"
+                      << "version"
+                      << 1
+                      << "members"
+                      << BSON_ARRAY(BSON("_id" << 10 << "host"
+                                               << "hself")
+                                    << BSON("_id" << 20 << "host"
+                                                  << "h1")
+                                    << BSON("_id" << 30 << "host"
+                                                  << "h2")
+                                    << BSON("_id" << 40 << "host"
+                                                  << "h3")
+                                    << BSON("_id" << 50 << "host"
+                                                  << "d1")
+                                    << BSON("_id" << 60 << "host"
+                                                  << "d2")
+                                    << BSON("_id" << 70 << "host"
+                                                  << "d3")
+                                    << BSON("_id" << 80 << "host"
+                                                  << "d4")
+                                    << BSON("_id" << 90 << "host"
+                                                  << "d5")
+                                    << BSON("_id" << 100 << "host"
+                                                  << "d6"))),
+                 0);
+    setSelfMemberState(MemberState::RS_SECONDARY);
+    Timestamp lastOpTimeWeApplied = Timestamp(1, 0);
+
+    auto heartbeatFromDownstreamMembers = [&](std::initializer_list<const char*> members,
+                                              const HostAndPort& syncingTo) {
+        for (auto&& member : members) {
+            heartbeatFromMember(HostAndPort(member),
+                                "rs0",
+                                MemberState::RS_SECONDARY,
+                                OpTime(Timestamp(1, 0), 0),
+                                Milliseconds(1),
+                                syncingTo);
+        }
+    };
+    for (int round = 0; round < 2; ++round) {
+        heartbeatFromMember(HostAndPort("h1"),
+                            "rs0",
+                            MemberState::RS_SECONDARY,
+                            OpTime(Timestamp(2, 0), 0),
+                            Milliseconds(5));
+        for (auto&& member : {"h2", "h3"}) {
+            heartbeatFromMember(HostAndPort(member),
+                                "rs0",
+                                MemberState::RS_SECONDARY,
+                                OpTime(Timestamp(2, 0), 0),
+                                Milliseconds(10));
+        }
+        heartbeatFromDownstreamMembers({"d1", "d2", "d3", "d4", "d5", "d6"}, HostAndPort());
+    }
+    getTopoCoord().chooseNewSyncSource(
+        now()++, lastOpTimeWeApplied, TopologyCoordinator::ChainingPreference::kUseConfiguration);
+    ASSERT_EQUALS(HostAndPort("h1"), getTopoCoord().getSyncSourceAddress());
+
+    // h1 becomes loaded, which makes h2 better.
+    heartbeatFromDownstreamMembers({"d1", "d2", "d3"}, HostAndPort("h1"));
+    now() += Seconds(30);
+
+    // Half way through the window h2 becomes loaded as well, and only h3 is better now.
+    heartbeatFromDownstreamMembers({"d4", "d5", "d6"}, HostAndPort("h2"));
+    now() += Seconds(30);
+    ASSERT_FALSE(getTopoCoord().shouldChangeSyncSource(
+        HostAndPort("h1"), OpTime(), makeMetadata(), now()));
+
+    // h3 has been better for the whole window.
+    now() += Seconds(30);
+    startCapturingLogMessages();
+    ASSERT_TRUE(getTopoCoord().shouldChangeSyncSource(
+        HostAndPort("h1"), OpTime(), makeMetadata(), now()));
+    stopCapturingLogMessages();
+    ASSERT_EQUALS(1, countLogLinesContaining("re-evaluating sync source because h3:27017"));
+
+    getTopoCoord().chooseNewSyncSource(
+        now()++, lastOpTimeWeApplied, TopologyCoordinator::ChainingPreference::kUseConfiguration);
+    ASSERT_EQUALS(HostAndPort("h3"), getTopoCoord().getSyncSourceAddress());
+}
+
+TEST_F(TopoCoordTest, DoNotChangeToBetterSyncSourceByDefault) {
+    updateConfig(BSON("_id"
+                      << "rs0"
+                      << "version"
+                      << 1
+                      << "members"
+                      << BSON_ARRAY(BSON("_id" << 10 << "host"
+                                               << "hself")
+                                    << BSON("_id" << 20 << "host"
+                                                  << "h1")
+                                    << BSON("_id" << 30 << "host"
+                                                  << "h2")
+                                    << BSON("_id" << 40 << "host"
+                                                  << "h3")
+                                    << BSON("_id" << 50 << "host"
+                                                  << "h4")
+                                    << BSON("_id" << 60 << "host"
+                                                  << "h5"))),
+                 0);
+    setSelfMemberState(MemberState::RS_SECONDARY);
+    Timestamp lastOpTimeWeApplied = Timestamp(1, 0);
+
+    for (int round = 0; round < 2; ++round) {
+        heartbeatFromMember(HostAndPort("h1"),
+                            "rs0",
+                            MemberState::RS_SECONDARY,
+                            OpTime(Timestamp(2, 0), 0),
+                            Milliseconds(5));
+        heartbeatFromMember(HostAndPort("h2"),
+                            "rs0",
+                            MemberState::RS_SECONDARY,
+                            OpTime(Timestamp(2, 0), 0),
+                            Milliseconds(10));
+    }
+    getTopoCoord().chooseNewSyncSource(
+        now()++, lastOpTimeWeApplied, TopologyCoordinator::ChainingPreference::kUseConfiguration);
+    ASSERT_EQUALS(HostAndPort("h1"), getTopoCoord().getSyncSourceAddress());
+
+    for (auto&& member : {"h3", "h4", "h5"}) {
+        heartbeatFromMember(HostAndPort(member),
+                            "rs0",
+                            MemberState::RS_SECONDARY,
+                            OpTime(Timestamp(1, 0), 0),
+                            Milliseconds(1),
+                            HostAndPort("h1"));
+    }
+    now() += Seconds(120);
+    ASSERT_FALSE(getTopoCoord().shouldChangeSyncSource(
+        HostAndPort("h1"), OpTime(), makeMetadata(), now()));
+}
+
 TEST_F(TopoCoordTest, ChooseOnlyPrimaryAsSyncSourceWhenChainingIsDisallowed) {
     updateConfig(BSON("_id"
                       << "rs0"
@@ -30,19 +30,30 @@
 
 #include "mongo/db/s/active_migrations_registry.h"
 
+#include <algorithm>
+
 #include "mongo/base/status_with.h"
 #include "mongo/db/db_raii.h"
+#include "mongo/db/range_arithmetic.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/migration_session_id.h"
 #include "mongo/db/s/migration_source_manager.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/assert_util.h"
 
 namespace mongo {
+namespace {
+
+// Number of chunks this shard may donate at the same time. Chunks of the same collection may be
+// donated concurrently as long as their ranges do not overlap.
+MONGO_EXPORT_SERVER_PARAMETER(maxConcurrentOutgoingMigrations, int, 1);
+
+}  // namespace
 
 ActiveMigrationsRegistry::ActiveMigrationsRegistry() = default;
 
 ActiveMigrationsRegistry::~ActiveMigrationsRegistry() {
-    invariant(!_activeMoveChunkState);
+    invariant(_activeMoveChunkStates.empty());
 }
 
 StatusWith<ScopedRegisterDonateChunk> ActiveMigrationsRegistry::registerDonateChunk(
@@ -52,17 +63,29 @@ StatusWith<ScopedRegisterDonateChunk> ActiveMigrationsRegistry::registerDonateCh
         return _activeReceiveChunkState->constructErrorStatus();
     }
 
-    if (_activeMoveChunkState) {
-        if (_activeMoveChunkState->args == args) {
-            return {ScopedRegisterDonateChunk(nullptr, false, _activeMoveChunkState->notification)};
+    for (const auto& activeMoveChunkState : _activeMoveChunkStates) {
+        if (activeMoveChunkState.args == args) {
+            return {ScopedRegisterDonateChunk(nullptr, false, activeMoveChunkState.notification)};
+        }
+
+        if (activeMoveChunkState.args.getNss() == args.getNss() &&
+            rangeOverlaps(activeMoveChunkState.args.getMinKey(),
+                          activeMoveChunkState.args.getMaxKey(),
+                          args.getMinKey(),
+                          args.getMaxKey())) {
+            return activeMoveChunkState.constructErrorStatus();
         }
+    }
 
-        return _activeMoveChunkState->constructErrorStatus();
+    if (!_activeMoveChunkStates.empty() &&
+        _activeMoveChunkStates.size() >=
+            static_cast<size_t>(std::max(maxConcurrentOutgoingMigrations.load(), 1))) {
+        return _activeMoveChunkStates.front().constructErrorStatus();
     }
 
-    _activeMoveChunkState.emplace(args);
+    _activeMoveChunkStates.emplace_back(args);
 
-    return {ScopedRegisterDonateChunk(this, true, _activeMoveChunkState->notification)};
+    return {ScopedRegisterDonateChunk(this, true, _activeMoveChunkStates.back().notification)};
 }
 
 StatusWith<ScopedRegisterReceiveChunk> ActiveMigrationsRegistry::registerReceiveChunk(
@@ -72,8 +95,8 @@ StatusWith<ScopedRegisterReceiveChunk> ActiveMigrationsRegistry::registerReceive
         return _activeReceiveChunkState->constructErrorStatus();
     }
 
-    if (_activeMoveChunkState) {
-        return _activeMoveChunkState->constructErrorStatus();
+    if (!_activeMoveChunkStates.empty()) {
+        return _activeMoveChunkStates.front().constructErrorStatus();
     }
 
     _activeReceiveChunkState.emplace(nss, chunkRange, fromShardId);
@@ -81,46 +104,68 @@ StatusWith<ScopedRegisterReceiveChunk> ActiveMigrationsRegistry::registerReceive
     return {ScopedRegisterReceiveChunk(this)};
 }
 
-boost::optional<NamespaceString> ActiveMigrationsRegistry::getActiveDonateChunkNss() {
+std::vector<NamespaceString> ActiveMigrationsRegistry::getActiveDonateChunkNss() {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
-    if (_activeMoveChunkState) {
-        return _activeMoveChunkState->args.getNss();
+
+    std::vector<NamespaceString> activeNss;
+    for (const auto& activeMoveChunkState : _activeMoveChunkStates) {
+        const NamespaceString& nss = activeMoveChunkState.args.getNss();
+        if (std::find(activeNss.begin(), activeNss.end(), nss) == activeNss.end()) {
+            activeNss.push_back(nss);
+        }
     }
 
-    return boost::none;
+    return activeNss;
 }
 
-BSONObj ActiveMigrationsRegistry::getActiveMigrationStatusReport(OperationContext* txn) {
-    boost::optional<NamespaceString> nss;
+std::vector<BSONObj> ActiveMigrationsRegistry::getActiveMigrationStatusReports(
+    OperationContext* txn) {
+    std::vector<std::pair<NamespaceString, ChunkRange>> activeMigrations;
     {
         stdx::lock_guard<stdx::mutex> lk(_mutex);
 
-        if (_activeMoveChunkState) {
-            nss = _activeMoveChunkState->args.getNss();
+        for (const auto& activeMoveChunkState : _activeMoveChunkStates) {
+            const auto& args = activeMoveChunkState.args;
+            activeMigrations.emplace_back(args.getNss(),
+                                          ChunkRange(args.getMinKey(), args.getMaxKey()));
         }
     }
 
-    // The state of the MigrationSourceManager could change between taking and releasing the mutex
-    // above and then taking the collection lock here, but that's fine because it isn't important to
-    // return information on a migration that just ended or started. This is just best effort and
+    // The state of the MigrationSourceManagers could change between taking and releasing the mutex
+    // above and then taking the collection locks here, but that's fine because it isn't important
+    // to return information on a migration that just ended or started. This is just best effort and
     // desireable for reporting, and then diagnosing, migrations that are stuck.
-    if (nss) {
+    std::vector<BSONObj> reports;
+    for (const auto& activeMigration : activeMigrations) {
         // Lock the collection so nothing changes while we're getting the migration report.
-        AutoGetCollection autoColl(txn, nss.get(), MODE_IS);
+        AutoGetCollection autoColl(txn, activeMigration.first, MODE_IS);
+
+        auto css = CollectionShardingState::get(txn, activeMigration.first);
+        if (!css) {
+            continue;
+        }
 
-        auto css = CollectionShardingState::get(txn, nss.get());
-        if (css && css->getMigrationSourceManager()) {
-            return css->getMigrationSourceManager()->getMigrationStatusReport();
+        for (const auto sourceMgr : css->getMigrationSourceManagers()) {
+            if (sourceMgr->getChunkRange() == activeMigration.second) {
+                reports.push_back(sourceMgr->getMigrationStatusReport());
+                break;
+            }
         }
     }
 
-    return BSONObj();
+    return reports;
 }
 
-void ActiveMigrationsRegistry::_clearDonateChunk() {
+void ActiveMigrationsRegistry::_clearDonateChunk(
+    const std::shared_ptr<Notification<Status>>& completionNotification) {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
-    invariant(_activeMoveChunkState);
-    _activeMoveChunkState.reset();
+    auto it = std::find_if(_activeMoveChunkStates.begin(),
+                           _activeMoveChunkStates.end(),
+                           [&completionNotification](const ActiveMoveChunkState& state) {
+                               return state.notification == completionNotification;
+                           });
+    invariant(it != _activeMoveChunkStates.end());
+    _activeMoveChunkStates.erase(it);
 }
 
 void ActiveMigrationsRegistry::_clearReceiveChunk() {
@@ -163,7 +208,7 @@ ScopedRegisterDonateChunk::~ScopedRegisterDonateChunk() {
     if (_registry && _forUnregister) {
         // If this is a newly started migration the caller must always signal on completion
         invariant(*_completionNotification);
-        _registry->_clearDonateChunk();
+        _registry->_clearDonateChunk(_completionNotification);
     }
 }
 
@@ -32,9 +32,11 @@
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/client.h"
 #include "mongo/db/s/active_migrations_registry.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context_noop.h"
 #include "mongo/s/move_chunk_request.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -64,7 +66,15 @@ protected:
     ActiveMigrationsRegistry _registry;
 };
 
-MoveChunkRequest createMoveChunkRequest(const NamespaceString& nss) {
+void setMaxConcurrentOutgoingMigrations(StringData value) {
+    auto param = ServerParameterSet::getGlobal()->getMap().find("maxConcurrentOutgoingMigrations");
+    ASSERT(param != ServerParameterSet::getGlobal()->getMap().end());
+    ASSERT_OK(param->second->setFromString(value.toString()));
+}
+
+MoveChunkRequest createMoveChunkRequest(const NamespaceString& nss,
+                                        const BSONObj& minKey = BSON("Key" << -100),
+                                        const BSONObj& maxKey = BSON("Key" << 1000)) {
     const ChunkVersion collectionVersion(2, 3, OID::gen());
     const ChunkVersion chunkVersion(1, 2, OID::gen());
 
@@ -76,7 +86,7 @@ MoveChunkRequest createMoveChunkRequest(const NamespaceString& nss) {
         assertGet(ConnectionString::parse("TestConfigRS/CS1:12345,CS2:12345,CS3:12345")),
         ShardId("shard0001"),
         ShardId("shard0002"),
-        ChunkRange(BSON("Key" << -100), BSON("Key" << 100)),
+        ChunkRange(minKey, maxKey),
         chunkVersion,
         1024,
         MigrationSecondaryThrottleOptions::create(MigrationSecondaryThrottleOptions::kOff),
@@ -102,14 +112,16 @@ TEST_F(MoveChunkRegistration, ScopedRegisterDonateChunkMoveConstructorAndAssignm
 }
 
 TEST_F(MoveChunkRegistration, GetActiveMigrationNamespace) {
-    ASSERT(!_registry.getActiveDonateChunkNss());
+    ASSERT(_registry.getActiveDonateChunkNss().empty());
 
     const NamespaceString nss("TestDB", "TestColl");
 
     auto originalScopedRegisterDonateChunk =
         assertGet(_registry.registerDonateChunk(createMoveChunkRequest(nss)));
 
-    ASSERT_EQ(nss.ns(), _registry.getActiveDonateChunkNss()->ns());
+    const auto activeNss = _registry.getActiveDonateChunkNss();
+    ASSERT_EQ(1U, activeNss.size());
+    ASSERT_EQ(nss.ns(), activeNss.front().ns());
 
     // Need to signal the registered migration so the destructor doesn't invariant
     originalScopedRegisterDonateChunk.complete(Status::OK());
@@ -141,5 +153,66 @@ TEST_F(MoveChunkRegistration, SecondMigrationWithSameArgumentsJoinsFirst) {
               secondScopedRegisterDonateChunk.waitForCompletion(getTxn()));
 }
 
+TEST_F(MoveChunkRegistration, ConcurrentMigrationsOfDisjointChunks) {
+    ON_BLOCK_EXIT([] { setMaxConcurrentOutgoingMigrations("1"); });
+    setMaxConcurrentOutgoingMigrations("3");
+
+    auto firstScopedRegisterDonateChunk = assertGet(_registry.registerDonateChunk(
+        createMoveChunkRequest(NamespaceString("TestDB", "TestColl1"))));
+    ASSERT(firstScopedRegisterDonateChunk.mustExecute());
+
+    // Chunks of the same collection, which overlap the one being donated, may not be donated
+    ASSERT_EQ(ErrorCodes::ConflictingOperationInProgress,
+              _registry
+                  .registerDonateChunk(createMoveChunkRequest(
+                      NamespaceString("TestDB", "TestColl1"), BSON("Key" << 100)))
+                  .getStatus());
+    const auto overlappingRequest = createMoveChunkRequest(
+        NamespaceString("TestDB", "TestColl1"), BSON("Key" << -1000), BSON("Key" << 0));
+    ASSERT_EQ(ErrorCodes::ConflictingOperationInProgress,
+              _registry.registerDonateChunk(overlappingRequest).getStatus());
+
+    // Disjoint chunks of the same collection may be donated concurrently
+    auto sameCollScopedRegisterDonateChunk = assertGet(
+        _registry.registerDonateChunk(createMoveChunkRequest(NamespaceString("TestDB", "TestColl1"),
+                                                             BSON("Key" << 1000),
+                                                             BSON("Key" << 2000))));
+    ASSERT(sameCollScopedRegisterDonateChunk.mustExecute());
+    ASSERT_EQ(1U, _registry.getActiveDonateChunkNss().size());
+
+    auto secondScopedRegisterDonateChunk = assertGet(_registry.registerDonateChunk(
+        createMoveChunkRequest(NamespaceString("TestDB", "TestColl2"))));
+    ASSERT(secondScopedRegisterDonateChunk.mustExecute());
+    ASSERT_EQ(2U, _registry.getActiveDonateChunkNss().size());
+
+    // The limit has been reached
+    ASSERT_EQ(ErrorCodes::ConflictingOperationInProgress,
+              _registry
+                  .registerDonateChunk(
+                      createMoveChunkRequest(NamespaceString("TestDB", "TestColl3")))
+                  .getStatus());
+
+    // A shard, which is donating chunks, cannot receive any
+    ASSERT_EQ(ErrorCodes::ConflictingOperationInProgress,
+              _registry
+                  .registerReceiveChunk(NamespaceString("TestDB", "TestColl4"),
+                                        ChunkRange(BSON("Key" << -100), BSON("Key" << 100)),
+                                        ShardId("shard0001"))
+                  .getStatus());
+
+    firstScopedRegisterDonateChunk.complete(Status::OK());
+    {
+        ScopedRegisterDonateChunk completed(std::move(firstScopedRegisterDonateChunk));
+    }
+
+    const auto activeNss = _registry.getActiveDonateChunkNss();
+    ASSERT_EQ(2U, activeNss.size());
+    ASSERT_EQ("TestDB.TestColl1", activeNss[0].ns());
+    ASSERT_EQ("TestDB.TestColl2", activeNss[1].ns());
+
+    sameCollScopedRegisterDonateChunk.complete(Status::OK());
+    secondScopedRegisterDonateChunk.complete(Status::OK());
+}
+
 }  // namespace
 }  // namespace mongo
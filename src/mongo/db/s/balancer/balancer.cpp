@@ -291,6 +291,44 @@ void Balancer::report(OperationContext* txn, BSONObjBuilder* builder) {
     builder->append("numBalancerRounds", _numBalancerRounds);
 }
 
+Status Balancer::explain(OperationContext* txn, BSONObjBuilder* builder) {
+    auto splitCandidatesStatus = _chunkSelectionPolicy->selectChunksToSplit(txn);
+    if (!splitCandidatesStatus.isOK()) {
+        return splitCandidatesStatus.getStatus();
+    }
+
+    auto migrateCandidatesStatus = _chunkSelectionPolicy->selectChunksToMove(txn, false, true);
+    if (!migrateCandidatesStatus.isOK()) {
+        return migrateCandidatesStatus.getStatus();
+    }
+
+    BSONArrayBuilder splitsArr(builder->subarrayStart("splits"));
+    for (const auto& splitInfo : splitCandidatesStatus.getValue()) {
+        BSONObjBuilder splitEntry(splitsArr.subobjStart());
+        splitEntry.append("ns", splitInfo.nss.ns());
+        splitEntry.append("shard", splitInfo.shardId.toString());
+        splitEntry.append("min", splitInfo.minKey);
+        splitEntry.append("max", splitInfo.maxKey);
+        splitEntry.append("splitKeys", splitInfo.splitKeys);
+        splitEntry.doneFast();
+    }
+    splitsArr.doneFast();
+
+    BSONArrayBuilder migrationsArr(builder->subarrayStart("migrations"));
+    for (const auto& migrateInfo : migrateCandidatesStatus.getValue()) {
+        BSONObjBuilder migrationEntry(migrationsArr.subobjStart());
+        migrationEntry.append("ns", migrateInfo.ns);
+        migrationEntry.append("from", migrateInfo.from.toString());
+        migrationEntry.append("to", migrateInfo.to.toString());
+        migrationEntry.append("min", migrateInfo.minKey);
+        migrationEntry.append("max", migrateInfo.maxKey);
+        migrationEntry.doneFast();
+    }
+    migrationsArr.doneFast();
+
+    return Status::OK();
+}
+
 void Balancer::_mainThread() {
     Client::initThread("Balancer");
     auto txn = cc().makeOperationContext();
@@ -384,7 +422,7 @@ void Balancer::_mainThread() {
                 }
 
                 const auto candidateChunks = uassertStatusOK(
-                    _chunkSelectionPolicy->selectChunksToMove(txn.get(), _balancedLastTime));
+                    _chunkSelectionPolicy->selectChunksToMove(txn.get(), _balancedLastTime, false));
 
                 if (candidateChunks.empty()) {
                     LOG(1) << "no need to move any chunk";
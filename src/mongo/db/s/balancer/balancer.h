@@ -140,6 +140,12 @@ public:
      */
     void report(OperationContext* txn, BSONObjBuilder* builder);
 
+    /**
+     * Appends the splits and migrations, which the balancer would schedule if it started a round
+     * right now, to the specified builder, without performing any of them.
+     */
+    Status explain(OperationContext* txn, BSONObjBuilder* builder);
+
 private:
     /**
      * Possible runtime states of the balancer. The comments indicate the allowed next state.
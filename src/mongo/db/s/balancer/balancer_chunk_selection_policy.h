@@ -93,9 +93,13 @@ public:
      * Potentially blocking method, which gives out a set of chunks to be moved. The
      * aggressiveBalanceHint indicates to the balancing logic that it should lower the threshold for
      * difference in number of chunks across shards and thus potentially cause more chunks to move.
+     *
+     * If dryRun is true, the chunks are only reported and the policy does not remember them as
+     * being moved.
      */
     virtual StatusWith<MigrateInfoVector> selectChunksToMove(OperationContext* txn,
-                                                             bool aggressiveBalanceHint) = 0;
+                                                             bool aggressiveBalanceHint,
+                                                             bool dryRun) = 0;
 
     /**
      * Requests a single chunk to be relocated to a different shard, if possible. If some error
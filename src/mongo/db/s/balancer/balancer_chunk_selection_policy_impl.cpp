@@ -32,17 +32,21 @@
 
 #include "mongo/db/s/balancer/balancer_chunk_selection_policy_impl.h"
 
+#include <algorithm>
+#include <map>
 #include <set>
 #include <vector>
 
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj_comparator_interface.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/catalog/catalog_cache.h"
 #include "mongo/s/catalog/sharding_catalog_client.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/catalog/type_collection.h"
 #include "mongo/s/catalog/type_tags.h"
 #include "mongo/s/grid.h"
+#include "mongo/s/shard_util.h"
 #include "mongo/s/sharding_raii.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
@@ -58,6 +62,66 @@ using std::vector;
 
 namespace {
 
+// Whether the balancer should even out the operations served by the shards in addition to their
+// number of chunks, based on the load sampled by the shards for every chunk
+MONGO_EXPORT_SERVER_PARAMETER(balancerLoadAware, bool, false);
+
+// A shard is considered overloaded once the operations it serves for a zone exceed the average
+// across the shards of the zone by more than this percentage
+MONGO_EXPORT_SERVER_PARAMETER(balancerLoadImbalanceThresholdPercent, int, 50);
+
+// Minimum number of sampled operations served by the chunks of a zone before they are balanced by
+// load rather than by number
+MONGO_EXPORT_SERVER_PARAMETER(balancerLoadMinOps, int, 1000);
+
+// Number of chunks of different collections, which the balancer moves off of the same shard in a
+// single round. Must not exceed the maxConcurrentOutgoingMigrations setting of the shards.
+MONGO_EXPORT_SERVER_PARAMETER(balancerMaxConcurrentMigrationsPerDonor, int, 1);
+
+/**
+ * Returns the settings for load-aware balancing or boost::none if it is disabled.
+ */
+boost::optional<LoadBalancingSettings> getLoadBalancingSettings() {
+    if (!balancerLoadAware.load()) {
+        return boost::none;
+    }
+
+    LoadBalancingSettings settings;
+    settings.minOps = balancerLoadMinOps.load();
+    settings.imbalanceThresholdPercent = balancerLoadImbalanceThresholdPercent.load();
+    return settings;
+}
+
+/**
+ * Drops the candidate migrations, which the shards would reject as conflicting with a migration
+ * selected earlier in the same round. A shard may donate chunks of up to
+ * balancerMaxConcurrentMigrationsPerDonor collections, or receive a single chunk, but not both.
+ */
+MigrateInfoVector selectNonConflictingMigrations(MigrateInfoVector candidateChunks) {
+    const int maxMigrationsPerDonor = std::max(balancerMaxConcurrentMigrationsPerDonor.load(), 1);
+
+    std::map<ShardId, int> numDonatedChunks;
+    std::set<ShardId> receivingShards;
+
+    MigrateInfoVector selectedChunks;
+
+    for (auto& migrateInfo : candidateChunks) {
+        if (receivingShards.count(migrateInfo.from) || receivingShards.count(migrateInfo.to) ||
+            numDonatedChunks.count(migrateInfo.to) ||
+            numDonatedChunks[migrateInfo.from] >= maxMigrationsPerDonor) {
+            LOG(2) << "Postponing migration " << redact(migrateInfo.toString())
+                   << ", because it conflicts with other migrations of the same round";
+            continue;
+        }
+
+        numDonatedChunks[migrateInfo.from]++;
+        receivingShards.insert(migrateInfo.to);
+        selectedChunks.push_back(std::move(migrateInfo));
+    }
+
+    return selectedChunks;
+}
+
 /**
  * Does a linear pass over the information cached in the specified chunk manager and extracts chunk
  * distrubution and chunk placement information which is needed by the balancer policy.
@@ -156,6 +220,13 @@ public:
         }
     }
 
+    /**
+     * Returns whether any split points have been added for the chunk starting at the specified key.
+     */
+    bool hasSplitPoints(const BSONObj& chunkMin) const {
+        return _chunkSplitPoints.count(chunkMin);
+    }
+
     /**
      * May be called only once for the lifetime of the buffer. Moves the contents of the buffer into
      * a vector of split infos to be passed to the split call.
@@ -187,6 +258,11 @@ BalancerChunkSelectionPolicyImpl::~BalancerChunkSelectionPolicyImpl() = default;
 
 StatusWith<SplitInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToSplit(
     OperationContext* txn) {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_splitRoundChunkLoadMutex);
+        _splitRoundChunkLoad.clear();
+    }
+
     auto shardStatsStatus = _clusterStats->getStats(txn);
     if (!shardStatsStatus.isOK()) {
         return shardStatsStatus.getStatus();
@@ -230,7 +306,7 @@ StatusWith<SplitInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToSpli
 }
 
 StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToMove(
-    OperationContext* txn, bool aggressiveBalanceHint) {
+    OperationContext* txn, bool aggressiveBalanceHint, bool dryRun) {
     auto shardStatsStatus = _clusterStats->getStats(txn);
     if (!shardStatsStatus.isOK()) {
         return shardStatsStatus.getStatus();
@@ -264,8 +340,8 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToMo
             continue;
         }
 
-        auto candidatesStatus =
-            _getMigrateCandidatesForCollection(txn, nss, shardStats, aggressiveBalanceHint);
+        auto candidatesStatus = _getMigrateCandidatesForCollection(
+            txn, nss, shardStats, aggressiveBalanceHint, dryRun);
         if (candidatesStatus == ErrorCodes::NamespaceNotFound) {
             // Namespace got dropped before we managed to get to it, so just skip it
             continue;
@@ -280,7 +356,7 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToMo
                                std::make_move_iterator(candidatesStatus.getValue().end()));
     }
 
-    return candidateChunks;
+    return selectNonConflictingMigrations(std::move(candidateChunks));
 }
 
 StatusWith<boost::optional<MigrateInfo>>
@@ -368,12 +444,12 @@ StatusWith<SplitInfoVector> BalancerChunkSelectionPolicyImpl::_getSplitCandidate
 
     const auto& shardKeyPattern = cm->getShardKeyPattern().getKeyPattern();
 
-    const auto collInfoStatus = createCollectionDistributionStatus(txn, shardStats, cm);
+    auto collInfoStatus = createCollectionDistributionStatus(txn, shardStats, cm);
     if (!collInfoStatus.isOK()) {
         return collInfoStatus.getStatus();
     }
 
-    const DistributionStatus& distribution = collInfoStatus.getValue();
+    DistributionStatus distribution = std::move(collInfoStatus.getValue());
 
     // Accumulate split points for the same chunk together
     SplitCandidatesBuffer splitCandidates(nss, cm->getVersion());
@@ -404,6 +480,41 @@ StatusWith<SplitInfoVector> BalancerChunkSelectionPolicyImpl::_getSplitCandidate
         }
     }
 
+    // Chunks, which serve too much of the load of their shard to be moved, are split in halves so
+    // that the load can be spread. Chunks, which are already being split at zone boundaries, are
+    // left for the next round.
+    const auto loadSettings = getLoadBalancingSettings();
+    if (loadSettings) {
+        _addCollectionChunkLoad(txn, shardStats, false, &distribution);
+        _movedChunkLoad.addToDistribution(&distribution, Date_t::now());
+
+        for (const auto& hotChunk :
+             BalancerPolicy::selectHotChunksToSplit(shardStats, distribution, *loadSettings)) {
+            if (splitCandidates.hasSplitPoints(hotChunk.getMin()))
+                continue;
+
+            auto medianKeyStatus = shardutil::selectMedianKey(txn,
+                                                              hotChunk.getShard(),
+                                                              nss,
+                                                              cm->getShardKeyPattern(),
+                                                              hotChunk.getMin(),
+                                                              hotChunk.getMax());
+            if (!medianKeyStatus.isOK()) {
+                LOG(1) << "Unable to find split point for hot chunk " << redact(hotChunk.toString())
+                       << causedBy(medianKeyStatus.getStatus());
+                continue;
+            }
+
+            // A chunk, which contains a single shard key value, cannot be split
+            const BSONObj& medianKey = medianKeyStatus.getValue();
+            if (medianKey.isEmpty())
+                continue;
+
+            splitCandidates.addSplitPoint(
+                cm->findIntersectingChunkWithSimpleCollation(txn, hotChunk.getMin()), medianKey);
+        }
+    }
+
     return splitCandidates.done();
 }
 
@@ -411,7 +522,8 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::_getMigrateCandi
     OperationContext* txn,
     const NamespaceString& nss,
     const ShardStatisticsVector& shardStats,
-    bool aggressiveBalanceHint) {
+    bool aggressiveBalanceHint,
+    bool dryRun) {
     auto scopedCMStatus = ScopedChunkManager::getExisting(txn, nss);
     if (!scopedCMStatus.isOK()) {
         return scopedCMStatus.getStatus();
@@ -422,12 +534,12 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::_getMigrateCandi
 
     const auto& shardKeyPattern = cm->getShardKeyPattern().getKeyPattern();
 
-    const auto collInfoStatus = createCollectionDistributionStatus(txn, shardStats, cm);
+    auto collInfoStatus = createCollectionDistributionStatus(txn, shardStats, cm);
     if (!collInfoStatus.isOK()) {
         return collInfoStatus.getStatus();
     }
 
-    const DistributionStatus& distribution = collInfoStatus.getValue();
+    DistributionStatus distribution = std::move(collInfoStatus.getValue());
 
     for (const auto& tagRangeEntry : distribution.tagRanges()) {
         const auto& tagRange = tagRangeEntry.second;
@@ -470,7 +582,64 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::_getMigrateCandi
         }
     }
 
-    return BalancerPolicy::balance(shardStats, distribution, aggressiveBalanceHint);
+    const auto loadSettings = getLoadBalancingSettings();
+    if (!loadSettings) {
+        return BalancerPolicy::balance(shardStats, distribution, aggressiveBalanceHint);
+    }
+
+    _addCollectionChunkLoad(txn, shardStats, true, &distribution);
+    _movedChunkLoad.addToDistribution(&distribution, Date_t::now());
+
+    auto migrations =
+        BalancerPolicy::balance(shardStats, distribution, aggressiveBalanceHint, loadSettings);
+    if (!dryRun) {
+        _movedChunkLoad.recordMigrations(distribution, migrations, Date_t::now());
+    }
+
+    return migrations;
+}
+
+void BalancerChunkSelectionPolicyImpl::_addCollectionChunkLoad(
+    OperationContext* txn,
+    const ShardStatisticsVector& shardStats,
+    bool useSplitRoundLoad,
+    DistributionStatus* distribution) {
+    const std::string& ns = distribution->nss().ns();
+
+    if (useSplitRoundLoad) {
+        stdx::lock_guard<stdx::mutex> lk(_splitRoundChunkLoadMutex);
+
+        auto it = _splitRoundChunkLoad.find(ns);
+        if (it != _splitRoundChunkLoad.end()) {
+            for (const auto& chunkLoad : it->second) {
+                distribution->addChunkLoad(chunkLoad);
+            }
+
+            _splitRoundChunkLoad.erase(it);
+            return;
+        }
+    }
+
+    std::set<ShardId> shardIds;
+    for (const auto& stat : shardStats) {
+        shardIds.insert(stat.shardId);
+    }
+
+    auto chunkLoadStatus = _clusterStats->getChunkLoad(txn, distribution->nss(), shardIds);
+    if (!chunkLoadStatus.isOK()) {
+        warning() << "Unable to retrieve the chunk load for collection " << distribution->nss()
+                  << causedBy(chunkLoadStatus.getStatus());
+        return;
+    }
+
+    for (const auto& chunkLoad : chunkLoadStatus.getValue()) {
+        distribution->addChunkLoad(chunkLoad);
+    }
+
+    if (!useSplitRoundLoad) {
+        stdx::lock_guard<stdx::mutex> lk(_splitRoundChunkLoadMutex);
+        _splitRoundChunkLoad[ns] = std::move(chunkLoadStatus.getValue());
+    }
 }
 
 }  // namespace mongo
@@ -28,7 +28,13 @@
 
 #pragma once
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include "mongo/db/s/balancer/balancer_chunk_selection_policy.h"
+#include "mongo/db/s/balancer/cluster_statistics.h"
+#include "mongo/stdx/mutex.h"
 
 namespace mongo {
 
@@ -42,7 +48,8 @@ public:
     StatusWith<SplitInfoVector> selectChunksToSplit(OperationContext* txn) override;
 
     StatusWith<MigrateInfoVector> selectChunksToMove(OperationContext* txn,
-                                                     bool aggressiveBalanceHint) override;
+                                                     bool aggressiveBalanceHint,
+                                                     bool dryRun) override;
 
     StatusWith<boost::optional<MigrateInfo>> selectSpecificChunkToMove(
         OperationContext* txn, const ChunkType& chunk) override;
@@ -67,11 +74,34 @@ private:
         OperationContext* txn,
         const NamespaceString& nss,
         const ShardStatisticsVector& shardStats,
-        bool aggressiveBalanceHint);
+        bool aggressiveBalanceHint,
+        bool dryRun);
+
+    /**
+     * Retrieves the sampled load of the chunks of the collection from all shards and records it in
+     * the distribution. Takes the load retrieved by selectChunksToSplit in the same balancer round
+     * if 'useSplitRoundLoad' is true and otherwise asks the shards. Failure to retrieve it is not
+     * fatal, because the collection can still be balanced by number of chunks.
+     */
+    void _addCollectionChunkLoad(OperationContext* txn,
+                                 const ShardStatisticsVector& shardStats,
+                                 bool useSplitRoundLoad,
+                                 DistributionStatus* distribution);
 
     // Source for obtaining cluster statistics. Not owned and must not be destroyed before the
     // policy object is destroyed.
     ClusterStatistics* const _clusterStats;
+
+    // Load of the chunks selected for migration, which is carried over to their recipients until
+    // those have sampled it themselves
+    MovedChunkLoadCache _movedChunkLoad;
+
+    // Protects _splitRoundChunkLoad
+    stdx::mutex _splitRoundChunkLoadMutex;
+
+    // Load of the chunks of each collection retrieved by the last selectChunksToSplit, so that the
+    // selectChunksToMove of the same balancer round does not ask the shards for it again
+    std::map<std::string, std::vector<ClusterStatistics::ChunkLoadStatistics>> _splitRoundChunkLoad;
 };
 
 }  // namespace mongo
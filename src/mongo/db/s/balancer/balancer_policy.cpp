@@ -32,6 +32,8 @@
 
 #include "mongo/db/s/balancer/balancer_policy.h"
 
+#include <algorithm>
+
 #include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/s/catalog/type_shard.h"
 #include "mongo/s/catalog/type_tags.h"
@@ -53,12 +55,48 @@ namespace {
 const size_t kDefaultImbalanceThreshold = 2;
 const size_t kAggressiveImbalanceThreshold = 1;
 
+// How long the load of a moved chunk is carried over to its recipient. The shards halve their
+// sampled counts every 10 minutes, so by then the recipient's own samples describe the chunk.
+const Minutes kMovedChunkLoadRetention(20);
+
+/**
+ * Returns the number of shards, which can own chunks for the specified zone.
+ */
+size_t numberOfShardsWithTag(const ShardStatisticsVector& shardStats, const string& tag) {
+    size_t total = 0;
+
+    for (const auto& stat : shardStats) {
+        if (tag.empty() || stat.shardTags.count(tag)) {
+            total++;
+        }
+    }
+
+    return total;
+}
+
+/**
+ * Returns the sampled number of operations served by all chunks of the specified zone.
+ */
+long long totalLoadWithTag(const ShardStatisticsVector& shardStats,
+                           const DistributionStatus& distribution,
+                           const string& tag) {
+    long long total = 0;
+
+    for (const auto& stat : shardStats) {
+        total += distribution.shardLoadWithTag(stat.shardId, tag);
+    }
+
+    return total;
+}
+
 }  // namespace
 
 DistributionStatus::DistributionStatus(NamespaceString nss, ShardToChunksMap shardToChunksMap)
     : _nss(std::move(nss)),
       _shardChunks(std::move(shardToChunksMap)),
-      _zoneRanges(SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<ZoneRange>()) {}
+      _zoneRanges(SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<ZoneRange>()),
+      _chunkLoad(SimpleBSONObjComparator::kInstance
+                     .makeBSONObjIndexedMap<ClusterStatistics::ChunkLoadStatistics>()) {}
 
 size_t DistributionStatus::totalChunks() const {
     size_t total = 0;
@@ -100,6 +138,60 @@ size_t DistributionStatus::numberOfChunksInShardWithTag(const ShardId& shardId,
     return total;
 }
 
+void DistributionStatus::addChunkLoad(const ClusterStatistics::ChunkLoadStatistics& chunkLoad) {
+    auto ownedChunkLoad = chunkLoad;
+    ownedChunkLoad.minKey = chunkLoad.minKey.getOwned();
+    ownedChunkLoad.maxKey = chunkLoad.maxKey.getOwned();
+
+    _chunkLoad.erase(ownedChunkLoad.minKey);
+    _chunkLoad.emplace(ownedChunkLoad.minKey, std::move(ownedChunkLoad));
+}
+
+long long DistributionStatus::getChunkLoad(const ChunkType& chunk) const {
+    const auto chunkLoad = getChunkLoadStatistics(chunk);
+    return chunkLoad ? chunkLoad->load() : 0;
+}
+
+const ClusterStatistics::ChunkLoadStatistics* DistributionStatus::getChunkLoadStatistics(
+    const ChunkType& chunk) const {
+    const auto it = _chunkLoad.find(chunk.getMin());
+    if (it == _chunkLoad.end()) {
+        return nullptr;
+    }
+
+    // The load of a chunk, which has since been split or merged, does not describe this chunk
+    const auto& chunkLoad = it->second;
+    if (SimpleBSONObjComparator::kInstance.evaluate(chunkLoad.maxKey != chunk.getMax())) {
+        return nullptr;
+    }
+
+    return &chunkLoad;
+}
+
+const ChunkType* DistributionStatus::findChunk(const BSONObj& minKey, const BSONObj& maxKey) const {
+    for (const auto& shardChunk : _shardChunks) {
+        for (const auto& chunk : shardChunk.second) {
+            if (!chunk.getMin().woCompare(minKey) && !chunk.getMax().woCompare(maxKey)) {
+                return &chunk;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+long long DistributionStatus::shardLoadWithTag(const ShardId& shardId, const string& tag) const {
+    long long total = 0;
+
+    for (const auto& chunk : getChunks(shardId)) {
+        if (tag == getTagForChunk(chunk)) {
+            total += getChunkLoad(chunk);
+        }
+    }
+
+    return total;
+}
+
 const vector<ChunkType>& DistributionStatus::getChunks(const ShardId& shardId) const {
     ShardToChunksMap::const_iterator i = _shardChunks.find(shardId);
     invariant(i != _shardChunks.end());
@@ -290,9 +382,11 @@ ShardId BalancerPolicy::_getMostOverloadedShard(const ShardStatisticsVector& sha
     return worst;
 }
 
-vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardStats,
-                                            const DistributionStatus& distribution,
-                                            bool shouldAggressivelyBalance) {
+vector<MigrateInfo> BalancerPolicy::balance(
+    const ShardStatisticsVector& shardStats,
+    const DistributionStatus& distribution,
+    bool shouldAggressivelyBalance,
+    const boost::optional<LoadBalancingSettings>& loadSettings) {
     vector<MigrateInfo> migrations;
 
     // Set of shards, which have already been used for migrations. Used so we don't return multiple
@@ -405,13 +499,7 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
         const size_t totalNumberOfChunksWithTag =
             (tag.empty() ? distribution.totalChunks() : distribution.totalChunksWithTag(tag));
 
-        size_t totalNumberOfShardsWithTag = 0;
-
-        for (const auto& stat : shardStats) {
-            if (tag.empty() || stat.shardTags.count(tag)) {
-                totalNumberOfShardsWithTag++;
-            }
-        }
+        const size_t totalNumberOfShardsWithTag = numberOfShardsWithTag(shardStats, tag);
 
         // Skip zones which have no shards assigned to them. This situation is not harmful, but
         // should not be possible so warn the operator to correct it.
@@ -425,6 +513,35 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
             continue;
         }
 
+        // Zones, whose chunks have served enough operations for their load to be meaningful, are
+        // balanced by load first
+        bool balancedByLoad = false;
+        if (loadSettings && distribution.hasChunkLoad()) {
+            const long long totalLoadForTag = totalLoadWithTag(shardStats, distribution, tag);
+            if (totalLoadForTag >= loadSettings->minOps) {
+                const long long idealLoadPerShardForTag =
+                    totalLoadForTag / static_cast<long long>(totalNumberOfShardsWithTag);
+                const long long loadImbalanceThreshold =
+                    idealLoadPerShardForTag * loadSettings->imbalanceThresholdPercent / 100;
+
+                while (_singleZoneLoadBalance(shardStats,
+                                              distribution,
+                                              tag,
+                                              idealLoadPerShardForTag,
+                                              loadImbalanceThreshold,
+                                              &migrations,
+                                              &usedShards))
+                    ;
+
+                balancedByLoad = true;
+            }
+        }
+
+        // The number of chunks of zones balanced by load is still kept within the normal threshold,
+        // so that the data sizes of the shards cannot drift apart without limit
+        const size_t chunkImbalanceThreshold =
+            (balancedByLoad ? kDefaultImbalanceThreshold : imbalanceThreshold);
+
         // Calculate the ceiling of the optimal number of chunks per shard
         const size_t idealNumberOfChunksPerShardForTag =
             (totalNumberOfChunksWithTag / totalNumberOfShardsWithTag) +
@@ -434,7 +551,7 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
                                   distribution,
                                   tag,
                                   idealNumberOfChunksPerShardForTag,
-                                  imbalanceThreshold,
+                                  chunkImbalanceThreshold,
                                   &migrations,
                                   &usedShards))
             ;
@@ -458,6 +575,67 @@ boost::optional<MigrateInfo> BalancerPolicy::balanceSingleChunk(
     return MigrateInfo(newShardId, chunk);
 }
 
+vector<ChunkType> BalancerPolicy::selectHotChunksToSplit(
+    const ShardStatisticsVector& shardStats,
+    const DistributionStatus& distribution,
+    const LoadBalancingSettings& loadSettings) {
+    vector<ChunkType> hotChunks;
+
+    if (!distribution.hasChunkLoad()) {
+        return hotChunks;
+    }
+
+    vector<string> tagsPlusEmpty(distribution.tags().begin(), distribution.tags().end());
+    tagsPlusEmpty.push_back("");
+
+    for (const auto& tag : tagsPlusEmpty) {
+        const size_t totalNumberOfShardsWithTag = numberOfShardsWithTag(shardStats, tag);
+        if (totalNumberOfShardsWithTag == 0) {
+            continue;
+        }
+
+        const long long totalLoadForTag = totalLoadWithTag(shardStats, distribution, tag);
+        if (totalLoadForTag < loadSettings.minOps) {
+            continue;
+        }
+
+        const long long idealLoadPerShardForTag =
+            totalLoadForTag / static_cast<long long>(totalNumberOfShardsWithTag);
+        const long long loadImbalanceThreshold =
+            idealLoadPerShardForTag * loadSettings.imbalanceThresholdPercent / 100;
+
+        for (const auto& stat : shardStats) {
+            const long long shardLoad = distribution.shardLoadWithTag(stat.shardId, tag);
+            const long long excessLoad = shardLoad - idealLoadPerShardForTag;
+            if (excessLoad <= loadImbalanceThreshold)
+                continue;
+
+            const ChunkType* hottestChunk = nullptr;
+            long long hottestChunkLoad = 0;
+
+            for (const auto& chunk : distribution.getChunks(stat.shardId)) {
+                if (chunk.getJumbo() || distribution.getTagForChunk(chunk) != tag)
+                    continue;
+
+                const long long chunkLoad = distribution.getChunkLoad(chunk);
+                if (chunkLoad <= hottestChunkLoad)
+                    continue;
+
+                hottestChunk = &chunk;
+                hottestChunkLoad = chunkLoad;
+            }
+
+            // Moving a chunk, which serves more than the excess load of its shard, would only
+            // overload the receiving shard instead
+            if (hottestChunk && hottestChunkLoad > excessLoad) {
+                hotChunks.push_back(*hottestChunk);
+            }
+        }
+    }
+
+    return hotChunks;
+}
+
 bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
                                         const DistributionStatus& distribution,
                                         const string& tag,
@@ -530,6 +708,182 @@ bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
     return false;
 }
 
+bool BalancerPolicy::_singleZoneLoadBalance(const ShardStatisticsVector& shardStats,
+                                            const DistributionStatus& distribution,
+                                            const string& tag,
+                                            long long idealLoadPerShardForTag,
+                                            long long loadImbalanceThreshold,
+                                            vector<MigrateInfo>* migrations,
+                                            set<ShardId>* usedShards) {
+    ShardId from;
+    long long maxLoad = 0;
+
+    ShardId to;
+    long long minLoad = numeric_limits<long long>::max();
+
+    for (const auto& stat : shardStats) {
+        if (usedShards->count(stat.shardId))
+            continue;
+
+        const long long shardLoad = distribution.shardLoadWithTag(stat.shardId, tag);
+
+        if (shardLoad > maxLoad) {
+            from = stat.shardId;
+            maxLoad = shardLoad;
+        }
+
+        if (shardLoad < minLoad && isShardSuitableReceiver(stat, tag).isOK()) {
+            to = stat.shardId;
+            minLoad = shardLoad;
+        }
+    }
+
+    if (!from.isValid() || !to.isValid() || from == to)
+        return false;
+
+    LOG(1) << "collection : " << distribution.nss().ns();
+    LOG(1) << "zone       : " << tag;
+    LOG(1) << "donor      : " << from << " load " << maxLoad;
+    LOG(1) << "receiver   : " << to << " load " << minLoad;
+    LOG(1) << "ideal      : " << idealLoadPerShardForTag;
+    LOG(1) << "threshold  : " << loadImbalanceThreshold;
+
+    // Check whether it is necessary to balance within this zone
+    if (maxLoad - idealLoadPerShardForTag <= loadImbalanceThreshold)
+        return false;
+
+    // The moved chunk must neither leave the donor below the ideal load, nor the receiver above it
+    const long long maxChunkLoad =
+        std::min(maxLoad - idealLoadPerShardForTag, idealLoadPerShardForTag - minLoad);
+    if (maxChunkLoad <= 0)
+        return false;
+
+    const ChunkType* chunkToMove = nullptr;
+    long long chunkToMoveLoad = 0;
+
+    for (const auto& chunk : distribution.getChunks(from)) {
+        if (chunk.getJumbo() || distribution.getTagForChunk(chunk) != tag)
+            continue;
+
+        const long long chunkLoad = distribution.getChunkLoad(chunk);
+        if (chunkLoad <= chunkToMoveLoad || chunkLoad > maxChunkLoad)
+            continue;
+
+        chunkToMove = &chunk;
+        chunkToMoveLoad = chunkLoad;
+    }
+
+    if (!chunkToMove) {
+        LOG(1) << "Shard: " << from << ", collection: " << distribution.nss().ns()
+               << " has no chunk for zone \'" << tag
+               << "\', which can be moved without overloading the receiver";
+        return false;
+    }
+
+    migrations->emplace_back(to, *chunkToMove);
+    invariant(usedShards->insert(from).second);
+    invariant(usedShards->insert(to).second);
+    return true;
+}
+
+void MovedChunkLoadCache::recordMigrations(const DistributionStatus& distribution,
+                                           const vector<MigrateInfo>& migrations,
+                                           Date_t now) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    // Collections, which are no longer balanced, would otherwise keep their entries forever
+    for (auto it = _movedChunksByNs.begin(); it != _movedChunksByNs.end();) {
+        auto& movedChunks = it->second;
+        movedChunks.erase(std::remove_if(movedChunks.begin(),
+                                         movedChunks.end(),
+                                         [&](const MovedChunk& movedChunk) {
+                                             return now - movedChunk.movedAt >=
+                                                 kMovedChunkLoadRetention;
+                                         }),
+                          movedChunks.end());
+        if (movedChunks.empty()) {
+            it = _movedChunksByNs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (const auto& migrateInfo : migrations) {
+        const ChunkType* chunk = distribution.findChunk(migrateInfo.minKey, migrateInfo.maxKey);
+        if (!chunk) {
+            continue;
+        }
+
+        // Use the chunk's load as recorded, so that the remembered load includes load carried over
+        // from an earlier migration of the same chunk
+        const auto chunkLoad = distribution.getChunkLoadStatistics(*chunk);
+        if (!chunkLoad || chunkLoad->load() <= 0) {
+            continue;
+        }
+
+        auto& movedChunks = _movedChunksByNs[migrateInfo.ns];
+        movedChunks.erase(std::remove_if(movedChunks.begin(),
+                                         movedChunks.end(),
+                                         [&](const MovedChunk& movedChunk) {
+                                             return !movedChunk.minKey.woCompare(
+                                                 migrateInfo.minKey);
+                                         }),
+                          movedChunks.end());
+        movedChunks.push_back(MovedChunk{migrateInfo.to,
+                                         migrateInfo.minKey.getOwned(),
+                                         migrateInfo.maxKey.getOwned(),
+                                         chunkLoad->reads,
+                                         chunkLoad->writes,
+                                         now});
+    }
+}
+
+void MovedChunkLoadCache::addToDistribution(DistributionStatus* distribution, Date_t now) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    auto it = _movedChunksByNs.find(distribution->nss().ns());
+    if (it == _movedChunksByNs.end()) {
+        return;
+    }
+
+    auto& movedChunks = it->second;
+    for (auto movedIt = movedChunks.begin(); movedIt != movedChunks.end();) {
+        const MovedChunk& movedChunk = *movedIt;
+        if (now - movedChunk.movedAt >= kMovedChunkLoadRetention) {
+            movedIt = movedChunks.erase(movedIt);
+            continue;
+        }
+
+        const ChunkType* chunk = distribution->findChunk(movedChunk.minKey, movedChunk.maxKey);
+        if (!chunk) {
+            movedIt = movedChunks.erase(movedIt);
+            continue;
+        }
+
+        // The migration has not happened (yet), so the donor still reports the chunk's load
+        if (chunk->getShard() != movedChunk.to) {
+            ++movedIt;
+            continue;
+        }
+
+        if (distribution->getChunkLoad(*chunk) >= movedChunk.reads + movedChunk.writes) {
+            movedIt = movedChunks.erase(movedIt);
+            continue;
+        }
+
+        distribution->addChunkLoad(ClusterStatistics::ChunkLoadStatistics(movedChunk.to,
+                                                                          movedChunk.minKey,
+                                                                          movedChunk.maxKey,
+                                                                          movedChunk.reads,
+                                                                          movedChunk.writes));
+        ++movedIt;
+    }
+
+    if (movedChunks.empty()) {
+        _movedChunksByNs.erase(it);
+    }
+}
+
 ZoneRange::ZoneRange(const BSONObj& a_min, const BSONObj& a_max, const std::string& _zone)
     : min(a_min.getOwned()), max(a_max.getOwned()), zone(_zone) {}
 
@@ -34,6 +34,8 @@
 #include "mongo/db/s/balancer/cluster_statistics.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/client/shard.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -62,6 +64,20 @@ struct MigrateInfo {
     ChunkVersion version;
 };
 
+/**
+ * Thresholds for balancing the chunks of a collection by the load they serve rather than by their
+ * number.
+ */
+struct LoadBalancingSettings {
+    // The chunks of a zone are balanced by load only once they have served at least this many
+    // sampled operations. Below that, they are balanced by number.
+    long long minOps{1000};
+
+    // A shard is considered overloaded once its load exceeds the average load of the shards in
+    // the zone by more than this percentage of the average.
+    int imbalanceThresholdPercent{50};
+};
+
 typedef std::vector<ClusterStatistics::ShardStatistics> ShardStatisticsVector;
 typedef std::map<ShardId, std::vector<ChunkType>> ShardToChunksMap;
 
@@ -111,6 +127,43 @@ public:
      */
     size_t numberOfChunksInShardWithTag(const ShardId& shardId, const std::string& tag) const;
 
+    /**
+     * Records the sampled load of a chunk. Load-aware balancing uses it to tell hot chunks from
+     * cold ones.
+     */
+    void addChunkLoad(const ClusterStatistics::ChunkLoadStatistics& chunkLoad);
+
+    /**
+     * Returns whether the load of any chunk has been recorded.
+     */
+    bool hasChunkLoad() const {
+        return !_chunkLoad.empty();
+    }
+
+    /**
+     * Returns the sampled number of operations served by the specified chunk or zero if its load
+     * is not known, for example because it was split since its load was recorded.
+     */
+    long long getChunkLoad(const ChunkType& chunk) const;
+
+    /**
+     * Same as getChunkLoad, but returns the recorded reads and writes of the chunk or nullptr if
+     * its load is not known.
+     */
+    const ClusterStatistics::ChunkLoadStatistics* getChunkLoadStatistics(
+        const ChunkType& chunk) const;
+
+    /**
+     * Returns the chunk with exactly the specified bounds or nullptr if there is no such chunk.
+     */
+    const ChunkType* findChunk(const BSONObj& minKey, const BSONObj& maxKey) const;
+
+    /**
+     * Returns the sampled number of operations served by the chunks in the specified shard, which
+     * have the given tag.
+     */
+    long long shardLoadWithTag(const ShardId& shardId, const std::string& tag) const;
+
     /**
      * Returns all chunks for the specified shard.
      */
@@ -154,6 +207,54 @@ private:
 
     // Set of all zones defined for this collection
     std::set<std::string> _allTags;
+
+    // Map of chunk min key to the bounds and the sampled load of the chunk
+    BSONObjIndexedMap<ClusterStatistics::ChunkLoadStatistics> _chunkLoad;
+};
+
+/**
+ * Remembers the load of the chunks, which the balancer decided to move. Shards only sample the load
+ * of the chunks they own, so once a chunk has moved, its load is missing from the distribution
+ * until the recipient has sampled it for a while. Without carrying the load over, the recipient
+ * would look cold and receive more hot chunks in the following rounds.
+ *
+ * Thread-safe.
+ */
+class MovedChunkLoadCache {
+    MONGO_DISALLOW_COPYING(MovedChunkLoadCache);
+
+public:
+    MovedChunkLoadCache() = default;
+
+    /**
+     * Remembers the current load of the chunks, which the specified migrations are going to move.
+     */
+    void recordMigrations(const DistributionStatus& distribution,
+                          const std::vector<MigrateInfo>& migrations,
+                          Date_t now);
+
+    /**
+     * Records the remembered load of the chunks, which now belong to the shard they were moved to
+     * and for which that shard reports less load. Forgets chunks, whose load the recipient has
+     * caught up with, which were split or merged since, or which moved too long ago.
+     */
+    void addToDistribution(DistributionStatus* distribution, Date_t now);
+
+private:
+    struct MovedChunk {
+        ShardId to;
+        BSONObj minKey;
+        BSONObj maxKey;
+        long long reads;
+        long long writes;
+        Date_t movedAt;
+    };
+
+    // Protects the fields below
+    stdx::mutex _mutex;
+
+    // Chunks, which were moved recently, by namespace
+    std::map<std::string, std::vector<MovedChunk>> _movedChunksByNs;
 };
 
 class BalancerPolicy {
@@ -179,10 +280,26 @@ public:
      *
      * The shouldAggressivelyBalance parameter causes the threshold for chunk could disparity
      * between shards to be lowered.
+     *
+     * If 'loadSettings' are specified and the distribution has chunk load information, zones whose
+     * chunks have served enough operations are first balanced by moving chunks off the shards
+     * which serve more than their share of the operations. Shards, which are not used by those
+     * migrations, are then balanced by number of chunks with the non-aggressive threshold.
      */
-    static std::vector<MigrateInfo> balance(const ShardStatisticsVector& shardStats,
-                                            const DistributionStatus& distribution,
-                                            bool shouldAggressivelyBalance);
+    static std::vector<MigrateInfo> balance(
+        const ShardStatisticsVector& shardStats,
+        const DistributionStatus& distribution,
+        bool shouldAggressivelyBalance,
+        const boost::optional<LoadBalancingSettings>& loadSettings = boost::none);
+
+    /**
+     * Returns the chunks, which serve so much of the load of an overloaded shard that moving any of
+     * them would just overload the receiving shard instead. Such chunks need to be split before
+     * their load can be spread.
+     */
+    static std::vector<ChunkType> selectHotChunksToSplit(const ShardStatisticsVector& shardStats,
+                                                         const DistributionStatus& distribution,
+                                                         const LoadBalancingSettings& loadSettings);
 
     /**
      * Using the specified distribution information, returns a suggested better location for the
@@ -230,6 +347,23 @@ private:
                                    size_t imbalanceThreshold,
                                    std::vector<MigrateInfo>* migrations,
                                    std::set<ShardId>* usedShards);
+
+    /**
+     * Same as _singleZoneBalance, but evens out the load served by the shards in the specified zone
+     * rather than their number of chunks. Moves the busiest chunk of the most loaded shard to the
+     * least loaded one, which does not leave the receiver busier than the average.
+     *
+     * The 'idealLoadPerShardForTag' is the average load of the shards in the zone and a shard is
+     * only relieved of chunks if its load exceeds the average by more than
+     * 'loadImbalanceThreshold'.
+     */
+    static bool _singleZoneLoadBalance(const ShardStatisticsVector& shardStats,
+                                       const DistributionStatus& distribution,
+                                       const std::string& tag,
+                                       long long idealLoadPerShardForTag,
+                                       long long loadImbalanceThreshold,
+                                       std::vector<MigrateInfo>* migrations,
+                                       std::set<ShardId>* usedShards);
 };
 
 }  // namespace mongo
@@ -30,6 +30,8 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
+
 #include "mongo/db/keypattern.h"
 #include "mongo/db/s/balancer/balancer_policy.h"
 #include "mongo/platform/random.h"
@@ -539,6 +541,236 @@ TEST(BalancerPolicy, BalancerHandlesNoShardsWithTag) {
     ASSERT(BalancerPolicy::balance(cluster.first, distribution, false).empty());
 }
 
+/**
+ * Records the specified sampled number of operations for each chunk of the shard, in order.
+ */
+void addShardChunkLoad(DistributionStatus* distribution,
+                       const ShardId& shardId,
+                       const vector<long long>& chunkLoad) {
+    const auto& chunks = distribution->getChunks(shardId);
+    ASSERT_EQ(chunks.size(), chunkLoad.size());
+
+    for (size_t i = 0; i < chunks.size(); i++) {
+        distribution->addChunkLoad(ClusterStatistics::ChunkLoadStatistics(
+            shardId, chunks[i].getMin(), chunks[i].getMax(), chunkLoad[i], 0));
+    }
+}
+
+TEST(BalancerPolicy, BalancerMovesLoadOffHotShard) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion), 4},
+         {ShardStatistics(kShardId1, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion), 4}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    addShardChunkLoad(&distribution, kShardId0, {100, 400, 300, 200});
+    addShardChunkLoad(&distribution, kShardId1, {50, 50, 0, 0});
+
+    // Balanced by number of chunks
+    ASSERT(BalancerPolicy::balance(cluster.first, distribution, false).empty());
+
+    // Unbalanced by load, so the busiest chunk, which does not overload the receiver, is moved
+    const auto migrations(
+        BalancerPolicy::balance(cluster.first, distribution, false, LoadBalancingSettings()));
+    ASSERT_EQ(1U, migrations.size());
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId1, migrations[0].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMin(), migrations[0].minKey);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMax(), migrations[0].maxKey);
+
+    ASSERT(BalancerPolicy::selectHotChunksToSplit(
+               cluster.first, distribution, LoadBalancingSettings())
+               .empty());
+}
+
+TEST(BalancerPolicy, BalancerSplitsHotChunkInsteadOfMovingIt) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 2, false, emptyTagSet, emptyShardVersion), 2},
+         {ShardStatistics(kShardId1, kNoMaxSize, 2, false, emptyTagSet, emptyShardVersion), 2}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    addShardChunkLoad(&distribution, kShardId0, {0, 2000});
+    addShardChunkLoad(&distribution, kShardId1, {50, 50});
+
+    const auto migrations(
+        BalancerPolicy::balance(cluster.first, distribution, false, LoadBalancingSettings()));
+    ASSERT(migrations.empty());
+
+    const auto hotChunks(BalancerPolicy::selectHotChunksToSplit(
+        cluster.first, distribution, LoadBalancingSettings()));
+    ASSERT_EQ(1U, hotChunks.size());
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMin(), hotChunks[0].getMin());
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMax(), hotChunks[0].getMax());
+}
+
+TEST(BalancerPolicy, BalancerIgnoresLoadBelowMinimumNumberOfOperations) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 5, false, emptyTagSet, emptyShardVersion), 5},
+         {ShardStatistics(kShardId1, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    addShardChunkLoad(&distribution, kShardId0, {1, 1, 1, 1, 100});
+
+    // Balanced by number of chunks, because the load is too small to be meaningful
+    const auto migrations(
+        BalancerPolicy::balance(cluster.first, distribution, false, LoadBalancingSettings()));
+    ASSERT_EQ(1U, migrations.size());
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId1, migrations[0].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][0].getMin(), migrations[0].minKey);
+}
+
+TEST(BalancerPolicy, BalancerStillBalancesChunkCountOfBusyZone) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 10, false, emptyTagSet, emptyShardVersion), 10},
+         {ShardStatistics(kShardId1, kNoMaxSize, 2, false, emptyTagSet, emptyShardVersion), 2}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    addShardChunkLoad(&distribution,
+                      kShardId0,
+                      {100, 100, 100, 100, 100, 100, 100, 100, 100, 100});
+    addShardChunkLoad(&distribution, kShardId1, {500, 500});
+
+    // Balanced by load, but the number of chunks is too far apart
+    const auto migrations(
+        BalancerPolicy::balance(cluster.first, distribution, false, LoadBalancingSettings()));
+    ASSERT_EQ(1U, migrations.size());
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId1, migrations[0].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][0].getMin(), migrations[0].minKey);
+}
+
+/**
+ * Moves the chunk of the specified migration to its recipient, like a completed migration would.
+ */
+void applyMigration(ShardToChunksMap* chunkMap, const MigrateInfo& migrateInfo) {
+    auto& donorChunks = (*chunkMap)[migrateInfo.from];
+    auto it = std::find_if(donorChunks.begin(), donorChunks.end(), [&](const ChunkType& chunk) {
+        return !chunk.getMin().woCompare(migrateInfo.minKey);
+    });
+    ASSERT(it != donorChunks.end());
+
+    ChunkType chunk = *it;
+    donorChunks.erase(it);
+    chunk.setShard(migrateInfo.to);
+    (*chunkMap)[migrateInfo.to].push_back(std::move(chunk));
+}
+
+TEST(BalancerPolicy, BalancerCarriesLoadOfMovedChunkToRecipient) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion), 4},
+         {ShardStatistics(kShardId1, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion), 0}});
+
+    MovedChunkLoadCache movedChunkLoad;
+    Date_t now = Date_t::fromMillisSinceEpoch(1000000);
+
+    // First round: the busiest chunk, which does not overload the receiver, is moved
+    vector<MigrateInfo> migrations;
+    {
+        DistributionStatus distribution(kNamespace, cluster.second);
+        addShardChunkLoad(&distribution, kShardId0, {100, 400, 300, 200});
+        movedChunkLoad.addToDistribution(&distribution, now);
+
+        migrations =
+            BalancerPolicy::balance(cluster.first, distribution, false, LoadBalancingSettings());
+        ASSERT_EQ(1U, migrations.size());
+        ASSERT_EQ(kShardId0, migrations[0].from);
+        ASSERT_EQ(kShardId1, migrations[0].to);
+        ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMin(), migrations[0].minKey);
+
+        movedChunkLoad.recordMigrations(distribution, migrations, now);
+    }
+
+    applyMigration(&cluster.second, migrations[0]);
+    now += Minutes(1);
+
+    // Second round: the donor no longer reports the moved chunk and the recipient has not sampled
+    // it yet. Taken at face value, the recipient looks idle and would receive another hot chunk.
+    {
+        DistributionStatus distribution(kNamespace, cluster.second);
+        addShardChunkLoad(&distribution, kShardId0, {100, 300, 200});
+        addShardChunkLoad(&distribution, kShardId1, {0});
+        ASSERT_EQ(
+            1U,
+            BalancerPolicy::balance(cluster.first, distribution, false, LoadBalancingSettings())
+                .size());
+
+        movedChunkLoad.addToDistribution(&distribution, now);
+        ASSERT_EQ(400, distribution.getChunkLoad(cluster.second[kShardId1][0]));
+
+        migrations =
+            BalancerPolicy::balance(cluster.first, distribution, false, LoadBalancingSettings());
+        ASSERT(migrations.empty());
+        movedChunkLoad.recordMigrations(distribution, migrations, now);
+    }
+
+    now += Minutes(5);
+
+    // Third round: the recipient has sampled part of the chunk's load, which is not enough yet
+    {
+        DistributionStatus distribution(kNamespace, cluster.second);
+        addShardChunkLoad(&distribution, kShardId0, {100, 300, 200});
+        addShardChunkLoad(&distribution, kShardId1, {150});
+        movedChunkLoad.addToDistribution(&distribution, now);
+        ASSERT_EQ(400, distribution.getChunkLoad(cluster.second[kShardId1][0]));
+        ASSERT(BalancerPolicy::balance(cluster.first, distribution, false, LoadBalancingSettings())
+                   .empty());
+    }
+
+    now += Minutes(30);
+
+    // Fourth round: long after the migration, only the recipient's own samples count
+    {
+        DistributionStatus distribution(kNamespace, cluster.second);
+        addShardChunkLoad(&distribution, kShardId0, {100, 300, 250});
+        addShardChunkLoad(&distribution, kShardId1, {350});
+        movedChunkLoad.addToDistribution(&distribution, now);
+        ASSERT_EQ(350, distribution.getChunkLoad(cluster.second[kShardId1][0]));
+        ASSERT(BalancerPolicy::balance(cluster.first, distribution, false, LoadBalancingSettings())
+                   .empty());
+    }
+}
+
+TEST(BalancerPolicy, BalancerDoesNotCarryLoadOfChunkWhichWasNotMoved) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion), 4},
+         {ShardStatistics(kShardId1, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion), 0}});
+
+    MovedChunkLoadCache movedChunkLoad;
+    const Date_t now = Date_t::fromMillisSinceEpoch(1000000);
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    addShardChunkLoad(&distribution, kShardId0, {100, 400, 300, 200});
+    const auto migrations(
+        BalancerPolicy::balance(cluster.first, distribution, false, LoadBalancingSettings()));
+    ASSERT_EQ(1U, migrations.size());
+    movedChunkLoad.recordMigrations(distribution, migrations, now);
+
+    // The migration failed, so the donor keeps reporting the chunk's load
+    DistributionStatus nextDistribution(kNamespace, cluster.second);
+    addShardChunkLoad(&nextDistribution, kShardId0, {100, 400, 300, 200});
+    movedChunkLoad.addToDistribution(&nextDistribution, now + Minutes(1));
+    ASSERT_EQ(1000, nextDistribution.shardLoadWithTag(kShardId0, ""));
+    ASSERT_EQ(0, nextDistribution.shardLoadWithTag(kShardId1, ""));
+}
+
+TEST(DistributionStatus, ChunkLoadOfSplitChunkIsUnknown) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 2, false, emptyTagSet, emptyShardVersion), 2}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    const auto& chunk = cluster.second[kShardId0][0];
+    distribution.addChunkLoad(ClusterStatistics::ChunkLoadStatistics(
+        kShardId0, chunk.getMin(), BSON("x" << 100), 10, 20));
+
+    ASSERT(distribution.hasChunkLoad());
+    ASSERT_EQ(0, distribution.getChunkLoad(chunk));
+
+    distribution.addChunkLoad(ClusterStatistics::ChunkLoadStatistics(
+        kShardId0, chunk.getMin(), chunk.getMax(), 10, 20));
+    ASSERT_EQ(30, distribution.getChunkLoad(chunk));
+    ASSERT_EQ(30, distribution.shardLoadWithTag(kShardId0, ""));
+}
+
 TEST(DistributionStatus, AddTagRangeOverlap) {
     DistributionStatus d(kNamespace, ShardToChunksMap{});
 
@@ -52,6 +52,17 @@ ClusterStatistics::ShardStatistics::ShardStatistics(ShardId inShardId,
       shardTags(std::move(inShardTags)),
       mongoVersion(std::move(inMongoVersion)) {}
 
+ClusterStatistics::ChunkLoadStatistics::ChunkLoadStatistics(ShardId inShardId,
+                                                            BSONObj inMinKey,
+                                                            BSONObj inMaxKey,
+                                                            long long inReads,
+                                                            long long inWrites)
+    : shardId(std::move(inShardId)),
+      minKey(std::move(inMinKey)),
+      maxKey(std::move(inMaxKey)),
+      reads(inReads),
+      writes(inWrites) {}
+
 bool ClusterStatistics::ShardStatistics::isSizeMaxed() const {
     if (!maxSizeMB || !currSizeMB) {
         return false;
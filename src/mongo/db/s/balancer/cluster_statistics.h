@@ -34,11 +34,12 @@
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
 #include "mongo/s/client/shard.h"
 
 namespace mongo {
 
-class BSONObj;
+class NamespaceString;
 class OperationContext;
 template <typename T>
 class StatusWith;
@@ -100,6 +101,37 @@ public:
         std::string mongoVersion;
     };
 
+    /**
+     * Structure, which describes the sampled load of a single chunk, as reported by the shard
+     * owning it.
+     */
+    struct ChunkLoadStatistics {
+    public:
+        ChunkLoadStatistics(ShardId shardId,
+                            BSONObj minKey,
+                            BSONObj maxKey,
+                            long long reads,
+                            long long writes);
+
+        /**
+         * Returns the number of operations served by the chunk, whether reads or writes.
+         */
+        long long load() const {
+            return reads + writes;
+        }
+
+        // The shard, which reported the statistic
+        ShardId shardId;
+
+        // Bounds of the chunk
+        BSONObj minKey;
+        BSONObj maxKey;
+
+        // Sampled number of reads and writes served by the chunk
+        long long reads{0};
+        long long writes{0};
+    };
+
     virtual ~ClusterStatistics();
 
     /**
@@ -108,6 +140,14 @@ public:
      */
     virtual StatusWith<std::vector<ShardStatistics>> getStats(OperationContext* txn) = 0;
 
+    /**
+     * Retrieves the sampled load of the chunks of the specified collection from the specified
+     * shards. Chunks, which have not served any operations recently, are not reported. Shards,
+     * which cannot report their chunks' load, are skipped.
+     */
+    virtual StatusWith<std::vector<ChunkLoadStatistics>> getChunkLoad(
+        OperationContext* txn, const NamespaceString& nss, const std::set<ShardId>& shardIds) = 0;
+
 protected:
     ClusterStatistics();
 };
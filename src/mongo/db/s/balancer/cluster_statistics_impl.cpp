@@ -32,10 +32,14 @@
 
 #include "mongo/db/s/balancer/cluster_statistics_impl.h"
 
+#include <iterator>
+
 #include "mongo/base/status_with.h"
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/client/read_preference.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/s/catalog/sharding_catalog_client.h"
+#include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/catalog/type_shard.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
@@ -92,6 +96,76 @@ StatusWith<string> retrieveShardMongoDVersion(OperationContext* txn, ShardId sha
     return version;
 }
 
+/**
+ * Executes the _getChunkLoad command against the specified shard and returns the sampled load of
+ * the chunks of the specified collection, which it owns.
+ */
+StatusWith<vector<ClusterStatistics::ChunkLoadStatistics>> retrieveShardChunkLoad(
+    OperationContext* txn, const ShardId& shardId, const NamespaceString& nss) {
+    auto shardStatus = Grid::get(txn)->shardRegistry()->getShard(txn, shardId);
+    if (!shardStatus.isOK()) {
+        return shardStatus.getStatus();
+    }
+
+    auto commandResponse = shardStatus.getValue()->runCommandWithFixedRetryAttempts(
+        txn,
+        ReadPreferenceSetting{ReadPreference::PrimaryOnly},
+        "admin",
+        BSON("_getChunkLoad" << nss.ns()),
+        Shard::RetryPolicy::kIdempotent);
+    if (!commandResponse.isOK()) {
+        return commandResponse.getStatus();
+    }
+    if (!commandResponse.getValue().commandStatus.isOK()) {
+        return commandResponse.getValue().commandStatus;
+    }
+
+    BSONElement chunksElem;
+    Status status =
+        bsonExtractTypedField(commandResponse.getValue().response, "chunks", Array, &chunksElem);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    vector<ClusterStatistics::ChunkLoadStatistics> chunkLoad;
+    for (const auto& chunkElem : chunksElem.Obj()) {
+        if (chunkElem.type() != Object) {
+            return {ErrorCodes::TypeMismatch,
+                    str::stream() << "Unexpected chunk load entry " << chunkElem};
+        }
+        const BSONObj chunkObj = chunkElem.Obj();
+
+        BSONElement minKeyElem;
+        status = bsonExtractTypedField(chunkObj, ChunkType::min(), Object, &minKeyElem);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        BSONElement maxKeyElem;
+        status = bsonExtractTypedField(chunkObj, ChunkType::max(), Object, &maxKeyElem);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        long long reads;
+        status = bsonExtractIntegerField(chunkObj, "reads", &reads);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        long long writes;
+        status = bsonExtractIntegerField(chunkObj, "writes", &writes);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        chunkLoad.emplace_back(
+            shardId, minKeyElem.Obj().getOwned(), maxKeyElem.Obj().getOwned(), reads, writes);
+    }
+
+    return chunkLoad;
+}
+
 }  // namespace
 
 using ShardStatistics = ClusterStatistics::ShardStatistics;
@@ -157,4 +231,26 @@ StatusWith<vector<ShardStatistics>> ClusterStatisticsImpl::getStats(OperationCon
     return stats;
 }
 
+StatusWith<vector<ClusterStatistics::ChunkLoadStatistics>> ClusterStatisticsImpl::getChunkLoad(
+    OperationContext* txn, const NamespaceString& nss, const std::set<ShardId>& shardIds) {
+    vector<ChunkLoadStatistics> chunkLoad;
+
+    for (const auto& shardId : shardIds) {
+        auto shardChunkLoadStatus = retrieveShardChunkLoad(txn, shardId, nss);
+        if (!shardChunkLoadStatus.isOK()) {
+            // The load is only a hint for the balancer, so a shard, which cannot report it, only
+            // makes its chunks look idle
+            LOG(1) << "Unable to obtain chunk load for collection " << nss << " from " << shardId
+                   << causedBy(shardChunkLoadStatus.getStatus());
+            continue;
+        }
+
+        chunkLoad.insert(chunkLoad.end(),
+                         std::make_move_iterator(shardChunkLoadStatus.getValue().begin()),
+                         std::make_move_iterator(shardChunkLoadStatus.getValue().end()));
+    }
+
+    return chunkLoad;
+}
+
 }  // namespace mongo
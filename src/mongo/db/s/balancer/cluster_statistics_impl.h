@@ -43,6 +43,11 @@ public:
     ~ClusterStatisticsImpl();
 
     StatusWith<std::vector<ShardStatistics>> getStats(OperationContext* txn) override;
+
+    StatusWith<std::vector<ChunkLoadStatistics>> getChunkLoad(
+        OperationContext* txn,
+        const NamespaceString& nss,
+        const std::set<ShardId>& shardIds) override;
 };
 
 }  // namespace mongo
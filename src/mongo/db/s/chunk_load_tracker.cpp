@@ -0,0 +1,153 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/s/chunk_load_tracker.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/s/collection_metadata.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/s/catalog/type_chunk.h"
+
+namespace mongo {
+namespace {
+
+// One in this many reads and writes is counted. Counting requires extracting the shard key and
+// looking up its chunk, which is too expensive to do for every operation.
+MONGO_EXPORT_SERVER_PARAMETER(chunkLoadSampleRate, int, 10);
+
+// How often the counts are halved
+const Minutes kDecayPeriod(10);
+
+}  // namespace
+
+ChunkLoadTracker::ChunkLoadTracker()
+    : _countsByChunkMin(SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<Counts>()),
+      _lastDecay(Date_t::now()) {}
+
+bool ChunkLoadTracker::shouldSample() {
+    const int sampleRate = chunkLoadSampleRate.load();
+    if (sampleRate <= 0) {
+        return false;
+    }
+
+    return _numOps.fetchAndAdd(1) % sampleRate == 0;
+}
+
+void ChunkLoadTracker::recordRead(const CollectionMetadata& metadata, const BSONObj& shardKey) {
+    _record(metadata, shardKey, false);
+}
+
+void ChunkLoadTracker::recordWrite(const CollectionMetadata& metadata, const BSONObj& shardKey) {
+    _record(metadata, shardKey, true);
+}
+
+void ChunkLoadTracker::report(const CollectionMetadata& metadata, BSONArrayBuilder* builder) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _decay_inlock(Date_t::now());
+
+    const auto& chunks = metadata.getChunks();
+
+    for (auto it = _countsByChunkMin.begin(); it != _countsByChunkMin.end();) {
+        auto chunkIt = chunks.find(it->first);
+        if (chunkIt == chunks.end() || chunkIt->second.getMaxKey().woCompare(it->second.max)) {
+            it = _countsByChunkMin.erase(it);
+            continue;
+        }
+
+        BSONObjBuilder chunkBuilder(builder->subobjStart());
+        chunkBuilder.append(ChunkType::min(), it->first);
+        chunkBuilder.append(ChunkType::max(), it->second.max);
+        chunkBuilder.append("reads", it->second.reads);
+        chunkBuilder.append("writes", it->second.writes);
+        chunkBuilder.doneFast();
+        ++it;
+    }
+}
+
+void ChunkLoadTracker::_record(const CollectionMetadata& metadata,
+                               const BSONObj& shardKey,
+                               bool isWrite) {
+    if (shardKey.isEmpty()) {
+        return;
+    }
+
+    ChunkType chunk;
+    if (!metadata.getNextChunk(shardKey, &chunk) || chunk.getMin().woCompare(shardKey) > 0) {
+        return;
+    }
+
+    const int sampleRate = std::max(chunkLoadSampleRate.load(), 1);
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _decay_inlock(Date_t::now());
+
+    auto it = _countsByChunkMin.find(chunk.getMin());
+    if (it == _countsByChunkMin.end()) {
+        it = _countsByChunkMin.emplace(chunk.getMin().getOwned(), Counts()).first;
+        it->second.max = chunk.getMax().getOwned();
+    } else if (chunk.getMax().woCompare(it->second.max)) {
+        // The chunk was split or merged since it was last counted, so the counts describe a
+        // different range
+        it->second = Counts();
+        it->second.max = chunk.getMax().getOwned();
+    }
+
+    if (isWrite) {
+        it->second.writes += sampleRate;
+    } else {
+        it->second.reads += sampleRate;
+    }
+}
+
+void ChunkLoadTracker::_decay_inlock(Date_t now) {
+    const long long periods =
+        durationCount<Milliseconds>(now - _lastDecay) / durationCount<Milliseconds>(kDecayPeriod);
+    if (periods <= 0) {
+        return;
+    }
+
+    _lastDecay += kDecayPeriod * periods;
+
+    const int shift = static_cast<int>(std::min(periods, 62LL));
+    for (auto it = _countsByChunkMin.begin(); it != _countsByChunkMin.end();) {
+        it->second.reads >>= shift;
+        it->second.writes >>= shift;
+
+        if (!it->second.reads && !it->second.writes) {
+            it = _countsByChunkMin.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+}  // namespace mongo
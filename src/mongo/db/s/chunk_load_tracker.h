@@ -0,0 +1,105 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class BSONArrayBuilder;
+class CollectionMetadata;
+
+/**
+ * Keeps sampled counts of the reads and writes served by each chunk of a sharded collection, which
+ * the balancer uses to spread load rather than just chunks across shards. Only one in every
+ * chunkLoadSampleRate operations is counted, with a weight of chunkLoadSampleRate, and the counts
+ * decay by half every few minutes, so they reflect recent load.
+ *
+ * Thread-safe.
+ */
+class ChunkLoadTracker {
+    MONGO_DISALLOW_COPYING(ChunkLoadTracker);
+
+public:
+    ChunkLoadTracker();
+
+    /**
+     * Returns whether the current operation should be counted. Callers use it to skip extracting
+     * the shard key of the operations, which are not sampled.
+     */
+    bool shouldSample();
+
+    /**
+     * Counts a sampled read or write of the document with the specified shard key against the chunk
+     * of 'metadata', which contains it. Keys which do not belong to any chunk are ignored.
+     */
+    void recordRead(const CollectionMetadata& metadata, const BSONObj& shardKey);
+    void recordWrite(const CollectionMetadata& metadata, const BSONObj& shardKey);
+
+    /**
+     * Appends a {min, max, reads, writes} entry for every chunk of 'metadata', which has served any
+     * operations. Forgets the counts of chunks, which are no longer in 'metadata' with the same
+     * bounds, such as chunks which were split or merged since they were counted.
+     */
+    void report(const CollectionMetadata& metadata, BSONArrayBuilder* builder);
+
+private:
+    struct Counts {
+        // Max key of the chunk at the time it was counted
+        BSONObj max;
+        long long reads{0};
+        long long writes{0};
+    };
+
+    void _record(const CollectionMetadata& metadata, const BSONObj& shardKey, bool isWrite);
+
+    /**
+     * Halves all counts once for every decay period, which has elapsed since the last decay.
+     */
+    void _decay_inlock(Date_t now);
+
+    // Number of operations seen, whether sampled or not
+    AtomicUInt64 _numOps;
+
+    // Protects the fields below
+    stdx::mutex _mutex;
+
+    // Counts keyed by the min key of the chunk to which they apply
+    BSONObjIndexedMap<Counts> _countsByChunkMin;
+
+    // When the counts were last halved
+    Date_t _lastDecay;
+};
+
+}  // namespace mongo
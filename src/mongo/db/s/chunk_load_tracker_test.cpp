@@ -0,0 +1,169 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/s/chunk_load_tracker.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/s/collection_metadata.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+void setChunkLoadSampleRate(StringData value) {
+    auto param = ServerParameterSet::getGlobal()->getMap().find("chunkLoadSampleRate");
+    ASSERT(param != ServerParameterSet::getGlobal()->getMap().end());
+    ASSERT_OK(param->second->setFromString(value.toString()));
+}
+
+std::unique_ptr<CollectionMetadata> makeMetadata(int numChunks) {
+    ChunkVersion version(1, 0, OID::gen());
+    auto metadata = stdx::make_unique<CollectionMetadata>(BSON("key" << 1), version);
+
+    for (int i = 0; i < numChunks; i++) {
+        version.incMajor();
+        metadata = metadata->clonePlusChunk(
+            BSON("key" << i * 10), BSON("key" << (i + 1) * 10), version);
+    }
+
+    return metadata;
+}
+
+TEST(ChunkLoadTracker, SampleRate) {
+    ON_BLOCK_EXIT([] { setChunkLoadSampleRate("10"); });
+
+    ChunkLoadTracker tracker;
+
+    setChunkLoadSampleRate("0");
+    ASSERT_FALSE(tracker.shouldSample());
+
+    setChunkLoadSampleRate("2");
+    int numSampled = 0;
+    for (int i = 0; i < 10; i++) {
+        numSampled += tracker.shouldSample() ? 1 : 0;
+    }
+    ASSERT_EQ(5, numSampled);
+}
+
+TEST(ChunkLoadTracker, CountsOperationsPerChunk) {
+    ON_BLOCK_EXIT([] { setChunkLoadSampleRate("10"); });
+    setChunkLoadSampleRate("1");
+
+    const auto metadata = makeMetadata(2);
+
+    ChunkLoadTracker tracker;
+    tracker.recordRead(*metadata, BSON("key" << 0));
+    tracker.recordRead(*metadata, BSON("key" << 5));
+    tracker.recordWrite(*metadata, BSON("key" << 5));
+    tracker.recordWrite(*metadata, BSON("key" << 15));
+
+    // Keys outside of the owned chunks are not counted
+    tracker.recordRead(*metadata, BSON("key" << 25));
+    tracker.recordWrite(*metadata, BSON("key" << -5));
+
+    BSONArrayBuilder builder;
+    tracker.report(*metadata, &builder);
+    const BSONArray report = builder.arr();
+
+    ASSERT_EQ(2, report.nFields());
+    ASSERT_BSONOBJ_EQ(BSON("key" << 0), report[0]["min"].Obj());
+    ASSERT_BSONOBJ_EQ(BSON("key" << 10), report[0]["max"].Obj());
+    ASSERT_EQ(2, report[0]["reads"].numberLong());
+    ASSERT_EQ(1, report[0]["writes"].numberLong());
+
+    ASSERT_BSONOBJ_EQ(BSON("key" << 10), report[1]["min"].Obj());
+    ASSERT_BSONOBJ_EQ(BSON("key" << 20), report[1]["max"].Obj());
+    ASSERT_EQ(0, report[1]["reads"].numberLong());
+    ASSERT_EQ(1, report[1]["writes"].numberLong());
+}
+
+TEST(ChunkLoadTracker, ForgetsChunksNoLongerOwned) {
+    ON_BLOCK_EXIT([] { setChunkLoadSampleRate("10"); });
+    setChunkLoadSampleRate("1");
+
+    ChunkLoadTracker tracker;
+    tracker.recordRead(*makeMetadata(2), BSON("key" << 15));
+
+    {
+        BSONArrayBuilder builder;
+        tracker.report(*makeMetadata(1), &builder);
+        ASSERT_EQ(0, builder.arr().nFields());
+    }
+
+    {
+        BSONArrayBuilder builder;
+        tracker.report(*makeMetadata(2), &builder);
+        ASSERT_EQ(0, builder.arr().nFields());
+    }
+}
+
+TEST(ChunkLoadTracker, ForgetsCountsOfSplitChunks) {
+    ON_BLOCK_EXIT([] { setChunkLoadSampleRate("10"); });
+    setChunkLoadSampleRate("1");
+
+    ChunkLoadTracker tracker;
+    tracker.recordRead(*makeMetadata(1), BSON("key" << 2));
+    tracker.recordRead(*makeMetadata(1), BSON("key" << 7));
+
+    // Split [0, 10) at 5
+    ChunkVersion version(1, 0, OID::gen());
+    auto splitMetadata = stdx::make_unique<CollectionMetadata>(BSON("key" << 1), version);
+    version.incMajor();
+    splitMetadata = splitMetadata->clonePlusChunk(BSON("key" << 0), BSON("key" << 5), version);
+    version.incMajor();
+    splitMetadata = splitMetadata->clonePlusChunk(BSON("key" << 5), BSON("key" << 10), version);
+
+    {
+        BSONArrayBuilder builder;
+        tracker.report(*splitMetadata, &builder);
+        ASSERT_EQ(0, builder.arr().nFields());
+    }
+
+    tracker.recordRead(*makeMetadata(1), BSON("key" << 2));
+    tracker.recordRead(*splitMetadata, BSON("key" << 2));
+
+    {
+        BSONArrayBuilder builder;
+        tracker.report(*splitMetadata, &builder);
+        const BSONArray report = builder.arr();
+
+        ASSERT_EQ(1, report.nFields());
+        ASSERT_BSONOBJ_EQ(BSON("key" << 0), report[0]["min"].Obj());
+        ASSERT_BSONOBJ_EQ(BSON("key" << 5), report[0]["max"].Obj());
+        ASSERT_EQ(1, report[0]["reads"].numberLong());
+    }
+}
+
+}  // namespace
+}  // namespace mongo
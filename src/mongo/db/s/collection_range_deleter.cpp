@@ -32,17 +32,16 @@
 
 #include "mongo/db/s/collection_range_deleter.h"
 
-#include <algorithm>
-
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/client.h"
+#include "mongo/db/concurrency/locker.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/keypattern.h"
 #include "mongo/db/query/internal_plans.h"
-#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
@@ -53,6 +52,7 @@
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -70,7 +70,8 @@ const WriteConcernOptions kMajorityWriteConcern(WriteConcernOptions::kMajority,
 
 }  // unnamed namespace
 
-CollectionRangeDeleter::CollectionRangeDeleter(NamespaceString nss) : _nss(std::move(nss)) {}
+CollectionRangeDeleter::CollectionRangeDeleter(NamespaceString nss)
+    : _nss(std::move(nss)), _pacer(_nss.ns()) {}
 
 void CollectionRangeDeleter::run() {
     Client::initThread(getThreadName().c_str());
@@ -81,7 +82,8 @@ void CollectionRangeDeleter::run() {
     // If there are more ranges to run, we add <this> back onto the task executor to run again.
     if (hasNextRangeToClean) {
         auto executor = ShardingState::get(txn)->getRangeDeleterTaskExecutor();
-        executor->scheduleWork([this](const CallbackArgs& cbArgs) { run(); });
+        executor->scheduleWorkAt(executor->now() + _nextBatchDelay,
+                                 [this](const CallbackArgs& cbArgs) { run(); });
     } else {
         delete this;
     }
@@ -89,6 +91,7 @@ void CollectionRangeDeleter::run() {
 
 bool CollectionRangeDeleter::cleanupNextRange(OperationContext* txn) {
     int numDocumentsDeleted;
+    long long numBytesDeleted = 0;
 
     {
         AutoGetCollection autoColl(txn, _nss, MODE_IX);
@@ -115,15 +118,18 @@ bool CollectionRangeDeleter::cleanupNextRange(OperationContext* txn) {
             return false;
         }
 
-        numDocumentsDeleted = _doDeletion(txn, collection, metadata->getKeyPattern());
+        numDocumentsDeleted =
+            _doDeletion(txn, collection, metadata->getKeyPattern(), &numBytesDeleted);
         if (numDocumentsDeleted <= 0) {
             metadataManager.removeRangeToClean(_rangeInProgress.get());
             _rangeInProgress = boost::none;
+            _nextBatchDelay = Milliseconds(0);
             return true;
         }
     }
 
     // wait for replication
+    Timer replicationTimer;
     WriteConcernResult wcResult;
     auto currentClientOpTime = repl::ReplClientInfo::forClient(txn->getClient()).getLastOp();
     Status status = waitForWriteConcern(txn, currentClientOpTime, kMajorityWriteConcern, &wcResult);
@@ -132,12 +138,18 @@ bool CollectionRangeDeleter::cleanupNextRange(OperationContext* txn) {
                   << " : " << status.reason();
     }
 
+    _nextBatchDelay = _pacer.noteBatch(numDocumentsDeleted,
+                                       numBytesDeleted,
+                                       Milliseconds(replicationTimer.millis()),
+                                       Milliseconds(0),
+                                       Locker::areWriteTicketsExhausted());
     return true;
 }
 
 int CollectionRangeDeleter::_doDeletion(OperationContext* txn,
                                         Collection* collection,
-                                        const BSONObj& keyPattern) {
+                                        const BSONObj& keyPattern,
+                                        long long* bytesDeleted) {
     invariant(_rangeInProgress);
     invariant(collection);
 
@@ -169,52 +181,75 @@ int CollectionRangeDeleter::_doDeletion(OperationContext* txn,
         return -1;
     }
 
-    std::unique_ptr<PlanExecutor> exec(
-        InternalPlanner::indexScan(txn,
-                                   collection,
-                                   desc,
-                                   min,
-                                   max,
-                                   BoundInclusion::kIncludeStartKeyOnly,
-                                   PlanExecutor::YIELD_MANUAL,
-                                   InternalPlanner::FORWARD,
-                                   InternalPlanner::IXSCAN_FETCH));
     int numDeleted = 0;
-    const int maxItersBeforeYield = std::max(static_cast<int>(internalQueryExecYieldIterations), 1);
-
-    while (numDeleted < maxItersBeforeYield) {
-        RecordId rloc;
-        BSONObj obj;
-        PlanExecutor::ExecState state;
-        state = exec->getNext(&obj, &rloc);
-        if (PlanExecutor::IS_EOF == state) {
-            break;
-        }
 
-        if (PlanExecutor::FAILURE == state || PlanExecutor::DEAD == state) {
-            warning(LogComponent::kSharding)
-                << PlanExecutor::statestr(state) << " - cursor error while trying to delete " << min
-                << " to " << max << " in " << _nss << ": " << WorkingSetCommon::toStatusString(obj)
-                << ", stats: " << Explain::getWinningPlanStats(exec.get());
-            break;
-        }
+    // The collection lock is held for the whole batch, so this holds for all of it
+    if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesFor(_nss)) {
+        warning() << "stepped down from primary while deleting chunk; "
+                  << "orphaning data in " << _nss << " in range [" << min << ", " << max << ")";
+        return numDeleted;
+    }
 
-        invariant(PlanExecutor::ADVANCED == state);
+    const long long bytesDeletedBefore = *bytesDeleted;
+
+    // All documents of the batch are deleted in a single storage transaction. A write conflict
+    // rolls it back, so the batch is retried with a new scan.
+    MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+        numDeleted = 0;
+        *bytesDeleted = bytesDeletedBefore;
+
+        std::unique_ptr<PlanExecutor> exec(
+            InternalPlanner::indexScan(txn,
+                                       collection,
+                                       desc,
+                                       min,
+                                       max,
+                                       BoundInclusion::kIncludeStartKeyOnly,
+                                       PlanExecutor::YIELD_MANUAL,
+                                       InternalPlanner::FORWARD,
+                                       InternalPlanner::IXSCAN_FETCH));
 
         WriteUnitOfWork wuow(txn);
 
-        NamespaceString nss(_nss);
-        if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesFor(nss)) {
-            warning() << "stepped down from primary while deleting chunk; "
-                      << "orphaning data in " << _nss << " in range [" << min << ", " << max << ")";
-            return numDeleted;
+        while (!_pacer.isBatchFull(numDeleted, *bytesDeleted)) {
+            RecordId rloc;
+            BSONObj obj;
+            PlanExecutor::ExecState state;
+            state = exec->getNext(&obj, &rloc);
+            if (PlanExecutor::IS_EOF == state) {
+                break;
+            }
+
+            if (PlanExecutor::FAILURE == state || PlanExecutor::DEAD == state) {
+                warning(LogComponent::kSharding)
+                    << PlanExecutor::statestr(state) << " - cursor error while trying to delete "
+                    << min << " to " << max << " in " << _nss << ": "
+                    << WorkingSetCommon::toStatusString(obj)
+                    << ", stats: " << Explain::getWinningPlanStats(exec.get());
+                break;
+            }
+
+            invariant(PlanExecutor::ADVANCED == state);
+
+            *bytesDeleted += obj.objsize();
+
+            // The scan is positioned on the index entry of the document being deleted, so it must
+            // be saved across the delete and repositioned afterwards
+            exec->saveState();
+            OpDebug* const nullOpDebug = nullptr;
+            collection->deleteDocument(txn, rloc, nullOpDebug, true);
+            numDeleted++;
+
+            if (!exec->restoreState()) {
+                warning(LogComponent::kSharding) << "index scan was killed while deleting " << min
+                                                 << " to " << max << " in " << _nss;
+                break;
+            }
         }
 
-        OpDebug* const nullOpDebug = nullptr;
-        collection->deleteDocument(txn, rloc, nullOpDebug, true);
         wuow.commit();
-        numDeleted++;
     }
+    MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "CollectionRangeDeleter", _nss.ns());
 
     return numDeleted;
 }
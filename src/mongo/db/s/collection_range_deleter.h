@@ -29,6 +29,7 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/range_deletion_pacer.h"
 #include "mongo/s/catalog/type_chunk.h"
 
 namespace mongo {
@@ -50,8 +51,8 @@ public:
 
     /**
      * Acquires the collection IX lock and checks whether there are new entries for the collection's
-     * rangesToClean structure.  If there are, deletes some small amount of entries and yields using
-     * the standard query yielding logic.
+     * rangesToClean structure.  If there are, deletes a batch of entries sized by the pacer in a
+     * single storage transaction and waits for it to replicate.
      *
      * Returns true if there are more entries in rangesToClean, false if there is no more progress
      * to be made.
@@ -60,18 +61,28 @@ public:
 
 private:
     /**
-     * Performs the deletion of a small amount of entries within the range in progress.
+     * Performs the deletion of a batch of entries within the range in progress and adds the size
+     * of the deleted documents to 'bytesDeleted'.
      * This function will invariant if called while _rangeInProgress is not set.
      *
      * Returns the number of documents deleted (0 if deletion is finished), or -1 for error.
      */
-    int _doDeletion(OperationContext* txn, Collection* collection, const BSONObj& keyPattern);
+    int _doDeletion(OperationContext* txn,
+                    Collection* collection,
+                    const BSONObj& keyPattern,
+                    long long* bytesDeleted);
 
     NamespaceString _nss;
 
     // Holds a range for which deletion has begun. If empty, then a new range
     // must be requested from rangesToClean
     boost::optional<ChunkRange> _rangeInProgress;
+
+    // Sizes the batches and paces them against replication lag and foreground writes
+    RangeDeletionPacer _pacer;
+
+    // How long to wait before running the next batch, as requested by the pacer
+    Milliseconds _nextBatchDelay{0};
 };
 
 }  // namespace mongo
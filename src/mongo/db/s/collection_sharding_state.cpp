@@ -32,6 +32,8 @@
 
 #include "mongo/db/s/collection_sharding_state.h"
 
+#include <algorithm>
+
 #include "mongo/db/client.h"
 #include "mongo/db/concurrency/lock_state.h"
 #include "mongo/db/operation_context.h"
@@ -52,6 +54,7 @@
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/cluster_identity_loader.h"
 #include "mongo/s/grid.h"
+#include "mongo/s/shard_key_pattern.h"
 #include "mongo/s/stale_exception.h"
 #include "mongo/util/log.h"
 
@@ -132,7 +135,7 @@ CollectionShardingState::CollectionShardingState(ServiceContext* sc, NamespaceSt
     : _nss(std::move(nss)), _metadataManager{sc, _nss} {}
 
 CollectionShardingState::~CollectionShardingState() {
-    invariant(!_sourceMgr);
+    invariant(_sourceMgrs.empty());
 }
 
 CollectionShardingState* CollectionShardingState::get(OperationContext* txn,
@@ -172,24 +175,52 @@ void CollectionShardingState::forgetReceive(const ChunkRange& range) {
     _metadataManager.forgetReceive(range);
 }
 
-MigrationSourceManager* CollectionShardingState::getMigrationSourceManager() {
-    return _sourceMgr;
+std::shared_ptr<Notification<void>> CollectionShardingState::getMigrationCriticalSectionSignal()
+    const {
+    for (const auto sourceMgr : _sourceMgrs) {
+        if (auto critSecSignal = sourceMgr->getMigrationCriticalSectionSignal()) {
+            return critSecSignal;
+        }
+    }
+
+    return nullptr;
 }
 
-void CollectionShardingState::setMigrationSourceManager(OperationContext* txn,
-                                                        MigrationSourceManager* sourceMgr) {
+Status CollectionShardingState::setMigrationSourceManager(OperationContext* txn,
+                                                          MigrationSourceManager* sourceMgr) {
     invariant(txn->lockState()->isCollectionLockedForMode(_nss.ns(), MODE_X));
     invariant(sourceMgr);
-    invariant(!_sourceMgr);
 
-    _sourceMgr = sourceMgr;
+    const ChunkRange range = sourceMgr->getChunkRange();
+    for (const auto activeSourceMgr : _sourceMgrs) {
+        const ChunkRange activeRange = activeSourceMgr->getChunkRange();
+        invariant(!rangeOverlaps(
+            activeRange.getMin(), activeRange.getMax(), range.getMin(), range.getMax()));
+    }
+
+    // Each migration moves exactly one chunk of the metadata, so counting the migrations tells
+    // whether a chunk outside of all of them remains
+    auto metadata = getMetadata();
+    if (!_sourceMgrs.empty() && metadata && metadata->getNumChunks() <= _sourceMgrs.size() + 1) {
+        return {ErrorCodes::ConflictingOperationInProgress,
+                str::stream() << "Cannot migrate chunk " << redact(range.toString()) << " of "
+                              << _nss.ns()
+                              << ", because it would leave no chunk on this shard outside of the "
+                              << _sourceMgrs.size()
+                              << " active migrations"};
+    }
+
+    _sourceMgrs.push_back(sourceMgr);
+    return Status::OK();
 }
 
-void CollectionShardingState::clearMigrationSourceManager(OperationContext* txn) {
+void CollectionShardingState::clearMigrationSourceManager(OperationContext* txn,
+                                                          MigrationSourceManager* sourceMgr) {
     invariant(txn->lockState()->isCollectionLockedForMode(_nss.ns(), MODE_X));
-    invariant(_sourceMgr);
 
-    _sourceMgr = nullptr;
+    auto it = std::find(_sourceMgrs.begin(), _sourceMgrs.end(), sourceMgr);
+    invariant(it != _sourceMgrs.end());
+    _sourceMgrs.erase(it);
 }
 
 void CollectionShardingState::checkShardVersionOrThrow(OperationContext* txn) {
@@ -217,15 +248,17 @@ bool CollectionShardingState::collectionIsSharded() {
     return true;
 }
 
-bool CollectionShardingState::isDocumentInMigratingChunk(OperationContext* txn,
-                                                         const BSONObj& doc) {
+MigrationSourceManager* CollectionShardingState::getMigrationSourceManagerForDocument(
+    OperationContext* txn, const BSONObj& doc) {
     dassert(txn->lockState()->isCollectionLockedForMode(_nss.ns(), MODE_IX));
 
-    if (_sourceMgr) {
-        return _sourceMgr->getCloner()->isDocumentInMigratingChunk(txn, doc);
+    for (const auto sourceMgr : _sourceMgrs) {
+        if (sourceMgr->getCloner()->isDocumentInMigratingChunk(txn, doc)) {
+            return sourceMgr;
+        }
     }
 
-    return false;
+    return nullptr;
 }
 
 void CollectionShardingState::onInsertOp(OperationContext* txn, const BSONObj& insertedDoc) {
@@ -261,8 +294,10 @@ void CollectionShardingState::onInsertOp(OperationContext* txn, const BSONObj& i
 
     checkShardVersionOrThrow(txn);
 
-    if (_sourceMgr) {
-        _sourceMgr->getCloner()->onInsertOp(txn, insertedDoc);
+    _recordWriteOp(insertedDoc);
+
+    if (auto sourceMgr = getMigrationSourceManagerForDocument(txn, insertedDoc)) {
+        sourceMgr->getCloner()->onInsertOp(txn, insertedDoc);
     }
 }
 
@@ -271,8 +306,10 @@ void CollectionShardingState::onUpdateOp(OperationContext* txn, const BSONObj& u
 
     checkShardVersionOrThrow(txn);
 
-    if (_sourceMgr) {
-        _sourceMgr->getCloner()->onUpdateOp(txn, updatedDoc);
+    _recordWriteOp(updatedDoc);
+
+    if (auto sourceMgr = getMigrationSourceManagerForDocument(txn, updatedDoc)) {
+        sourceMgr->getCloner()->onUpdateOp(txn, updatedDoc);
     }
 }
 
@@ -324,8 +361,12 @@ void CollectionShardingState::onDeleteOp(OperationContext* txn,
 
     checkShardVersionOrThrow(txn);
 
-    if (_sourceMgr && deleteState.isMigrating) {
-        _sourceMgr->getCloner()->onDeleteOp(txn, deleteState.idDoc);
+    // Only the _id of the deleted document is known, so this counts the delete only if the shard
+    // key is made of fields of the _id
+    _recordWriteOp(deleteState.idDoc);
+
+    if (deleteState.sourceMgr) {
+        deleteState.sourceMgr->getCloner()->onDeleteOp(txn, deleteState.idDoc);
     }
 }
 
@@ -359,6 +400,44 @@ void CollectionShardingState::onDropCollection(OperationContext* txn,
     }
 }
 
+void CollectionShardingState::onReadOp(OperationContext* txn, const CanonicalQuery& query) {
+    if (!_loadTracker.shouldSample()) {
+        return;
+    }
+
+    auto metadata = getMetadata();
+    if (!metadata) {
+        return;
+    }
+
+    const ShardKeyPattern shardKeyPattern(metadata->getKeyPattern());
+    _loadTracker.recordRead(*metadata.getMetadata(),
+                            shardKeyPattern.extractShardKeyFromQuery(query));
+}
+
+void CollectionShardingState::reportChunkLoad(BSONArrayBuilder* builder) {
+    auto metadata = getMetadata();
+    if (!metadata) {
+        return;
+    }
+
+    _loadTracker.report(*metadata.getMetadata(), builder);
+}
+
+void CollectionShardingState::_recordWriteOp(const BSONObj& doc) {
+    if (!_loadTracker.shouldSample()) {
+        return;
+    }
+
+    auto metadata = getMetadata();
+    if (!metadata) {
+        return;
+    }
+
+    const ShardKeyPattern shardKeyPattern(metadata->getKeyPattern());
+    _loadTracker.recordWrite(*metadata.getMetadata(), shardKeyPattern.extractShardKeyFromDoc(doc));
+}
+
 bool CollectionShardingState::_checkShardVersionOk(OperationContext* txn,
                                                    string* errmsg,
                                                    ChunkVersion* expectedShardVersion,
@@ -401,13 +480,12 @@ bool CollectionShardingState::_checkShardVersionOk(OperationContext* txn,
     auto metadata = getMetadata();
     *actualShardVersion = metadata ? metadata->getShardVersion() : ChunkVersion::UNSHARDED();
 
-    if (_sourceMgr && _sourceMgr->getMigrationCriticalSectionSignal()) {
+    if (auto critSecSignal = getMigrationCriticalSectionSignal()) {
         *errmsg = str::stream() << "migration commit in progress for " << _nss.ns();
 
         // Set migration critical section on operation sharding state: operation will wait for the
         // migration to finish before returning failure and retrying.
-        OperationShardingState::get(txn).setMigrationCriticalSectionSignal(
-            _sourceMgr->getMigrationCriticalSectionSignal());
+        OperationShardingState::get(txn).setMigrationCriticalSectionSignal(critSecSignal);
         return false;
     }
 
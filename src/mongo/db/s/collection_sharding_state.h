@@ -30,15 +30,21 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/string_data.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/s/chunk_load_tracker.h"
 #include "mongo/db/s/metadata_manager.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/notification.h"
 
 namespace mongo {
 
+class BSONArrayBuilder;
 class BSONObj;
+class CanonicalQuery;
 struct ChunkVersion;
 class CollectionMetadata;
 class MigrationSourceManager;
@@ -69,9 +75,10 @@ public:
         // Contains the _id field of the document being deleted.
         BSONObj idDoc;
 
-        // True if the document being deleted belongs to a chunk which is currently being migrated
-        // out of this shard.
-        bool isMigrating = false;
+        // If the document being deleted belongs to a chunk which is currently being migrated out of
+        // this shard, the source manager of that migration. Remains valid until the delete is
+        // reported through onDeleteOp, because the collection lock is held in between.
+        MigrationSourceManager* sourceMgr = nullptr;
     };
 
     /**
@@ -119,23 +126,47 @@ public:
     void forgetReceive(const ChunkRange& range);
 
     /**
-     * Returns the active migration source manager, if one is available.
+     * Returns the active migration source managers, one for each chunk being migrated out of this
+     * shard, in the order they were attached.
      */
-    MigrationSourceManager* getMigrationSourceManager();
+    const std::vector<MigrationSourceManager*>& getMigrationSourceManagers() const {
+        return _sourceMgrs;
+    }
+
+    /**
+     * Returns the critical section signal of an active migration, which has entered its critical
+     * section, or nullptr if none has. Versioned operations on the collection must wait for it.
+     */
+    std::shared_ptr<Notification<void>> getMigrationCriticalSectionSignal() const;
 
     /**
      * Attaches a migration source manager to this collection's sharding state. Must be called with
-     * collection X lock. May not be called if there is a migration source manager already
-     * installed. Must be followed by a call to clearMigrationSourceManager.
+     * collection X lock. May not be called with a migration source manager, whose chunk overlaps
+     * the chunk of one already installed. If successful, must be followed by a call to
+     * clearMigrationSourceManager.
+     *
+     * Returns ConflictingOperationInProgress if attaching it would leave no chunk of the collection
+     * on this shard outside of the active migrations. Each migration bumps the version of such a
+     * control chunk when it commits, so one must remain for all of them.
      */
-    void setMigrationSourceManager(OperationContext* txn, MigrationSourceManager* sourceMgr);
+    Status setMigrationSourceManager(OperationContext* txn, MigrationSourceManager* sourceMgr);
 
     /**
      * Removes a migration source manager from this collection's sharding state. Must be called with
-     * collection X lock. May not be called if there isn't a migration source manager installed
-     * already through a previous call to setMigrationSourceManager.
+     * collection X lock. May not be called if the migration source manager wasn't installed
+     * through a previous call to setMigrationSourceManager.
      */
-    void clearMigrationSourceManager(OperationContext* txn);
+    void clearMigrationSourceManager(OperationContext* txn, MigrationSourceManager* sourceMgr);
+
+    /**
+     * Returns the mutex, which serializes the commits of the migrations of this collection's
+     * chunks, so that each of them chooses its control chunk from metadata, which reflects the
+     * commits of the others. It is held across the network call to the config server, so it must
+     * not be acquired while holding any locks.
+     */
+    stdx::mutex& getMigrationCommitMutex() {
+        return _migrationCommitMutex;
+    }
 
     /**
      * Checks whether the shard version in the context is compatible with the shard version of the
@@ -155,9 +186,15 @@ public:
     bool collectionIsSharded();
 
     // Replication subsystem hooks. If this collection is serving as a source for migration, these
-    // methods inform it of any changes to its contents.
+    // methods inform the migration of the chunk, which contains the changed document, of any
+    // changes to its contents.
 
-    bool isDocumentInMigratingChunk(OperationContext* txn, const BSONObj& doc);
+    /**
+     * Returns the source manager of the migration of the chunk, which contains the specified
+     * document, or nullptr if that chunk is not being migrated.
+     */
+    MigrationSourceManager* getMigrationSourceManagerForDocument(OperationContext* txn,
+                                                                 const BSONObj& doc);
 
     void onInsertOp(OperationContext* txn, const BSONObj& insertedDoc);
 
@@ -167,7 +204,26 @@ public:
 
     void onDropCollection(OperationContext* txn, const NamespaceString& collectionName);
 
+    // Load statistics. Reads and writes are sampled and counted against the chunk, which contains
+    // their shard key, so the balancer can tell hot chunks from cold ones.
+
+    /**
+     * Counts a read against the chunk it targets. Reads, which do not target a single shard key,
+     * are not counted.
+     */
+    void onReadOp(OperationContext* txn, const CanonicalQuery& query);
+
+    /**
+     * Appends the sampled read and write counts of the chunks of this collection.
+     */
+    void reportChunkLoad(BSONArrayBuilder* builder);
+
 private:
+    /**
+     * Counts a write of the specified document against the chunk which contains it.
+     */
+    void _recordWriteOp(const BSONObj& doc);
+
     friend class CollectionRangeDeleter;
 
     /**
@@ -194,12 +250,19 @@ private:
     // Contains all the metadata associated with this collection.
     MetadataManager _metadataManager;
 
-    // If this collection is serving as a source shard for chunk migration, this value will be
-    // non-null. To write this value there needs to be X-lock on the collection in order to
-    // synchronize with other callers, which read it.
+    // Sampled read and write counts per chunk
+    ChunkLoadTracker _loadTracker;
+
+    // If this collection is serving as a source shard for chunk migrations, contains one source
+    // manager for each chunk being migrated. Their chunks do not overlap. To modify this list there
+    // needs to be X-lock on the collection in order to synchronize with other callers, which read
+    // it.
     //
-    // NOTE: The value is not owned by this class.
-    MigrationSourceManager* _sourceMgr{nullptr};
+    // NOTE: The values are not owned by this class.
+    std::vector<MigrationSourceManager*> _sourceMgrs;
+
+    // Serializes the commits of the migrations of this collection's chunks
+    stdx::mutex _migrationCommitMutex;
 };
 
 }  // namespace mongo
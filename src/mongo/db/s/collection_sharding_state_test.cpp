@@ -30,23 +30,98 @@
 
 #include "mongo/platform/basic.h"
 
+#include <vector>
+
 #include "mongo/base/status_with.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context_noop.h"
 #include "mongo/db/s/collection_metadata.h"
 #include "mongo/db/s/collection_sharding_state.h"
+#include "mongo/db/s/migration_chunk_cloner_source.h"
+#include "mongo/db/s/migration_source_manager.h"
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/s/type_shard_identity.h"
 #include "mongo/db/server_options.h"
 #include "mongo/db/service_context_noop.h"
 #include "mongo/db/service_context_noop.h"
+#include "mongo/s/move_chunk_request.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/clock_source_mock.h"
 
 namespace mongo {
 namespace {
 
+const NamespaceString kMigratingNss("TestDB", "TestColl");
+
+/**
+ * Cloner, which owns the chunk of a migration on the shard key {x: 1} and records the changes it
+ * is notified of.
+ */
+class MigrationChunkClonerSourceMock : public MigrationChunkClonerSource {
+public:
+    explicit MigrationChunkClonerSourceMock(ChunkRange range) : _range(std::move(range)) {}
+
+    Status startClone(OperationContext* txn) override {
+        return Status::OK();
+    }
+
+    Status awaitUntilCriticalSectionIsAppropriate(OperationContext* txn,
+                                                  Milliseconds maxTimeToWait) override {
+        return Status::OK();
+    }
+
+    Status commitClone(OperationContext* txn) override {
+        return Status::OK();
+    }
+
+    void cancelClone(OperationContext* txn) override {}
+
+    bool isDocumentInMigratingChunk(OperationContext* txn, const BSONObj& doc) override {
+        return _range.containsKey(BSON("x" << doc["x"]));
+    }
+
+    void onInsertOp(OperationContext* txn, const BSONObj& insertedDoc) override {
+        inserted.push_back(insertedDoc.getOwned());
+    }
+
+    void onUpdateOp(OperationContext* txn, const BSONObj& updatedDoc) override {
+        updated.push_back(updatedDoc.getOwned());
+    }
+
+    void onDeleteOp(OperationContext* txn, const BSONObj& deletedDocId) override {
+        deleted.push_back(deletedDocId.getOwned());
+    }
+
+    std::vector<BSONObj> inserted;
+    std::vector<BSONObj> updated;
+    std::vector<BSONObj> deleted;
+
+private:
+    const ChunkRange _range;
+};
+
+MoveChunkRequest makeMoveChunkRequest(const ChunkRange& range) {
+    const ChunkVersion version(1, 0, OID::gen());
+
+    BSONObjBuilder builder;
+    MoveChunkRequest::appendAsCommand(
+        &builder,
+        kMigratingNss,
+        version,
+        unittest::assertGet(ConnectionString::parse("TestConfigRS/CS1:12345,CS2:12345,CS3:12345")),
+        ShardId("shard0001"),
+        ShardId("shard0002"),
+        range,
+        version,
+        1024,
+        MigrationSecondaryThrottleOptions::create(MigrationSecondaryThrottleOptions::kOff),
+        false,
+        true);
+
+    return unittest::assertGet(MoveChunkRequest::createFromCommand(kMigratingNss, builder.obj()));
+}
+
 class CollShardingStateTest : public mongo::unittest::Test {
 public:
     void setUp() override {
@@ -175,5 +250,100 @@ TEST_F(CollShardingStateTest, GlobalInitDoesntGetsCalledIfShardIdentityDocWasNot
     ASSERT_EQ(0, getInitCallCount());
 }
 
+TEST_F(CollShardingStateTest, OpsAreRoutedToTheMigrationOfTheirChunk) {
+    CollectionShardingState collShardingState(getServiceContext(), kMigratingNss);
+
+    std::vector<MigrationChunkClonerSourceMock*> cloners;
+    std::vector<std::unique_ptr<MigrationSourceManager>> sourceMgrs;
+    for (const auto& range : {ChunkRange(BSON("x" << 0), BSON("x" << 10)),
+                              ChunkRange(BSON("x" << 10), BSON("x" << 20)),
+                              ChunkRange(BSON("x" << 30), BSON("x" << 40))}) {
+        auto cloner = stdx::make_unique<MigrationChunkClonerSourceMock>(range);
+        cloners.push_back(cloner.get());
+        sourceMgrs.push_back(
+            MigrationSourceManager::createForTest(makeMoveChunkRequest(range), std::move(cloner)));
+        ASSERT_OK(collShardingState.setMigrationSourceManager(txn(), sourceMgrs.back().get()));
+    }
+
+    ASSERT_EQ(3U, collShardingState.getMigrationSourceManagers().size());
+
+    collShardingState.onInsertOp(txn(), BSON("_id" << 1 << "x" << 5));
+    collShardingState.onInsertOp(txn(), BSON("_id" << 2 << "x" << 10));
+    collShardingState.onInsertOp(txn(), BSON("_id" << 3 << "x" << 25));
+    collShardingState.onInsertOp(txn(), BSON("_id" << 4 << "x" << 39));
+    collShardingState.onUpdateOp(txn(), BSON("_id" << 5 << "x" << 19));
+    collShardingState.onUpdateOp(txn(), BSON("_id" << 6 << "x" << 40));
+
+    const BSONObj deletedDoc = BSON("_id" << 7 << "x" << 0);
+    CollectionShardingState::DeleteState deleteState;
+    deleteState.idDoc = BSON("_id" << 7);
+    deleteState.sourceMgr =
+        collShardingState.getMigrationSourceManagerForDocument(txn(), deletedDoc);
+    ASSERT_EQ(sourceMgrs[0].get(), deleteState.sourceMgr);
+    collShardingState.onDeleteOp(txn(), deleteState);
+
+    ASSERT_EQ(1U, cloners[0]->inserted.size());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 1 << "x" << 5), cloners[0]->inserted[0]);
+    ASSERT_EQ(0U, cloners[0]->updated.size());
+    ASSERT_EQ(1U, cloners[0]->deleted.size());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 7), cloners[0]->deleted[0]);
+
+    ASSERT_EQ(1U, cloners[1]->inserted.size());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 2 << "x" << 10), cloners[1]->inserted[0]);
+    ASSERT_EQ(1U, cloners[1]->updated.size());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 5 << "x" << 19), cloners[1]->updated[0]);
+    ASSERT_EQ(0U, cloners[1]->deleted.size());
+
+    ASSERT_EQ(1U, cloners[2]->inserted.size());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 4 << "x" << 39), cloners[2]->inserted[0]);
+    ASSERT_EQ(0U, cloners[2]->updated.size());
+    ASSERT_EQ(0U, cloners[2]->deleted.size());
+
+    ASSERT(!collShardingState.getMigrationSourceManagerForDocument(
+        txn(), BSON("_id" << 3 << "x" << 25)));
+
+    // Once a migration is cleared, the changes to its chunk are not reported to it anymore
+    collShardingState.clearMigrationSourceManager(txn(), sourceMgrs[1].get());
+    collShardingState.onInsertOp(txn(), BSON("_id" << 8 << "x" << 15));
+    ASSERT_EQ(1U, cloners[1]->inserted.size());
+
+    collShardingState.clearMigrationSourceManager(txn(), sourceMgrs[0].get());
+    collShardingState.clearMigrationSourceManager(txn(), sourceMgrs[2].get());
+    ASSERT(collShardingState.getMigrationSourceManagers().empty());
+}
+
+TEST_F(CollShardingStateTest, MigrationIsRejectedIfItWouldLeaveNoControlChunk) {
+    CollectionShardingState collShardingState(getServiceContext(), kMigratingNss);
+
+    const OID epoch = OID::gen();
+    auto metadata =
+        stdx::make_unique<CollectionMetadata>(BSON("x" << 1), ChunkVersion(1, 0, epoch));
+    metadata = metadata->clonePlusChunk(BSON("x" << 0), BSON("x" << 10), ChunkVersion(1, 1, epoch));
+    metadata =
+        metadata->clonePlusChunk(BSON("x" << 10), BSON("x" << 20), ChunkVersion(1, 2, epoch));
+    metadata =
+        metadata->clonePlusChunk(BSON("x" << 20), BSON("x" << 30), ChunkVersion(1, 3, epoch));
+    collShardingState.refreshMetadata(txn(), std::move(metadata));
+
+    std::vector<std::unique_ptr<MigrationSourceManager>> sourceMgrs;
+    for (const auto& range : {ChunkRange(BSON("x" << 0), BSON("x" << 10)),
+                              ChunkRange(BSON("x" << 10), BSON("x" << 20)),
+                              ChunkRange(BSON("x" << 20), BSON("x" << 30))}) {
+        sourceMgrs.push_back(MigrationSourceManager::createForTest(
+            makeMoveChunkRequest(range), stdx::make_unique<MigrationChunkClonerSourceMock>(range)));
+    }
+
+    ASSERT_OK(collShardingState.setMigrationSourceManager(txn(), sourceMgrs[0].get()));
+    ASSERT_OK(collShardingState.setMigrationSourceManager(txn(), sourceMgrs[1].get()));
+
+    // The third migration would leave no chunk, whose version the migrations can bump
+    ASSERT_EQ(ErrorCodes::ConflictingOperationInProgress,
+              collShardingState.setMigrationSourceManager(txn(), sourceMgrs[2].get()));
+    ASSERT_EQ(2U, collShardingState.getMigrationSourceManagers().size());
+
+    collShardingState.clearMigrationSourceManager(txn(), sourceMgrs[0].get());
+    collShardingState.clearMigrationSourceManager(txn(), sourceMgrs[1].get());
+}
+
 }  // unnamed namespace
 }  // namespace mongo
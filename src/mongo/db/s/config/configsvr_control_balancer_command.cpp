@@ -130,10 +130,22 @@ private:
     }
 };
 
+class ConfigSvrBalancerExplainCommand : public ConfigSvrBalancerControlCommand {
+public:
+    ConfigSvrBalancerExplainCommand()
+        : ConfigSvrBalancerControlCommand("_configsvrBalancerExplain") {}
+
+private:
+    void _run(OperationContext* txn, BSONObjBuilder* result) override {
+        uassertStatusOK(Balancer::get(txn)->explain(txn, result));
+    }
+};
+
 MONGO_INITIALIZER(ClusterBalancerControlCommands)(InitializerContext* context) {
     new ConfigSvrBalancerStartCommand();
     new ConfigSvrBalancerStopCommand();
     new ConfigSvrBalancerStatusCommand();
+    new ConfigSvrBalancerExplainCommand();
 
     return Status::OK();
 }
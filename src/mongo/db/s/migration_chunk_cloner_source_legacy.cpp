@@ -32,6 +32,10 @@
 
 #include "mongo/db/s/migration_chunk_cloner_source_legacy.h"
 
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
 #include "mongo/base/status.h"
 #include "mongo/client/read_preference.h"
 #include "mongo/db/concurrency/locker.h"
@@ -52,6 +56,7 @@
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
 #include "mongo/util/elapsed_tracker.h"
+#include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
@@ -81,6 +86,10 @@ BSONObj createRequestWithSessionId(StringData commandName,
     return builder.obj();
 }
 
+// Enabling this fail point pauses nextCloneBatch after it has claimed the record ids of a batch,
+// but before it has read any of the documents.
+MONGO_FP_DECLARE(migrateCloneHangAfterClaimingBatch);
+
 }  // namespace
 
 /**
@@ -409,11 +418,27 @@ Status MigrationChunkClonerSourceLegacy::nextCloneBatch(OperationContext* txn,
                            internalQueryExecYieldIterations,
                            Milliseconds(internalQueryExecYieldPeriodMS.load()));
 
-    stdx::lock_guard<stdx::mutex> sl(_mutex);
+    // Claim about as many record ids as are expected to fit in the batch, so that concurrent
+    // callers read disjoint sets of documents and do not hold the mutex while reading them
+    std::vector<RecordId> cloneLocs;
+    {
+        stdx::lock_guard<stdx::mutex> sl(_mutex);
 
-    std::set<RecordId>::iterator it;
+        const uint64_t bytesLeft =
+            BSONObjMaxUserSize - std::min(arrBuilder->len(), BSONObjMaxUserSize);
+        const std::size_t maxLocs =
+            bytesLeft / std::max(_averageObjectSizeForCloneLocs, static_cast<uint64_t>(1));
 
-    for (it = _cloneLocs.begin(); it != _cloneLocs.end(); ++it) {
+        auto end = _cloneLocs.begin();
+        std::advance(end, std::min(std::max(maxLocs, std::size_t(1)), _cloneLocs.size()));
+        cloneLocs.assign(_cloneLocs.begin(), end);
+        _cloneLocs.erase(_cloneLocs.begin(), end);
+    }
+
+    MONGO_FAIL_POINT_PAUSE_WHILE_SET(migrateCloneHangAfterClaimingBatch);
+
+    auto it = cloneLocs.begin();
+    for (; it != cloneLocs.end(); ++it) {
         // We must always make progress in this method by at least one document because empty return
         // indicates there is no more initial clone data.
         if (arrBuilder->arrSize() && tracker.intervalHasElapsed()) {
@@ -433,7 +458,12 @@ Status MigrationChunkClonerSourceLegacy::nextCloneBatch(OperationContext* txn,
         }
     }
 
-    _cloneLocs.erase(_cloneLocs.begin(), it);
+    // Give back the record ids which did not fit, so they are sent with a later batch. A document
+    // deleted in the meantime is not found then and its deletion is transferred as a mod.
+    if (it != cloneLocs.end()) {
+        stdx::lock_guard<stdx::mutex> sl(_mutex);
+        _cloneLocs.insert(it, cloneLocs.end());
+    }
 
     return Status::OK();
 }
@@ -104,7 +104,8 @@ public:
      *
      * This method will return early if too much time is spent fetching the documents in order to
      * give a chance to the caller to perform some form of yielding. It does not free or acquire any
-     * locks on its own.
+     * locks on its own. It may be called concurrently, in which case each caller receives a
+     * different set of documents.
      *
      * NOTE: Must be called with the collection lock held in at least IS mode.
      */
@@ -30,6 +30,8 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
+
 #include "mongo/db/auth/action_set.h"
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/authorization_manager.h"
@@ -37,10 +39,15 @@
 #include "mongo/db/auth/privilege.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/db_raii.h"
+#include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/migration_chunk_cloner_source_legacy.h"
 #include "mongo/db/s/migration_source_manager.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
 
 /**
  * This file contains commands, which are specific to the legacy chunk cloner source.
@@ -48,21 +55,138 @@
 namespace mongo {
 namespace {
 
+// Upper bound on the rate at which documents are served to the recipients of the initial clone,
+// across all migrations this shard is donating at the same time. Zero means unlimited.
+MONGO_EXPORT_SERVER_PARAMETER(migrateCloneMaxBytesPerSec, int, 0);
+
+// While the secondaries of this shard lag behind by more than this many seconds, the initial
+// clone is paused so that the migrations do not starve replication. Zero disables the check.
+MONGO_EXPORT_SERVER_PARAMETER(migrateCloneMaxReplicationLagSecs, int, 0);
+
+// Upper bound on how long a single clone batch is delayed because of replication lag, so that
+// migrations slow down, but never stall
+const Seconds kMaxReplicationLagWait(10);
+
+const Milliseconds kThrottleSleepInterval(100);
+
+/**
+ * Sleeps until the specified deadline, checking for interrupts regularly.
+ */
+void sleepUntil(OperationContext* txn, Date_t deadline) {
+    for (Date_t now = Date_t::now(); now < deadline; now = Date_t::now()) {
+        txn->checkForInterrupt();
+        sleepmillis(durationCount<Milliseconds>(std::min(deadline - now, kThrottleSleepInterval)));
+    }
+}
+
+/**
+ * Limits the rate at which the initial clone of all outgoing migrations reads documents.
+ */
+class CloneThrottle {
+    MONGO_DISALLOW_COPYING(CloneThrottle);
+
+public:
+    CloneThrottle() = default;
+
+    /**
+     * Accounts for 'numBytes' served by a clone batch and blocks the caller until serving them
+     * does not exceed migrateCloneMaxBytesPerSec any longer.
+     */
+    void throttle(OperationContext* txn, long long numBytes) {
+        const int maxBytesPerSec = migrateCloneMaxBytesPerSec.load();
+        if (maxBytesPerSec <= 0 || numBytes <= 0) {
+            return;
+        }
+
+        Date_t deadline;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _nextBatchTime = std::max(_nextBatchTime, Date_t::now()) +
+                Milliseconds(numBytes * 1000 / maxBytesPerSec);
+            deadline = _nextBatchTime;
+        }
+
+        sleepUntil(txn, deadline);
+    }
+
+private:
+    // Protects the state below
+    stdx::mutex _mutex;
+
+    // Time at which all the batches served so far will have been paid for at the configured rate
+    Date_t _nextBatchTime;
+};
+
+CloneThrottle cloneThrottle;
+
+/**
+ * Blocks the caller for up to kMaxReplicationLagWait while the majority commit point of this shard
+ * lags behind its last applied operation by more than migrateCloneMaxReplicationLagSecs.
+ */
+void waitForReplicationLag(OperationContext* txn) {
+    const int maxLagSecs = migrateCloneMaxReplicationLagSecs.load();
+    if (maxLagSecs <= 0) {
+        return;
+    }
+
+    auto replCoord = repl::ReplicationCoordinator::get(txn);
+    if (replCoord->getReplicationMode() != repl::ReplicationCoordinator::modeReplSet) {
+        return;
+    }
+
+    const Date_t deadline = Date_t::now() + kMaxReplicationLagWait;
+
+    while (true) {
+        const long long lagSecs = replCoord->getMyLastAppliedOpTime().getSecs() -
+            replCoord->getLastCommittedOpTime().getSecs();
+        if (lagSecs <= maxLagSecs) {
+            return;
+        }
+
+        if (Date_t::now() >= deadline) {
+            LOG(1) << "Continuing to clone chunk although replication lags behind by " << lagSecs
+                   << " seconds";
+            return;
+        }
+
+        sleepUntil(txn, Date_t::now() + kThrottleSleepInterval);
+    }
+}
+
 /**
  * Shortcut class to perform the appropriate checks and acquire the cloner associated with the
- * currently active migration. Uses the currently registered migration for this shard and ensures
- * the session ids match.
+ * active migration of the namespace, which the command names. Ensures a migration of that
+ * namespace is registered for this shard and picks the one, whose session id matches.
  */
 class AutoGetActiveCloner {
     MONGO_DISALLOW_COPYING(AutoGetActiveCloner);
 
 public:
-    AutoGetActiveCloner(OperationContext* txn, const MigrationSessionId& migrationSessionId)
+    AutoGetActiveCloner(OperationContext* txn,
+                        const BSONObj& cmdObj,
+                        const MigrationSessionId& migrationSessionId)
         : _scopedXact(txn, MODE_IS) {
         ShardingState* const gss = ShardingState::get(txn);
 
-        const auto nss = gss->getActiveDonateChunkNss();
-        uassert(ErrorCodes::NotYetInitialized, "No active migrations were found", nss);
+        const auto activeNss = gss->getActiveDonateChunkNss();
+        uassert(
+            ErrorCodes::NotYetInitialized, "No active migrations were found", !activeNss.empty());
+
+        // Recipients name the namespace being migrated, which is needed to tell apart concurrent
+        // migrations of different collections
+        boost::optional<NamespaceString> nss;
+        const BSONElement nssElem = cmdObj.firstElement();
+        if (nssElem.type() == String) {
+            const NamespaceString requestedNss(nssElem.valueStringData());
+            if (std::find(activeNss.begin(), activeNss.end(), requestedNss) != activeNss.end()) {
+                nss = requestedNss;
+            }
+        } else if (activeNss.size() == 1) {
+            nss = activeNss.front();
+        }
+        uassert(ErrorCodes::NotYetInitialized,
+                str::stream() << "No active migrations were found for " << nssElem,
+                nss);
 
         // Once the collection is locked, the migration status cannot change
         _autoColl.emplace(txn, *nss, MODE_IS);
@@ -74,19 +198,26 @@ public:
         auto css = CollectionShardingState::get(txn, *nss);
         uassert(ErrorCodes::IllegalOperation,
                 str::stream() << "No active migrations were found for collection " << nss->ns(),
-                css && css->getMigrationSourceManager());
-
-        // It is now safe to access the cloner
-        _chunkCloner = dynamic_cast<MigrationChunkClonerSourceLegacy*>(
-            css->getMigrationSourceManager()->getCloner());
-        invariant(_chunkCloner);
+                css && !css->getMigrationSourceManagers().empty());
+
+        // It is now safe to access the cloners. Several chunks of the collection may be migrating
+        // concurrently, so find the one, whose session id matches.
+        for (const auto sourceMgr : css->getMigrationSourceManagers()) {
+            auto chunkCloner =
+                dynamic_cast<MigrationChunkClonerSourceLegacy*>(sourceMgr->getCloner());
+            invariant(chunkCloner);
+
+            if (migrationSessionId.matches(chunkCloner->getSessionId())) {
+                _chunkCloner = chunkCloner;
+                break;
+            }
+        }
 
-        // Ensure the session ids are correct
         uassert(ErrorCodes::IllegalOperation,
                 str::stream() << "Requested migration session id " << migrationSessionId.toString()
-                              << " does not match active session id "
-                              << _chunkCloner->getSessionId().toString(),
-                migrationSessionId.matches(_chunkCloner->getSessionId()));
+                              << " does not match any active session id for collection "
+                              << nss->ns(),
+                _chunkCloner);
     }
 
     Database* getDb() const {
@@ -112,7 +243,7 @@ private:
     boost::optional<AutoGetCollection> _autoColl;
 
     // Contains the active cloner for the namespace
-    MigrationChunkClonerSourceLegacy* _chunkCloner;
+    MigrationChunkClonerSourceLegacy* _chunkCloner{nullptr};
 };
 
 class InitialCloneCommand : public Command {
@@ -152,6 +283,8 @@ public:
         const MigrationSessionId migrationSessionId(
             uassertStatusOK(MigrationSessionId::extractFromBSON(cmdObj)));
 
+        waitForReplicationLag(txn);
+
         boost::optional<BSONArrayBuilder> arrBuilder;
 
         // Try to maximize on the size of the buffer, which we are returning in order to have less
@@ -159,16 +292,25 @@ public:
         int arrSizeAtPrevIteration = -1;
 
         while (!arrBuilder || arrBuilder->arrSize() > arrSizeAtPrevIteration) {
-            AutoGetActiveCloner autoCloner(txn, migrationSessionId);
+            int lenAtPrevIteration = 0;
 
-            if (!arrBuilder) {
-                arrBuilder.emplace(autoCloner.getCloner()->getCloneBatchBufferAllocationSize());
-            }
+            {
+                AutoGetActiveCloner autoCloner(txn, cmdObj, migrationSessionId);
 
-            arrSizeAtPrevIteration = arrBuilder->arrSize();
+                if (!arrBuilder) {
+                    arrBuilder.emplace(
+                        autoCloner.getCloner()->getCloneBatchBufferAllocationSize());
+                }
+
+                arrSizeAtPrevIteration = arrBuilder->arrSize();
+                lenAtPrevIteration = arrBuilder->len();
+
+                uassertStatusOK(autoCloner.getCloner()->nextCloneBatch(
+                    txn, autoCloner.getColl(), arrBuilder.get_ptr()));
+            }
 
-            uassertStatusOK(autoCloner.getCloner()->nextCloneBatch(
-                txn, autoCloner.getColl(), arrBuilder.get_ptr()));
+            // Throttle without holding the collection lock
+            cloneThrottle.throttle(txn, arrBuilder->len() - lenAtPrevIteration);
         }
 
         invariant(arrBuilder);
@@ -216,7 +358,7 @@ public:
         const MigrationSessionId migrationSessionId(
             uassertStatusOK(MigrationSessionId::extractFromBSON(cmdObj)));
 
-        AutoGetActiveCloner autoCloner(txn, migrationSessionId);
+        AutoGetActiveCloner autoCloner(txn, cmdObj, migrationSessionId);
 
         uassertStatusOK(autoCloner.getCloner()->nextModsBatch(txn, autoCloner.getDb(), &result));
         return true;
@@ -32,6 +32,7 @@
 
 #include "mongo/db/s/migration_destination_manager.h"
 
+#include <algorithm>
 #include <list>
 #include <vector>
 
@@ -42,6 +43,7 @@
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/document_validation.h"
 #include "mongo/db/catalog/index_create.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/namespace_string.h"
@@ -56,6 +58,7 @@
 #include "mongo/db/s/move_timing_helper.h"
 #include "mongo/db/s/sharded_connection_info.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/mmap_v1/dur.h"
 #include "mongo/logger/ramlog.h"
@@ -65,6 +68,7 @@
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -75,6 +79,48 @@ namespace {
 
 Tee* migrateLog = RamLog::get("migrate");
 
+// Number of concurrent _migrateClone streams, each on its own connection to the donor, used for
+// the initial clone of a chunk. A single stream by default, since each additional one competes with
+// the recipient's own workload for the collection lock.
+MONGO_EXPORT_SERVER_PARAMETER(migrateCloneConcurrency, int, 1);
+
+// Bounds on the documents inserted under a single acquisition of the collection lock, so that the
+// clone lets the recipient's own operations in between the groups of a _migrateClone batch
+const size_t kMaxClonedDocsPerInsert = 100;
+const int kMaxClonedBytesPerInsert = 1024 * 1024;
+
+/**
+ * Inserts the specified cloned documents with a single batched insert through the collection. Falls
+ * back to one upsert per document if the collection is capped, because capped inserts are done
+ * one at a time, or if the batched insert fails, for example because a document with the same _id
+ * was left in the range by an earlier attempt to migrate it.
+ *
+ * Must be called with the collection X lock.
+ */
+void insertClonedDocuments(OperationContext* txn,
+                           const NamespaceString& nss,
+                           Collection* collection,
+                           const std::vector<BSONObj>& docs) {
+    if (collection && !collection->isCapped() && docs.size() > 1) {
+        try {
+            MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+                WriteUnitOfWork wuow(txn);
+                uassertStatusOK(collection->insertDocuments(
+                    txn, docs.begin(), docs.end(), nullptr, /*enforceQuota*/ true, true));
+                wuow.commit();
+            }
+            MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "migrateClone", nss.ns());
+            return;
+        } catch (const DBException&) {
+            // Nothing was inserted, so insert the documents one at a time below
+        }
+    }
+
+    for (const auto& doc : docs) {
+        Helpers::upsert(txn, nss.ns(), doc, true);
+    }
+}
+
 /**
  * Returns a human-readabale name of the migration manager's state.
  */
@@ -198,6 +244,9 @@ MONGO_FP_DECLARE(migrateThreadHangAtStep6);
 
 MONGO_FP_DECLARE(failMigrationReceivedOutOfRangeOperation);
 
+// Enabling this fail point makes a stream of the initial clone fail after it receives a batch
+MONGO_FP_DECLARE(failMigrateCloneStream);
+
 }  // namespace
 
 MigrationDestinationManager::MigrationDestinationManager() = default;
@@ -626,85 +675,81 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* txn,
         // 3. Initial bulk clone
         setState(CLONE);
 
-        const BSONObj migrateCloneRequest = createMigrateCloneRequest(_nss, *_sessionId);
-
-        while (true) {
-            BSONObj res;
-            if (!conn->runCommand("admin",
-                                  migrateCloneRequest,
-                                  res)) {  // gets array of objects to copy, in disk order
-                setState(FAIL);
-                errmsg = "_migrateClone failed: ";
-                errmsg += redact(res.toString());
-                error() << errmsg << migrateLog;
-                conn.done();
-                return;
+        // The first stream runs on this thread and the others on threads of their own
+        const int numStreams = std::max(1, migrateCloneConcurrency.load());
+        std::vector<Status> streamStatuses(numStreams, Status::OK());
+        std::vector<repl::OpTime> streamLastOps(numStreams);
+        std::vector<stdx::thread> streamThreads;
+        auto joinStreams = MakeGuard([&] {
+            for (auto&& thread : streamThreads) {
+                thread.join();
             }
+        });
 
-            BSONObj arr = res["objects"].Obj();
-            int thisTime = 0;
-
-            BSONObjIterator i(arr);
-            while (i.more()) {
-                txn->checkForInterrupt();
+        for (int i = 1; i < numStreams; i++) {
+            streamThreads.emplace_back([&, i] {
+                const std::string threadName = str::stream() << "migrateCloneThread-" << i;
+                Client::initThread(threadName.c_str());
+                auto opCtx = getGlobalServiceContext()->makeOperationContext(&cc());
 
-                if (getState() == ABORT) {
-                    errmsg = "Migration aborted while copying documents";
-                    error() << errmsg << migrateLog;
-                    return;
+                if (getGlobalAuthorizationManager()->isAuthEnabled()) {
+                    AuthorizationSession::get(opCtx->getClient())->grantInternalAuthorization();
                 }
 
-                BSONObj docToClone = i.next().Obj();
-                {
-                    OldClientWriteContext cx(txn, _nss.ns());
-
-                    BSONObj localDoc;
-                    if (willOverrideLocalId(txn,
-                                            _nss.ns(),
-                                            min,
-                                            max,
-                                            shardKeyPattern,
-                                            cx.db(),
-                                            docToClone,
-                                            &localDoc)) {
-                        string errMsg = str::stream() << "cannot migrate chunk, local document "
-                                                      << redact(localDoc)
-                                                      << " has same _id as cloned "
-                                                      << "remote document " << redact(docToClone);
-
-                        warning() << errMsg;
+                DisableDocumentValidation validationDisabler(opCtx.get());
+                streamStatuses[i] = _cloneDocuments(opCtx.get(),
+                                                    min,
+                                                    max,
+                                                    shardKeyPattern,
+                                                    fromShardConnString,
+                                                    writeConcern,
+                                                    &streamLastOps[i]);
+            });
+        }
 
-                        // Exception will abort migration cleanly
-                        uasserted(16976, errMsg);
-                    }
+        streamStatuses[0] = _cloneDocuments(
+            txn, min, max, shardKeyPattern, fromShardConnString, writeConcern, &streamLastOps[0]);
 
-                    Helpers::upsert(txn, _nss.ns(), docToClone, true);
-                }
-                thisTime++;
+        joinStreams.Dismiss();
+        for (auto&& thread : streamThreads) {
+            thread.join();
+        }
 
-                {
-                    stdx::lock_guard<stdx::mutex> statsLock(_mutex);
-                    _numCloned++;
-                    _clonedBytes += docToClone.objsize();
-                }
+        if (getState() == ABORT) {
+            errmsg = "Migration aborted while copying documents";
+            error() << errmsg << migrateLog;
+            return;
+        }
 
-                if (writeConcern.shouldWaitForOtherNodes()) {
-                    repl::ReplicationCoordinator::StatusAndDuration replStatus =
-                        repl::getGlobalReplicationCoordinator()->awaitReplication(
-                            txn,
-                            repl::ReplClientInfo::forClient(txn->getClient()).getLastOp(),
-                            writeConcern);
-                    if (replStatus.status.code() == ErrorCodes::WriteConcernFailed) {
-                        warning() << "secondaryThrottle on, but doc insert timed out; "
-                                     "continuing";
-                    } else {
-                        massertStatusOK(replStatus.status);
-                    }
-                }
+        // Report the stream which failed first rather than the ones it stopped
+        auto failedStream =
+            std::find_if(streamStatuses.begin(), streamStatuses.end(), [](const Status& status) {
+                return !status.isOK() && status != ErrorCodes::CallbackCanceled;
+            });
+        if (failedStream == streamStatuses.end()) {
+            failedStream = std::find_if(streamStatuses.begin(),
+                                        streamStatuses.end(),
+                                        [](const Status& status) { return !status.isOK(); });
+        }
+        if (failedStream != streamStatuses.end()) {
+            errmsg = failedStream->toString();
+            {
+                stdx::lock_guard<stdx::mutex> sl(_mutex);
+                _state = FAIL;
+                _errmsg = errmsg;
             }
+            error() << "Initial clone failed: " << redact(errmsg) << migrateLog;
+            conn.done();
+            return;
+        }
 
-            if (thisTime == 0)
-                break;
+        // The cloned documents must be replicated before entering the critical section, including
+        // the ones written by the other streams
+        auto& replClientInfo = repl::ReplClientInfo::forClient(txn->getClient());
+        for (auto&& streamLastOp : streamLastOps) {
+            if (streamLastOp > replClientInfo.getLastOp()) {
+                replClientInfo.setLastOp(streamLastOp);
+            }
         }
 
         timing.done(3);
@@ -871,6 +916,139 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* txn,
     conn.done();
 }
 
+Status MigrationDestinationManager::_cloneDocuments(OperationContext* txn,
+                                                    const BSONObj& min,
+                                                    const BSONObj& max,
+                                                    const BSONObj& shardKeyPattern,
+                                                    const ConnectionString& fromShardConnString,
+                                                    const WriteConcernOptions& writeConcern,
+                                                    repl::OpTime* lastOpApplied) {
+    // Only the first stream to fail moves the migration out of CLONE. The streams, which fail
+    // afterwards, were most likely stopped by it, so they do not report a failure of their own.
+    auto failClone = [&](Status status) {
+        stdx::lock_guard<stdx::mutex> sl(_mutex);
+        if (_state != CLONE) {
+            return Status(ErrorCodes::CallbackCanceled,
+                          str::stream() << "Stopped copying documents because the migration is "
+                                           "no longer cloning: "
+                                        << status.toString());
+        }
+
+        _state = FAIL;
+        return status;
+    };
+
+    try {
+        ScopedDbConnection conn(fromShardConnString);
+
+        const BSONObj migrateCloneRequest = createMigrateCloneRequest(_nss, *_sessionId);
+
+        while (true) {
+            BSONObj res;
+            if (!conn->runCommand("admin",
+                                  migrateCloneRequest,
+                                  res)) {  // gets array of objects to copy, in disk order
+                conn.done();
+                return failClone({ErrorCodes::OperationFailed,
+                                  str::stream() << "_migrateClone failed: " << redact(res)});
+            }
+
+            BSONObj arr = res["objects"].Obj();
+            if (arr.isEmpty()) {
+                break;
+            }
+
+            if (MONGO_FAIL_POINT(failMigrateCloneStream)) {
+                conn.done();
+                return failClone({ErrorCodes::InternalError,
+                                  "Failing the clone stream due to failpoint."});
+            }
+
+            // Insert the batch in groups, each under its own acquisition of the collection lock
+            long long batchNumCloned = 0;
+            long long batchClonedBytes = 0;
+
+            BSONObjIterator i(arr);
+            while (i.more()) {
+                std::vector<BSONObj> docsToClone;
+                int groupBytes = 0;
+                while (i.more() && docsToClone.size() < kMaxClonedDocsPerInsert &&
+                       groupBytes < kMaxClonedBytesPerInsert) {
+                    docsToClone.push_back(i.next().Obj());
+                    groupBytes += docsToClone.back().objsize();
+                }
+
+                txn->checkForInterrupt();
+
+                if (getState() != CLONE) {
+                    // The whole response has been read, so the connection may be reused
+                    conn.done();
+                    return {ErrorCodes::CallbackCanceled,
+                            "Stopped copying documents because the migration is no longer "
+                            "cloning"};
+                }
+
+                OldClientWriteContext cx(txn, _nss.ns());
+
+                for (const auto& docToClone : docsToClone) {
+                    BSONObj localDoc;
+                    if (willOverrideLocalId(txn,
+                                            _nss.ns(),
+                                            min,
+                                            max,
+                                            shardKeyPattern,
+                                            cx.db(),
+                                            docToClone,
+                                            &localDoc)) {
+                        string errMsg = str::stream() << "cannot migrate chunk, local document "
+                                                      << redact(localDoc)
+                                                      << " has same _id as cloned "
+                                                      << "remote document " << redact(docToClone);
+
+                        warning() << errMsg;
+
+                        // Exception will abort migration cleanly
+                        uasserted(16976, errMsg);
+                    }
+                }
+
+                insertClonedDocuments(txn, _nss, cx.getCollection(), docsToClone);
+
+                batchNumCloned += docsToClone.size();
+                batchClonedBytes += groupBytes;
+            }
+
+            {
+                stdx::lock_guard<stdx::mutex> statsLock(_mutex);
+                _numCloned += batchNumCloned;
+                _clonedBytes += batchClonedBytes;
+            }
+
+            // Throttle once per batch rather than once per document
+            if (writeConcern.shouldWaitForOtherNodes()) {
+                repl::ReplicationCoordinator::StatusAndDuration replStatus =
+                    repl::getGlobalReplicationCoordinator()->awaitReplication(
+                        txn,
+                        repl::ReplClientInfo::forClient(txn->getClient()).getLastOp(),
+                        writeConcern);
+                if (replStatus.status.code() == ErrorCodes::WriteConcernFailed) {
+                    warning() << "secondaryThrottle on, but doc insert timed out; "
+                                 "continuing";
+                } else {
+                    massertStatusOK(replStatus.status);
+                }
+            }
+        }
+
+        conn.done();
+    } catch (const DBException& ex) {
+        return failClone(ex.toStatus());
+    }
+
+    *lastOpApplied = repl::ReplClientInfo::forClient(txn->getClient()).getLastOp();
+    return Status::OK();
+}
+
 bool MigrationDestinationManager::_applyMigrateOp(OperationContext* txn,
                                                   const string& ns,
                                                   const BSONObj& min,
@@ -134,6 +134,24 @@ private:
                         const OID& epoch,
                         const WriteConcernOptions& writeConcern);
 
+    /**
+     * One stream of the initial clone. Pulls batches of documents from the donor through
+     * _migrateClone on its own connection and inserts each batch in bounded groups, releasing the
+     * collection lock in between, until the donor has no more documents to hand out. Several
+     * streams run concurrently and the donor gives each of them a disjoint set of documents.
+     * Sets 'lastOpApplied' to the optime of the last write done.
+     *
+     * Returns a failed status and moves the migration from the CLONE state to FAIL if the stream
+     * could not complete, which also stops the other streams.
+     */
+    Status _cloneDocuments(OperationContext* txn,
+                           const BSONObj& min,
+                           const BSONObj& max,
+                           const BSONObj& shardKeyPattern,
+                           const ConnectionString& fromShardConnString,
+                           const WriteConcernOptions& writeConcern,
+                           repl::OpTime* lastOpApplied);
+
     bool _applyMigrateOp(OperationContext* txn,
                          const std::string& ns,
                          const BSONObj& min,
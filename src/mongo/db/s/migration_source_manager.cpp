@@ -50,6 +50,7 @@
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/s/stale_exception.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/elapsed_tracker.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
@@ -164,14 +165,32 @@ MigrationSourceManager::MigrationSourceManager(OperationContext* txn,
     }
 }
 
+MigrationSourceManager::MigrationSourceManager(MoveChunkRequest request,
+                                               std::unique_ptr<MigrationChunkClonerSource> cloner)
+    : _args(std::move(request)),
+      _startTime(),
+      _state(kCloning),
+      _cloneDriver(std::move(cloner)),
+      _isForTest(true) {}
+
 MigrationSourceManager::~MigrationSourceManager() {
-    invariant(!_cloneDriver);
+    invariant(!_cloneDriver || _isForTest);
+}
+
+std::unique_ptr<MigrationSourceManager> MigrationSourceManager::createForTest(
+    MoveChunkRequest request, std::unique_ptr<MigrationChunkClonerSource> cloner) {
+    return std::unique_ptr<MigrationSourceManager>(
+        new MigrationSourceManager(std::move(request), std::move(cloner)));
 }
 
 NamespaceString MigrationSourceManager::getNss() const {
     return _args.getNss();
 }
 
+ChunkRange MigrationSourceManager::getChunkRange() const {
+    return ChunkRange(_args.getMinKey(), _args.getMaxKey());
+}
+
 Status MigrationSourceManager::startClone(OperationContext* txn) {
     invariant(!txn->lockState()->isLocked());
     invariant(_state == kCreated);
@@ -196,7 +215,14 @@ Status MigrationSourceManager::startClone(OperationContext* txn) {
         AutoGetCollection autoColl(txn, getNss(), MODE_IX, MODE_X);
 
         auto css = CollectionShardingState::get(txn, getNss().ns());
-        css->setMigrationSourceManager(txn, this);
+        Status registerStatus = css->setMigrationSourceManager(txn, this);
+        if (!registerStatus.isOK()) {
+            // Not registered, so there is nothing to unregister and the cloner never started
+            _cloneDriver.reset();
+            _state = kDone;
+            scopedGuard.Dismiss();
+            return registerStatus;
+        }
     }
 
     Status startCloneStatus = _cloneDriver->startClone(txn);
@@ -247,7 +273,7 @@ Status MigrationSourceManager::enterCriticalSection(OperationContext* txn) {
         auto css = CollectionShardingState::get(txn, getNss().ns());
         auto metadata = css->getMetadata();
         if (!metadata ||
-            !metadata->getCollVersion().equals(_collectionMetadata->getCollVersion())) {
+            metadata->getCollVersion().epoch() != _collectionMetadata->getCollVersion().epoch()) {
             return {ErrorCodes::IncompatibleShardingMetadata,
                     str::stream()
                         << "Sharding metadata changed while holding distributed lock. Expected: "
@@ -257,6 +283,21 @@ Status MigrationSourceManager::enterCriticalSection(OperationContext* txn) {
                                      : "unsharded collection.")};
         }
 
+        // Other chunks of the collection may have been migrated off this shard concurrently, which
+        // changes the collection version, but the chunk being migrated must still be owned intact
+        ChunkType chunkToMove;
+        chunkToMove.setMin(_args.getMinKey());
+        chunkToMove.setMax(_args.getMaxKey());
+
+        Status chunkValidateStatus = metadata->checkChunkIsValid(chunkToMove);
+        if (!chunkValidateStatus.isOK()) {
+            return {chunkValidateStatus.code(),
+                    str::stream() << "Sharding metadata changed while holding distributed lock. "
+                                  << chunkValidateStatus.reason()};
+        }
+
+        _collectionMetadata = std::move(metadata);
+
         // IMPORTANT: After this line, the critical section is in place and needs to be signaled
         _critSecSignal = std::make_shared<Notification<void>>();
     }
@@ -296,6 +337,19 @@ Status MigrationSourceManager::commitChunkMetadataOnConfig(OperationContext* txn
     invariant(_state == kCloneCompleted);
     auto scopedGuard = MakeGuard([&] { cleanupOnError(txn); });
 
+    // Serialize with the commits of the concurrent migrations of this collection's other chunks,
+    // so the control chunk is chosen from metadata, which reflects them. The collection's sharding
+    // state is never destroyed, so its mutex may be used after the collection lock is released.
+    stdx::mutex* commitMutex;
+    {
+        ScopedTransaction scopedXact(txn, MODE_IS);
+        AutoGetCollection autoColl(txn, getNss(), MODE_IS);
+
+        commitMutex = &CollectionShardingState::get(txn, getNss())->getMigrationCommitMutex();
+    }
+
+    stdx::unique_lock<stdx::mutex> commitLock(*commitMutex);
+
     ChunkType migratedChunkType;
     migratedChunkType.setMin(_args.getMinKey());
     migratedChunkType.setMax(_args.getMaxKey());
@@ -303,13 +357,54 @@ Status MigrationSourceManager::commitChunkMetadataOnConfig(OperationContext* txn
     // If we have chunks left on the FROM shard, bump the version of one of them as well. This will
     // change the local collection major version, which indicates to other processes that the chunk
     // metadata has changed and they should refresh.
+    //
+    // Other chunks of the collection may be migrating off this shard concurrently, so prefer a
+    // control chunk, which none of them is moving, in order not to bump the version of a chunk,
+    // which is about to leave.
     boost::optional<ChunkType> controlChunkType = boost::none;
-    if (_collectionMetadata->getNumChunks() > 1) {
-        ChunkType differentChunk;
-        invariant(_collectionMetadata->getDifferentChunk(_args.getMinKey(), &differentChunk));
-        invariant(differentChunk.getMin().woCompare(_args.getMinKey()) != 0);
-        controlChunkType = std::move(differentChunk);
-    } else {
+    {
+        ScopedTransaction scopedXact(txn, MODE_IS);
+        AutoGetCollection autoColl(txn, getNss(), MODE_IS);
+
+        auto css = CollectionShardingState::get(txn, getNss());
+
+        // Pick up the chunks migrated off this shard after the critical section was entered
+        auto metadata = css->getMetadata();
+        if (metadata && metadata->getCollVersion().epoch() ==
+                            _collectionMetadata->getCollVersion().epoch()) {
+            _collectionMetadata = std::move(metadata);
+        }
+
+        const auto isMigrating = [&](const BSONObj& minKey, const BSONObj& maxKey) {
+            for (const auto sourceMgr : css->getMigrationSourceManagers()) {
+                const ChunkRange range = sourceMgr->getChunkRange();
+                if (rangeOverlaps(minKey, maxKey, range.getMin(), range.getMax())) {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        for (const auto& chunkEntry : _collectionMetadata->getChunks()) {
+            if (!isMigrating(chunkEntry.first, chunkEntry.second.getMaxKey())) {
+                ChunkType differentChunk;
+                differentChunk.setMin(chunkEntry.first);
+                differentChunk.setMax(chunkEntry.second.getMaxKey());
+                differentChunk.setVersion(chunkEntry.second.getVersion());
+                controlChunkType = std::move(differentChunk);
+                break;
+            }
+        }
+    }
+
+    if (!controlChunkType && _collectionMetadata->getNumChunks() > 1) {
+        // Registration leaves a chunk outside of all active migrations, so this is not expected.
+        // Never bump the version of a chunk, which another migration is moving.
+        return {ErrorCodes::ConflictingOperationInProgress,
+                str::stream() << "Cannot commit the migration of chunk "
+                              << redact(getChunkRange().toString()) << " of " << getNss().ns()
+                              << ", because all the other chunks on this shard are migrating"};
+    } else if (!controlChunkType) {
         log() << "Moving last chunk for the collection out";
     }
 
@@ -409,6 +504,8 @@ Status MigrationSourceManager::commitChunkMetadataOnConfig(OperationContext* txn
         // Migration succeeded
         log() << "Migration succeeded and updated collection version to "
               << refreshedMetadata->getCollVersion();
+
+        commitLock.unlock();
     } else {
         ScopedTransaction scopedXact(txn, MODE_IX);
         AutoGetCollection autoColl(txn, getNss(), MODE_IX, MODE_X);
@@ -473,7 +570,7 @@ void MigrationSourceManager::_cleanup(OperationContext* txn) {
 
         // The migration source manager is not visible anymore after it is unregistered from the
         // collection
-        css->clearMigrationSourceManager(txn);
+        css->clearMigrationSourceManager(txn, this);
 
         // Leave the critical section.
         if (_critSecSignal) {
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "mongo/base/disallow_copying.h"
@@ -75,8 +76,9 @@ public:
      * Instantiates a new migration source manager with the specified migration parameters. Must be
      * called with the distributed lock acquired in advance (not asserted).
      *
-     * Loads the most up-to-date collection metadata and uses it as a starting point. It is assumed
-     * that because of the distributed lock, the collection's metadata will not change further.
+     * Loads the most up-to-date collection metadata and uses it as a starting point. Because of the
+     * distributed lock, the collection's metadata may only change further through concurrent
+     * migrations of other chunks off this shard.
      *
      * May throw any exception. Known exceptions are:
      *  - InvalidOptions if the operation context is missing shard version
@@ -89,11 +91,24 @@ public:
                            HostAndPort recipientHost);
     ~MigrationSourceManager();
 
+    /**
+     * Instantiates a migration source manager in the clone phase, which uses the specified cloner,
+     * without contacting any other nodes. For unit tests of the components, which the migration
+     * source manager interacts with, only.
+     */
+    static std::unique_ptr<MigrationSourceManager> createForTest(
+        MoveChunkRequest request, std::unique_ptr<MigrationChunkClonerSource> cloner);
+
     /**
      * Returns the namespace for which this source manager is active.
      */
     NamespaceString getNss() const;
 
+    /**
+     * Returns the bounds of the chunk, which is being migrated.
+     */
+    ChunkRange getChunkRange() const;
+
     /**
      * Contacts the donor shard and tells it to start cloning the specified chunk. This method will
      * fail if for any reason the donor shard fails to initiate the cloning sequence.
@@ -196,6 +211,9 @@ private:
     // comments explaining the various state transitions.
     enum State { kCreated, kCloning, kCloneCaughtUp, kCriticalSection, kCloneCompleted, kDone };
 
+    MigrationSourceManager(MoveChunkRequest request,
+                           std::unique_ptr<MigrationChunkClonerSource> cloner);
+
     /**
      * Called when any of the states fails. May only be called once and will put the migration
      * manager into the kDone state.
@@ -233,6 +251,10 @@ private:
     // callers don't have to hold collection lock in order to wait on it. Available after the
     // critical section stage has completed.
     std::shared_ptr<Notification<void>> _critSecSignal;
+
+    // Whether this instance was created through createForTest, in which case it may be destroyed
+    // without going through the migration states
+    const bool _isForTest{false};
 };
 
 }  // namespace mongo
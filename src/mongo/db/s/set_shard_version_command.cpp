@@ -253,15 +253,12 @@ public:
                 // TODO: Refactor all of this
                 if (requestedVersion < collectionShardVersion &&
                     requestedVersion.epoch() == collectionShardVersion.epoch()) {
-                    if (css->getMigrationSourceManager()) {
-                        auto critSecSignal =
-                            css->getMigrationSourceManager()->getMigrationCriticalSectionSignal();
-                        if (critSecSignal) {
-                            collLock.reset();
-                            autoDb.reset();
-                            log() << "waiting till out of critical section";
-                            critSecSignal->waitFor(txn, Seconds(10));
-                        }
+                    auto critSecSignal = css->getMigrationCriticalSectionSignal();
+                    if (critSecSignal) {
+                        collLock.reset();
+                        autoDb.reset();
+                        log() << "waiting till out of critical section";
+                        critSecSignal->waitFor(txn, Seconds(10));
                     }
 
                     errmsg = str::stream() << "shard global version for collection is higher "
@@ -276,15 +273,12 @@ public:
                 if (!collectionShardVersion.isSet() && !authoritative) {
                     // Needed b/c when the last chunk is moved off a shard, the version gets reset
                     // to zero, which should require a reload.
-                    if (css->getMigrationSourceManager()) {
-                        auto critSecSignal =
-                            css->getMigrationSourceManager()->getMigrationCriticalSectionSignal();
-                        if (critSecSignal) {
-                            collLock.reset();
-                            autoDb.reset();
-                            log() << "waiting till out of critical section";
-                            critSecSignal->waitFor(txn, Seconds(10));
-                        }
+                    auto critSecSignal = css->getMigrationCriticalSectionSignal();
+                    if (critSecSignal) {
+                        collLock.reset();
+                        autoDb.reset();
+                        log() << "waiting till out of critical section";
+                        critSecSignal->waitFor(txn, Seconds(10));
                     }
 
                     // need authoritative for first look
@@ -56,12 +56,20 @@ public:
 
             Grid::get(txn)->configOpTime().append(&result, "lastSeenConfigServerOpTime");
 
-            // Get a migration status report if a migration is active for which this is the source
-            // shard. ShardingState::getActiveMigrationStatusReport will take an IS lock on the
-            // namespace of the active migration if there is one that is active.
-            BSONObj migrationStatus = ShardingState::get(txn)->getActiveMigrationStatusReport(txn);
-            if (!migrationStatus.isEmpty()) {
-                result.append("migrations", migrationStatus);
+            // Get a status report of each active migration for which this is the source shard.
+            // ShardingState::getActiveMigrationStatusReports will take an IS lock on the namespace
+            // of each active migration. The longest running one is also reported as 'migrations'
+            // for compatibility with the time when a shard could only donate one chunk at a time.
+            const auto migrationStatuses =
+                ShardingState::get(txn)->getActiveMigrationStatusReports(txn);
+            if (!migrationStatuses.empty()) {
+                result.append("migrations", migrationStatuses.front());
+
+                BSONArrayBuilder activeMigrationsBuilder(result.subarrayStart("activeMigrations"));
+                for (const auto& migrationStatus : migrationStatuses) {
+                    activeMigrationsBuilder.append(migrationStatus);
+                }
+                activeMigrationsBuilder.doneFast();
             }
         }
 
@@ -730,12 +730,12 @@ StatusWith<ScopedRegisterReceiveChunk> ShardingState::registerReceiveChunk(
     return _activeMigrationsRegistry.registerReceiveChunk(nss, chunkRange, fromShardId);
 }
 
-boost::optional<NamespaceString> ShardingState::getActiveDonateChunkNss() {
+std::vector<NamespaceString> ShardingState::getActiveDonateChunkNss() {
     return _activeMigrationsRegistry.getActiveDonateChunkNss();
 }
 
-BSONObj ShardingState::getActiveMigrationStatusReport(OperationContext* txn) {
-    return _activeMigrationsRegistry.getActiveMigrationStatusReport(txn);
+std::vector<BSONObj> ShardingState::getActiveMigrationStatusReports(OperationContext* txn) {
+    return _activeMigrationsRegistry.getActiveMigrationStatusReports(txn);
 }
 
 void ShardingState::appendInfo(OperationContext* txn, BSONObjBuilder& builder) {
@@ -192,9 +192,9 @@ public:
                                            const std::string& newConnectionString);
 
     /**
-     * If there are no migrations running on this shard, registers an active migration with the
-     * specified arguments and returns a ScopedRegisterDonateChunk, which must be signaled by the
-     * caller before it goes out of scope.
+     * If this shard is not receiving a chunk and has room for another outgoing migration for the
+     * collection, registers an active migration with the specified arguments and returns a
+     * ScopedRegisterDonateChunk, which must be signaled by the caller before it goes out of scope.
      *
      * If there is an active migration already running on this shard and it has the exact same
      * arguments, returns a ScopedRegisterDonateChunk, which can be used to join the existing one.
@@ -215,21 +215,21 @@ public:
                                                                 const ShardId& fromShardId);
 
     /**
-     * If a migration has been previously registered through a call to registerDonateChunk returns
-     * that namespace. Otherwise returns boost::none.
+     * Returns the namespaces of the migrations, which have been previously registered through a
+     * call to registerDonateChunk and are still active.
      *
-     * This method can be called without any locks, but once the namespace is fetched it needs to be
+     * This method can be called without any locks, but once a namespace is fetched it needs to be
      * re-checked after acquiring some intent lock on that namespace.
      */
-    boost::optional<NamespaceString> getActiveDonateChunkNss();
+    std::vector<NamespaceString> getActiveDonateChunkNss();
 
     /**
-     * Get a migration status report from the migration registry. If no migration is active, this
-     * returns an empty BSONObj.
+     * Get a status report of each active migration from the migration registry, starting with the
+     * longest running one. If no migration is active, this returns an empty vector.
      *
-     * Takes an IS lock on the namespace of the active migration, if one is active.
+     * Takes an IS lock on the namespace of each active migration in turn.
      */
-    BSONObj getActiveMigrationStatusReport(OperationContext* txn);
+    std::vector<BSONObj> getActiveMigrationStatusReports(OperationContext* txn);
 
     /**
      * For testing only. Mock the initialization method used by initializeFromConfigConnString and
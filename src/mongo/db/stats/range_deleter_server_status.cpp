@@ -28,6 +28,7 @@
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/commands/server_status.h"
+#include "mongo/db/range_deletion_pacer.h"
 #include "mongo/db/range_deleter_service.h"
 
 namespace mongo {
@@ -48,7 +49,19 @@ namespace mongo {
  *       waitForReplStart: ISODate("2014-06-11T22:45:30.221Z"),
  *       waitForReplEnd: ISODate("2014-06-11T22:45:30.221Z")
  *     }
- *   ]
+ *   ],
+ *   namespaces: {
+ *     "test.user": {
+ *       activeDeletions: 1,
+ *       deletedDocs: NumberLong(5000),
+ *       deletedBytes: NumberLong(640000),
+ *       batches: NumberLong(42),
+ *       backoffs: NumberLong(3),
+ *       waitForReplMillis: NumberLong(1200),
+ *       batchSize: 128,
+ *       lastBatch: ISODate("2014-06-11T22:45:30.221Z")
+ *     }
+ *   }
  * }
  */
 class RangeDeleterServerStatusSection : public ServerStatusSection {
@@ -94,6 +107,10 @@ public:
         }
         result.append("lastDeleteStats", oldStatsBuilder.arr());
 
+        BSONObjBuilder namespacesBuilder(result.subobjStart("namespaces"));
+        RangeDeletionPacer::appendProgress(&namespacesBuilder);
+        namespacesBuilder.doneFast();
+
         return result.obj();
     }
 
@@ -35,6 +35,7 @@
 #include "mongo/db/storage/key_string.h"
 
 #include <cmath>
+#include <cstring>
 #include <type_traits>
 
 #include "mongo/base/data_view.h"
@@ -229,10 +230,25 @@ const uint8_t kGreater = 254;
 
 // some utility functions
 namespace {
+/**
+ * Copies 'bytes' bytes from 'src' to 'dst', inverting every bit. Used for the descending fields of
+ * an index, which are dominated by strings, so the bulk of the input is processed a machine word
+ * at a time. The trailing bytes are handled one at a time.
+ */
 void memcpy_flipBits(void* dst, const void* src, size_t bytes) {
     const char* input = static_cast<const char*>(src);
     char* output = static_cast<char*>(dst);
     const char* const end = input + bytes;
+
+    while (end - input >= static_cast<std::ptrdiff_t>(sizeof(uint64_t))) {
+        uint64_t word;
+        std::memcpy(&word, input, sizeof(word));
+        word = ~word;
+        std::memcpy(output, &word, sizeof(word));
+        input += sizeof(word);
+        output += sizeof(word);
+    }
+
     while (input != end) {
         *output++ = ~(*input++);
     }
@@ -284,10 +300,8 @@ string readInvertedCString(BufReader* reader) {
     const char* end = static_cast<const char*>(memchr(start, 0xFF, reader->remaining()));
     invariant(end);
     size_t actualBytes = end - start;
-    string s(start, actualBytes);
-    for (size_t i = 0; i < s.size(); i++) {
-        s[i] = ~s[i];
-    }
+    string s(actualBytes, '\0');
+    memcpy_flipBits(&s[0], start, actualBytes);
     reader->skip(1 + actualBytes);
     return s;
 }
@@ -314,10 +328,7 @@ string readInvertedCStringWithNuls(BufReader* reader) {
         reader->skip(1 + actualBytes);
     } while (reader->peek<unsigned char>() == 0x00);
 
-    for (size_t i = 0; i < out.size(); i++) {
-        out[i] = ~out[i];
-    }
-
+    memcpy_flipBits(&out[0], out.data(), out.size());
     return out;
 }
 }  // namespace
@@ -858,13 +869,21 @@ void KeyString::_appendBsonValue(const BSONElement& elem, bool invert, const Str
 void KeyString::_appendStringLike(StringData str, bool invert) {
     while (true) {
         size_t firstNul = strnlen(str.rawData(), str.size());
-        // No NULs in string.
-        _appendBytes(str.rawData(), firstNul, invert);
         if (firstNul == str.size() || firstNul == std::string::npos) {
-            _append(int8_t(0), invert);
+            // No NULs in the rest of the string, so copy it and the terminator in a single step.
+            char* const base = _buffer.skip(str.size() + 1);
+            if (invert) {
+                memcpy_flipBits(base, str.rawData(), str.size());
+                base[str.size()] = ~int8_t(0);
+            } else {
+                memcpy(base, str.rawData(), str.size());
+                base[str.size()] = int8_t(0);
+            }
             break;
         }
 
+        _appendBytes(str.rawData(), firstNul, invert);
+
         // replace "\x00" with "\x00\xFF"
         _appendBytes("\x00\xFF", 2, invert);
         str = str.substr(firstNul + 1);  // skip over the NUL byte
@@ -1047,14 +1066,20 @@ void KeyString::_appendPreshiftedIntegerPortion(uint64_t value, bool isNegative,
 
     // Append the low bytes of value in big endian order.
     value = endian::nativeToBig(value);
-    const void* firstUsedByte = reinterpret_cast<const char*>((&value) + 1) - bytesNeeded;
-
-    if (isNegative) {
-        _append(uint8_t(CType::kNumericNegative1ByteInt - (bytesNeeded - 1)), invert);
-        _appendBytes(firstUsedByte, bytesNeeded, !invert);
+    const char* firstUsedByte = reinterpret_cast<const char*>((&value) + 1) - bytesNeeded;
+
+    // Reserve space for the ctype and the value at once, since this is on the path of every
+    // integer and most doubles.
+    char* const base = _buffer.skip(1 + bytesNeeded);
+    const uint8_t ctype = isNegative ? uint8_t(CType::kNumericNegative1ByteInt - (bytesNeeded - 1))
+                                     : uint8_t(CType::kNumericPositive1ByteInt + (bytesNeeded - 1));
+    base[0] = invert ? ~ctype : ctype;
+
+    // The magnitude of negative numbers is stored inverted so that larger magnitudes sort first.
+    if (isNegative != invert) {
+        memcpy_flipBits(base + 1, firstUsedByte, bytesNeeded);
     } else {
-        _append(uint8_t(CType::kNumericPositive1ByteInt + (bytesNeeded - 1)), invert);
-        _appendBytes(firstUsedByte, bytesNeeded, invert);
+        memcpy(base + 1, firstUsedByte, bytesNeeded);
     }
 }
 
@@ -268,6 +268,42 @@ TEST_F(KeyStringTest, NumbersNearInt32Max) {
     }
 }
 
+TEST_F(KeyStringTest, NumbersNearByteBoundaries) {
+    for (int shift = 0; shift < 63; shift++) {
+        for (long long delta = -2; delta <= 2; delta++) {
+            const long long toTest = (1LL << shift) + delta;
+            ROUNDTRIP(version, BSON("" << toTest));
+            ROUNDTRIP(version, BSON("" << -toTest));
+            COMPARES_SAME(version, BSON("" << toTest), BSON("" << toTest + 1));
+            COMPARES_SAME(version, BSON("" << -toTest), BSON("" << -toTest + 1));
+        }
+    }
+}
+
+TEST_F(KeyStringTest, StringsOfManyLengths) {
+    // Covers both the word-at-a-time and the trailing byte-at-a-time handling of descending
+    // strings, including embedded NUL and 0xFF bytes.
+    for (size_t length = 0; length < 40; length++) {
+        for (char fill : {'a', '\0', '\xff'}) {
+            std::string str(length, 'x');
+            if (length > 0) {
+                str[length / 2] = fill;
+                str[length - 1] = fill;
+            }
+
+            ROUNDTRIP(version, BSON("" << str));
+            ROUNDTRIP(version, BSON("" << BSONSymbol(str)));
+            COMPARES_SAME(version, BSON("" << str), BSON("" << str + 'a'));
+            COMPARES_SAME(version, BSON("" << str), BSON("" << std::string(length, 'x')));
+
+            // Regular expressions cannot contain NUL bytes.
+            if (fill != '\0') {
+                ROUNDTRIP(version, BSON("" << BSONRegEx(str, str)));
+            }
+        }
+    }
+}
+
 TEST_F(KeyStringTest, DecimalNumbers) {
     if (version == KeyString::Version::V0) {
         log() << "not testing DecimalNumbers for KeyString V0";
@@ -1116,6 +1152,44 @@ void perfTest(KeyString::Version version, const Numbers& numbers) {
           << (kDebugBuild ? " (DEBUG BUILD!)" : "") << " min " << (*minmax.first)[""] << ", max"
           << (*minmax.second)[""];
 }
+
+/**
+ * Like perfTest(), but for compound keys using the given ordering. Also logs the average size of
+ * the encoded keys relative to the BSON keys they were built from.
+ */
+void compoundPerfTest(KeyString::Version version,
+                      const std::vector<BSONObj>& keys,
+                      Ordering ord,
+                      StringData description) {
+    uint64_t micros = 0;
+    uint64_t iters;
+    for (iters = 16; iters < (1 << 30) && micros < kMinPerfMicros; iters *= 2) {
+        Timer t;
+
+        for (uint64_t i = 0; i < iters; i++)
+            for (auto&& key : keys) {
+                const KeyString ks(version, key, ord);
+                const BSONObj& converted = toBson(ks, ord);
+                invariant(converted.binaryEqual(key));
+            }
+
+        micros = t.micros();
+    }
+
+    uint64_t bsonBytes = 0;
+    uint64_t keyStringBytes = 0;
+    for (auto&& key : keys) {
+        const KeyString ks(version, key, ord);
+        bsonBytes += key.objsize();
+        keyStringBytes += ks.getSize() + ks.getTypeBits().getSize();
+    }
+
+    log() << 1E3 * micros / static_cast<double>(iters * keys.size()) << " ns per "
+          << mongo::KeyString::versionToString(version) << " " << description << " roundtrip"
+          << (kDebugBuild ? " (DEBUG BUILD!)" : "") << ", average key size "
+          << keyStringBytes / static_cast<double>(keys.size()) << " bytes (BSON "
+          << bsonBytes / static_cast<double>(keys.size()) << " bytes)";
+}
 }  // namespace
 
 TEST_F(KeyStringTest, CommonIntPerf) {
@@ -1231,3 +1305,36 @@ TEST_F(KeyStringTest, DecimalFromUniformDoublePerf) {
     }
     perfTest(version, numbers);
 }
+
+TEST_F(KeyStringTest, CompoundStringPrefixPerf) {
+    // Low-cardinality leading fields sharing long prefixes, followed by a unique integer.
+    std::mt19937 gen(newSeed());
+    std::uniform_int_distribution<int> uniformTenant(0, 15);
+    std::uniform_int_distribution<int> uniformInt(0, std::numeric_limits<int>::max());
+
+    const std::string prefix = "organization/region-eu-west/department/";
+    std::vector<BSONObj> keys;
+    for (uint64_t x = 0; x < kMinPerfSamples; x++) {
+        const int tenant = uniformTenant(gen);
+        keys.push_back(BSON("" << prefix + std::to_string(tenant) << ""
+                               << "status-" + std::to_string(tenant % 3)
+                               << ""
+                               << uniformInt(gen)));
+    }
+
+    compoundPerfTest(version, keys, ALL_ASCENDING, "compound string prefix");
+    compoundPerfTest(
+        version, keys, Ordering::make(BSON("a" << 1 << "b" << -1 << "c" << 1)), "mixed order");
+}
+
+TEST_F(KeyStringTest, CompoundIntPerf) {
+    std::mt19937 gen(newSeed());
+    std::exponential_distribution<double> expReal(1e-3);
+
+    std::vector<BSONObj> keys;
+    for (uint64_t x = 0; x < kMinPerfSamples; x++)
+        keys.push_back(BSON("" << static_cast<int>(expReal(gen)) << ""
+                               << static_cast<long long>(expReal(gen))));
+
+    compoundPerfTest(version, keys, ALL_ASCENDING, "compound int");
+}
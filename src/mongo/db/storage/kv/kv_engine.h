@@ -35,6 +35,7 @@
 #include <vector>
 
 #include "mongo/base/status.h"
+#include "mongo/base/status_with.h"
 #include "mongo/base/string_data.h"
 #include "mongo/db/catalog/collection_options.h"
 
@@ -110,6 +111,14 @@ public:
         MONGO_UNREACHABLE;
     }
 
+    /**
+     * See StorageEngine::getBackupFiles for details
+     */
+    virtual StatusWith<std::vector<std::string>> getBackupFiles(OperationContext* txn) const {
+        return Status(ErrorCodes::CommandNotSupported,
+                      "The current storage engine doesn't support listing backup files");
+    }
+
     virtual bool isDurable() const = 0;
 
     /**
@@ -268,6 +268,12 @@ void KVStorageEngine::endBackup(OperationContext* txn) {
     _inBackupMode = false;
 }
 
+StatusWith<std::vector<std::string>> KVStorageEngine::getBackupFiles(OperationContext* txn) const {
+    if (!_inBackupMode)
+        return Status(ErrorCodes::IllegalOperation, "Not in Backup Mode");
+    return _engine->getBackupFiles(txn);
+}
+
 bool KVStorageEngine::isDurable() const {
     return _engine->isDurable();
 }
@@ -85,6 +85,8 @@ public:
 
     virtual void endBackup(OperationContext* txn);
 
+    virtual StatusWith<std::vector<std::string>> getBackupFiles(OperationContext* txn) const;
+
     virtual bool isDurable() const;
 
     virtual bool isEphemeral() const;
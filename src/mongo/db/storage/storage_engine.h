@@ -34,6 +34,7 @@
 #include <vector>
 
 #include "mongo/base/status.h"
+#include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/util/mongoutils/str.h"
 
@@ -244,6 +245,19 @@ public:
         return;
     }
 
+    /**
+     * Returns the names of the files, relative to the dbpath, that make up a consistent copy of
+     * the data while the storage engine is in backup mode. Copying exactly these files is enough
+     * to restore the data as of the call to beginBackup().
+     *
+     * May only be called between beginBackup() and endBackup(). Storage engines that cannot
+     * enumerate their backup files should use the default implementation.
+     */
+    virtual StatusWith<std::vector<std::string>> getBackupFiles(OperationContext* txn) const {
+        return Status(ErrorCodes::CommandNotSupported,
+                      "The current storage engine doesn't support listing backup files");
+    }
+
     /**
      * Recover as much data as possible from a potentially corrupt RecordStore.
      * This only recovers the record data, not indexes or anything else.
@@ -409,7 +409,9 @@ int WiredTigerKVEngine::flushAllFiles(bool sync) {
 }
 
 Status WiredTigerKVEngine::beginBackup(OperationContext* txn) {
-    invariant(!_backupSession);
+    if (_backupSession) {
+        return Status(ErrorCodes::IllegalOperation, "A backup is already in progress");
+    }
 
     // This cursor will be freed by the backupSession being closed as the session is uncached
     auto session = stdx::make_unique<WiredTigerSession>(_conn);
@@ -419,12 +421,33 @@ Status WiredTigerKVEngine::beginBackup(OperationContext* txn) {
     if (ret != 0) {
         return wtRCToStatus(ret);
     }
+
+    // The backup cursor returns the name of every file that must be copied; they stay stable on
+    // disk until the cursor is closed.
+    std::vector<std::string> backupFiles;
+    while ((ret = c->next(c)) == 0) {
+        const char* filename;
+        invariantWTOK(c->get_key(c, &filename));
+        backupFiles.emplace_back(filename);
+    }
+    if (ret != WT_NOTFOUND) {
+        return wtRCToStatus(ret);
+    }
+
     _backupSession = std::move(session);
+    _backupFiles = std::move(backupFiles);
     return Status::OK();
 }
 
 void WiredTigerKVEngine::endBackup(OperationContext* txn) {
     _backupSession.reset();
+    _backupFiles.clear();
+}
+
+StatusWith<std::vector<std::string>> WiredTigerKVEngine::getBackupFiles(
+    OperationContext* txn) const {
+    invariant(_backupSession);
+    return _backupFiles;
 }
 
 void WiredTigerKVEngine::syncSizeInfo(bool sync) const {
@@ -113,6 +113,8 @@ public:
 
     virtual void endBackup(OperationContext* txn);
 
+    virtual StatusWith<std::vector<std::string>> getBackupFiles(OperationContext* txn) const;
+
     virtual int64_t getIdentSize(OperationContext* opCtx, StringData ident);
 
     virtual Status repairIdent(OperationContext* opCtx, StringData ident);
@@ -188,5 +190,7 @@ private:
     mutable Date_t _previousCheckedDropsQueued;
 
     std::unique_ptr<WiredTigerSession> _backupSession;
+    // Files listed by the backup cursor held open by '_backupSession'.
+    std::vector<std::string> _backupFiles;
 };
 }
@@ -44,6 +44,7 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/oplog_hack.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
@@ -92,6 +93,14 @@ bool shouldUseOplogHack(OperationContext* opCtx, const std::string& uri) {
 MONGO_FP_DECLARE(WTWriteConflictException);
 MONGO_FP_DECLARE(WTPausePrimaryOplogDurabilityLoop);
 
+// Minimum number of seconds of history the oplog should retain, even if that causes it to grow
+// beyond its configured maximum size. A value of 0 disables time-based retention.
+MONGO_EXPORT_SERVER_PARAMETER(oplogMinRetentionSecs, int, 0);
+
+// Hard ceiling, as a multiple of the oplog's configured maximum size, beyond which the oplog is
+// truncated regardless of 'oplogMinRetentionSecs'.
+MONGO_EXPORT_SERVER_PARAMETER(oplogRetentionMaxSizeMultiplier, double, 2.0);
+
 const std::string kWiredTigerEngineName = "wiredTiger";
 
 class WiredTigerRecordStore::OplogStones::InsertChange final : public RecoveryUnit::Change {
@@ -180,7 +189,14 @@ void WiredTigerRecordStore::OplogStones::awaitHasExcessStonesOrDead() {
     // Wait until kill() is called or there are too many oplog stones.
     stdx::unique_lock<stdx::mutex> lock(_oplogReclaimMutex);
     while (!_isDead && !hasExcessStones()) {
-        _oplogReclaimCv.wait(lock);
+        if (oplogMinRetentionSecs.load() <= 0) {
+            _oplogReclaimCv.wait(lock);
+            continue;
+        }
+
+        // Stones held back by the retention window become excess as time passes rather than as a
+        // result of an insert, so periodically wake up to check whether they have aged out.
+        _oplogReclaimCv.wait_for(lock, Seconds(1).toSystemDuration());
     }
 }
 
@@ -188,7 +204,7 @@ boost::optional<WiredTigerRecordStore::OplogStones::Stone>
 WiredTigerRecordStore::OplogStones::peekOldestStoneIfNeeded() const {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
 
-    if (!hasExcessStones()) {
+    if (!_hasExcessStones_inlock()) {
         return {};
     }
 
@@ -220,7 +236,8 @@ void WiredTigerRecordStore::OplogStones::createNewStoneIfNeeded(RecordId lastRec
         return;
     }
 
-    OplogStones::Stone stone = {_currentRecords.swap(0), _currentBytes.swap(0), lastRecord};
+    OplogStones::Stone stone = {
+        _currentRecords.swap(0), _currentBytes.swap(0), lastRecord, _wallTimeForRecord(lastRecord)};
     _stones.push_back(stone);
 
     _pokeReclaimThreadIfNeeded();
@@ -236,6 +253,39 @@ void WiredTigerRecordStore::OplogStones::clearStonesOnCommit(OperationContext* t
     txn->recoveryUnit()->registerChange(new TruncateChange(this));
 }
 
+void WiredTigerRecordStore::OplogStones::appendStats(BSONObjBuilder* builder) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    int64_t stonesBytes = 0;
+    int64_t stonesRecords = 0;
+    for (auto&& stone : _stones) {
+        stonesBytes += stone.bytes;
+        stonesRecords += stone.records;
+    }
+
+    builder->append("numStones", static_cast<long long>(_stones.size()));
+    builder->append("numStonesToKeep", static_cast<long long>(_numStonesToKeep));
+    builder->append("minBytesPerStone", static_cast<long long>(_minBytesPerStone));
+    builder->append("recordsInStones", static_cast<long long>(stonesRecords));
+    builder->append("bytesInStones", static_cast<long long>(stonesBytes));
+    builder->append("currentStoneRecords", static_cast<long long>(_currentRecords.load()));
+    builder->append("currentStoneBytes", static_cast<long long>(_currentBytes.load()));
+    builder->append("minRetentionSecs", oplogMinRetentionSecs.load());
+    builder->append("maxRetentionSizeBytes",
+                    static_cast<long long>(_rs->cappedMaxSize() *
+                                           std::max(1.0, oplogRetentionMaxSizeMultiplier.load())));
+
+    if (!_stones.empty()) {
+        const Date_t oldest = _stones.front().wallTime;
+        builder->append("oldestStoneWallTime", oldest);
+        builder->append("newestStoneWallTime", _stones.back().wallTime);
+        builder->append("retentionWindowSecs", durationCount<Seconds>(Date_t::now() - oldest));
+    }
+
+    const bool sizeExceeded = _stones.size() > _numStonesToKeep;
+    builder->append("heldByRetentionWindow", sizeExceeded && !_hasExcessStones_inlock());
+}
+
 void WiredTigerRecordStore::OplogStones::updateStonesAfterCappedTruncateAfter(
     int64_t recordsRemoved, int64_t bytesRemoved, RecordId firstRemovedId) {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
@@ -328,7 +378,10 @@ void WiredTigerRecordStore::OplogStones::_calculateStonesByScanning(OperationCon
             LOG(1) << "Placing a marker at optime "
                    << Timestamp(record->id.repr()).toStringPretty();
 
-            OplogStones::Stone stone = {_currentRecords.swap(0), _currentBytes.swap(0), record->id};
+            OplogStones::Stone stone = {_currentRecords.swap(0),
+                                        _currentBytes.swap(0),
+                                        record->id,
+                                        _wallTimeForRecord(record->id)};
             _stones.push_back(stone);
         }
 
@@ -413,7 +466,8 @@ void WiredTigerRecordStore::OplogStones::_calculateStonesBySampling(OperationCon
         RecordId lastRecord = oplogEstimates[sampleIndex];
 
         log() << "Placing a marker at optime " << Timestamp(lastRecord.repr()).toStringPretty();
-        OplogStones::Stone stone = {estRecordsPerStone, estBytesPerStone, lastRecord};
+        OplogStones::Stone stone = {
+            estRecordsPerStone, estBytesPerStone, lastRecord, _wallTimeForRecord(lastRecord)};
         _stones.push_back(stone);
     }
 
@@ -422,12 +476,53 @@ void WiredTigerRecordStore::OplogStones::_calculateStonesBySampling(OperationCon
     _currentBytes.store(_rs->dataSize(txn) - estBytesPerStone * wholeStones);
 }
 
+bool WiredTigerRecordStore::OplogStones::_hasExcessStones_inlock() const {
+    if (_stones.size() <= _numStonesToKeep) {
+        return false;
+    }
+
+    const int minRetentionSecs = oplogMinRetentionSecs.load();
+    if (minRetentionSecs <= 0) {
+        return true;
+    }
+
+    if (_exceedsRetentionCeiling_inlock()) {
+        return true;
+    }
+
+    // Truncating the oldest stone removes all of the records up to and including its last record,
+    // so it is only safe to do so once that record has fallen outside of the retention window.
+    return _stones.front().wallTime <= Date_t::now() - Seconds(minRetentionSecs);
+}
+
+bool WiredTigerRecordStore::OplogStones::_exceedsRetentionCeiling_inlock() const {
+    const double multiplier = std::max(1.0, oplogRetentionMaxSizeMultiplier.load());
+    const int64_t maxBytes = static_cast<int64_t>(_rs->cappedMaxSize() * multiplier);
+
+    int64_t totalBytes = _currentBytes.load();
+    for (auto&& stone : _stones) {
+        totalBytes += stone.bytes;
+        if (totalBytes > maxBytes) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void WiredTigerRecordStore::OplogStones::_pokeReclaimThreadIfNeeded() {
-    if (hasExcessStones()) {
+    if (_hasExcessStones_inlock()) {
         _oplogReclaimCv.notify_one();
     }
 }
 
+// static
+Date_t WiredTigerRecordStore::OplogStones::_wallTimeForRecord(const RecordId& lastRecord) {
+    // The RecordIds of oplog entries are derived from their optimes, whose seconds component is
+    // the wall-clock time on the primary at which the operation was written.
+    return Date_t::fromMillisSinceEpoch(
+        static_cast<long long>(Timestamp(lastRecord.repr()).getSecs()) * 1000);
+}
+
 class WiredTigerRecordStore::Cursor final : public SeekableRecordCursor {
 public:
     Cursor(OperationContext* txn, const WiredTigerRecordStore& rs, bool forward = true)
@@ -1202,6 +1297,12 @@ bool WiredTigerRecordStore::yieldAndAwaitOplogDeletionRequest(OperationContext*
     return !oplogStones->isDead();
 }
 
+void WiredTigerRecordStore::appendOplogStonesStats(BSONObjBuilder* builder) const {
+    if (_oplogStones) {
+        _oplogStones->appendStats(builder);
+    }
+}
+
 void WiredTigerRecordStore::reclaimOplog(OperationContext* txn) {
     while (auto stone = _oplogStones->peekOldestStoneIfNeeded()) {
         invariant(stone->lastRecord.isNormal());
@@ -1616,6 +1717,10 @@ void WiredTigerRecordStore::appendCustomStats(OperationContext* txn,
         result->appendIntOrLL("sleepCount", _cappedSleep.load());
         result->appendIntOrLL("sleepMS", _cappedSleepMS.load());
     }
+    if (_oplogStones) {
+        BSONObjBuilder stonesBuilder(result->subobjStart("oplogStones"));
+        _oplogStones->appendStats(&stonesBuilder);
+    }
     WiredTigerSession* session = WiredTigerRecoveryUnit::get(txn)->getSession(txn);
     WT_SESSION* s = session->getSession();
     BSONObjBuilder bob(result->subobjStart(_engineName));
@@ -242,6 +242,10 @@ public:
     // Returns false if the oplog was dropped while waiting for a deletion request.
     bool yieldAndAwaitOplogDeletionRequest(OperationContext* txn);
 
+    // Appends the retention window and the oplog stones statistics if this record store is
+    // underlying the active oplog.
+    void appendOplogStonesStats(BSONObjBuilder* builder) const;
+
     class OplogStones;
 
     // Exposed only for testing.
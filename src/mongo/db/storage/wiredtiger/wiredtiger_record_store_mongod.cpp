@@ -37,6 +37,7 @@
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/client.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/namespace_string.h"
@@ -128,6 +129,44 @@ private:
     std::string _name;
 };
 
+/**
+ * Reports the retention window and the oplog stones of each oplog that has a background thread
+ * truncating it.
+ */
+class OplogTruncationServerStatusSection : public ServerStatusSection {
+public:
+    OplogTruncationServerStatusSection() : ServerStatusSection("oplogTruncation") {}
+
+    bool includeByDefault() const override {
+        return true;
+    }
+
+    BSONObj generateSection(OperationContext* txn,
+                            const BSONElement& configElement) const override {
+        std::set<NamespaceString> namespaces;
+        {
+            stdx::lock_guard<stdx::mutex> lock(_backgroundThreadMutex);
+            namespaces = _backgroundThreadNamespaces;
+        }
+
+        BSONObjBuilder result;
+        for (auto&& nss : namespaces) {
+            ScopedTransaction transaction(txn, MODE_IS);
+            AutoGetCollection autoColl(txn, nss, MODE_IS);
+            Collection* collection = autoColl.getCollection();
+            if (!collection) {
+                continue;
+            }
+
+            WiredTigerRecordStore* rs =
+                checked_cast<WiredTigerRecordStore*>(collection->getRecordStore());
+            BSONObjBuilder bob(result.subobjStart(nss.ns()));
+            rs->appendOplogStonesStats(&bob);
+        }
+        return result.obj();
+    }
+} oplogTruncationServerStatusSection;
+
 }  // namespace
 
 // static
@@ -35,20 +35,24 @@
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
+class BSONObjBuilder;
 class OperationContext;
 class RecordId;
 
 // Keep "milestones" against the oplog to efficiently remove the old records when the collection
-// grows beyond its desired maximum size.
+// grows beyond its desired maximum size, or, if a minimum retention window is configured, once the
+// records fall outside of that window.
 class WiredTigerRecordStore::OplogStones {
 public:
     struct Stone {
         int64_t records;      // Approximate number of records in a chunk of the oplog.
         int64_t bytes;        // Approximate size of records in a chunk of the oplog.
         RecordId lastRecord;  // RecordId of the last record in a chunk of the oplog.
+        Date_t wallTime;      // Wall-clock time of the last record in a chunk of the oplog.
     };
 
     OplogStones(OperationContext* txn, WiredTigerRecordStore* rs);
@@ -58,7 +62,8 @@ public:
     void kill();
 
     bool hasExcessStones() const {
-        return _stones.size() > _numStonesToKeep;
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _hasExcessStones_inlock();
     }
 
     void awaitHasExcessStonesOrDead();
@@ -76,6 +81,9 @@ public:
 
     void clearStonesOnCommit(OperationContext* txn);
 
+    // Appends the current retention window and the statistics about the oplog stones to 'builder'.
+    void appendStats(BSONObjBuilder* builder) const;
+
     // Updates the metadata about the oplog stones after a rollback occurs.
     void updateStonesAfterCappedTruncateAfter(int64_t recordsRemoved,
                                               int64_t bytesRemoved,
@@ -116,8 +124,20 @@ private:
                                     int64_t estRecordsPerStone,
                                     int64_t estBytesPerStone);
 
+    // Returns true if the oldest stone should be truncated. When a minimum retention window is
+    // configured, stones whose records are still within the window are kept even though the
+    // number of stones exceeds '_numStonesToKeep', unless the stones have grown beyond the hard
+    // size ceiling.
+    bool _hasExcessStones_inlock() const;
+
+    // Returns true if the stones have grown beyond the hard size ceiling for the retention window.
+    bool _exceedsRetentionCeiling_inlock() const;
+
     void _pokeReclaimThreadIfNeeded();
 
+    // Returns the wall-clock time at which the oplog entry with id 'lastRecord' was written.
+    static Date_t _wallTimeForRecord(const RecordId& lastRecord);
+
     static const uint64_t kRandomSamplesPerStone = 10;
 
     WiredTigerRecordStore* _rs;
@@ -39,6 +39,7 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/json.h"
 #include "mongo/db/operation_context_noop.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/record_store_test_harness.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store_oplog_stones.h"
@@ -1463,6 +1464,100 @@ TEST(WiredTigerRecordStoreTest, OplogStones_ReclaimStones) {
     }
 }
 
+// Verify that oplog stones within the minimum retention window are not reclaimed, unless the oplog
+// has grown beyond the hard size ceiling.
+TEST(WiredTigerRecordStoreTest, OplogStones_RetentionWindow) {
+    WiredTigerHarnessHelper harnessHelper;
+
+    const int64_t cappedMaxSize = 1024;  // 1KB
+    unique_ptr<RecordStore> rs(
+        harnessHelper.newCappedRecordStore("local.oplog.stones", cappedMaxSize, -1));
+
+    WiredTigerRecordStore* wtrs = static_cast<WiredTigerRecordStore*>(rs.get());
+    WiredTigerRecordStore::OplogStones* oplogStones = wtrs->oplogStones();
+
+    oplogStones->setMinBytesPerStone(100);
+    oplogStones->setNumStonesToKeep(2U);
+
+    const auto& serverParams = ServerParameterSet::getGlobal()->getMap();
+    ServerParameter* minRetentionSecs = serverParams.find("oplogMinRetentionSecs")->second;
+    ServerParameter* maxSizeMultiplier =
+        serverParams.find("oplogRetentionMaxSizeMultiplier")->second;
+    ASSERT_OK(minRetentionSecs->setFromString("3600"));
+    ON_BLOCK_EXIT([&] {
+        ASSERT_OK(minRetentionSecs->setFromString("0"));
+        ASSERT_OK(maxSizeMultiplier->setFromString("2.0"));
+    });
+
+    const unsigned int now = durationCount<Seconds>(Date_t::now().toDurationSinceEpoch());
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper.newOperationContext());
+
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 1), 100), RecordId(1, 1));
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(now, 1), 110),
+                  RecordId(now, 1));
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(now, 2), 120),
+                  RecordId(now, 2));
+
+        ASSERT_EQ(3U, oplogStones->numStones());
+        ASSERT_TRUE(oplogStones->hasExcessStones());
+    }
+
+    // Truncate the stone that is older than the retention window.
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper.newOperationContext());
+
+        wtrs->reclaimOplog(opCtx.get());
+
+        ASSERT_EQ(2, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(230, rs->dataSize(opCtx.get()));
+        ASSERT_EQ(2U, oplogStones->numStones());
+    }
+
+    // Keep the stones within the retention window even though there are too many of them.
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper.newOperationContext());
+
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(now, 3), 130),
+                  RecordId(now, 3));
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(now, 4), 140),
+                  RecordId(now, 4));
+        ASSERT_EQ(4U, oplogStones->numStones());
+        ASSERT_FALSE(oplogStones->hasExcessStones());
+
+        wtrs->reclaimOplog(opCtx.get());
+
+        ASSERT_EQ(4, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(500, rs->dataSize(opCtx.get()));
+        ASSERT_EQ(4U, oplogStones->numStones());
+
+        BSONObjBuilder builder;
+        wtrs->appendOplogStonesStats(&builder);
+        BSONObj stats = builder.obj();
+        ASSERT_EQ(4, stats["numStones"].numberLong());
+        ASSERT_EQ(500, stats["bytesInStones"].numberLong());
+        ASSERT_TRUE(stats["heldByRetentionWindow"].trueValue());
+    }
+
+    // Truncate stones within the retention window once the hard size ceiling is exceeded.
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper.newOperationContext());
+
+        ASSERT_OK(maxSizeMultiplier->setFromString("1.0"));
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(now, 5), 600),
+                  RecordId(now, 5));
+        ASSERT_EQ(5U, oplogStones->numStones());
+        ASSERT_TRUE(oplogStones->hasExcessStones());
+
+        wtrs->reclaimOplog(opCtx.get());
+
+        ASSERT_EQ(4, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(990, rs->dataSize(opCtx.get()));
+        ASSERT_EQ(4U, oplogStones->numStones());
+    }
+}
+
 // Verify that oplog stones are not reclaimed even if the size of the record store exceeds
 // 'cappedMaxSize'.
 TEST(WiredTigerRecordStoreTest, OplogStones_ExceedCappedMaxSize) {
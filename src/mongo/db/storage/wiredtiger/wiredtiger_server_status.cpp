@@ -75,6 +75,7 @@ BSONObj WiredTigerServerStatusSection::generateSection(OperationContext* txn,
     }
 
     WiredTigerKVEngine::appendGlobalStats(bob);
+    WiredTigerRecoveryUnit::get(txn)->getSessionCache()->appendStats(&bob);
 
     return bob.obj();
 }
@@ -36,12 +36,15 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 
 #include "mongo/base/error_codes.h"
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/storage/journal_listener.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/threadlocal.h"
 #include "mongo/util/log.h"
+#include "mongo/util/processinfo.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
@@ -52,7 +55,9 @@ WiredTigerSession::WiredTigerSession(WT_CONNECTION* conn, uint64_t epoch, uint64
       _session(NULL),
       _cursorGen(0),
       _cursorsCached(0),
-      _cursorsOut(0) {
+      _cursorsOut(0),
+      _cursorCacheHits(0),
+      _cursorCacheMisses(0) {
     invariantWTOK(conn->open_session(conn, NULL, "isolation=snapshot", &_session));
 }
 
@@ -66,7 +71,9 @@ WiredTigerSession::WiredTigerSession(WT_CONNECTION* conn,
       _session(NULL),
       _cursorGen(0),
       _cursorsCached(0),
-      _cursorsOut(0) {
+      _cursorsOut(0),
+      _cursorCacheHits(0),
+      _cursorCacheMisses(0) {
     invariantWTOK(conn->open_session(conn, NULL, "isolation=snapshot", &_session));
 }
 
@@ -84,10 +91,13 @@ WT_CURSOR* WiredTigerSession::getCursor(const std::string& uri, uint64_t id, boo
             _cursors.erase(i);
             _cursorsOut++;
             _cursorsCached--;
+            _cursorCacheHits++;
             return c;
         }
     }
 
+    _cursorCacheMisses++;
+
     WT_CURSOR* c = NULL;
     int ret = _session->open_cursor(
         _session, uri.c_str(), NULL, forRecordStore ? "" : "overwrite=false", &c);
@@ -136,6 +146,16 @@ void WiredTigerSession::closeAllCursors() {
 
 namespace {
 AtomicUInt64 nextTableId(1);
+
+// Threads are assigned home shards round robin on their first call into any session cache.
+// Zero means the calling thread has not been assigned a shard yet.
+AtomicUInt32 nextHomeShard;
+MONGO_TRIVIALLY_CONSTRUCTIBLE_THREAD_LOCAL uint32_t homeShardPlusOne;
+
+unsigned numSessionCacheShards() {
+    ProcessInfo pi;
+    return std::max(pi.getNumCores(), 1U);
+}
 }
 // static
 uint64_t WiredTigerSession::genTableId() {
@@ -145,10 +165,21 @@ uint64_t WiredTigerSession::genTableId() {
 // -----------------------
 
 WiredTigerSessionCache::WiredTigerSessionCache(WiredTigerKVEngine* engine)
-    : _engine(engine), _conn(engine->getConnection()), _snapshotManager(_conn), _shuttingDown(0) {}
+    : _engine(engine),
+      _conn(engine->getConnection()),
+      _snapshotManager(_conn),
+      _shuttingDown(0) {
+    for (unsigned i = 0; i < numSessionCacheShards(); i++) {
+        _shards.push_back(stdx::make_unique<Shard>());
+    }
+}
 
 WiredTigerSessionCache::WiredTigerSessionCache(WT_CONNECTION* conn)
-    : _engine(NULL), _conn(conn), _snapshotManager(_conn), _shuttingDown(0) {}
+    : _engine(NULL), _conn(conn), _snapshotManager(_conn), _shuttingDown(0) {
+    for (unsigned i = 0; i < numSessionCacheShards(); i++) {
+        _shards.push_back(stdx::make_unique<Shard>());
+    }
+}
 
 WiredTigerSessionCache::~WiredTigerSessionCache() {
     shuttingDown();
@@ -239,24 +270,32 @@ void WiredTigerSessionCache::closeAllCursors() {
     // Increment the cursor epoch so that all cursors from this epoch are closed.
     _cursorEpoch.fetchAndAdd(1);
 
-    stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-    for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
-        (*i)->closeAllCursors();
+    for (auto&& shard : _shards) {
+        stdx::lock_guard<stdx::mutex> lock(shard->lock);
+        for (SessionCache::iterator i = shard->sessions.begin(); i != shard->sessions.end(); i++) {
+            (*i)->closeAllCursors();
+        }
     }
 }
 
 void WiredTigerSessionCache::closeAll() {
-    // Increment the epoch as we are now closing all sessions with this epoch.
-    SessionCache swap;
+    // Increment the epoch as we are now closing all sessions with this epoch. This must happen
+    // before any shard is emptied, so that a session released concurrently either lands in a
+    // shard that has yet to be emptied or observes the new epoch and is deleted by its releaser.
+    _epoch.fetchAndAdd(1);
 
-    {
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-        _epoch.fetchAndAdd(1);
-        _sessions.swap(swap);
-    }
+    for (auto&& shard : _shards) {
+        SessionCache swap;
+
+        {
+            stdx::lock_guard<stdx::mutex> lock(shard->lock);
+            shard->sessions.swap(swap);
+            shard->numCached.store(0);
+        }
 
-    for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
-        delete (*i);
+        for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
+            delete (*i);
+        }
     }
 }
 
@@ -269,18 +308,28 @@ UniqueWiredTigerSession WiredTigerSessionCache::getSession() {
     // operations should be allowed to start.
     invariant(!(_shuttingDown.loadRelaxed() & kShuttingDownMask));
 
+    const size_t homeIndex = _homeShardIndex();
     {
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-        if (!_sessions.empty()) {
+        Shard& home = *_shards[homeIndex];
+        stdx::lock_guard<stdx::mutex> lock(home.lock);
+        if (!home.sessions.empty()) {
             // Get the most recently used session so that if we discard sessions, we're
             // discarding older ones
-            WiredTigerSession* cachedSession = _sessions.back();
-            _sessions.pop_back();
+            WiredTigerSession* cachedSession = home.sessions.back();
+            home.sessions.pop_back();
+            home.numCached.subtractAndFetch(1);
+            home.sessionsReused++;
             return UniqueWiredTigerSession(cachedSession);
         }
     }
 
+    // Opening a session is far more expensive than briefly locking another shard.
+    if (WiredTigerSession* stolenSession = _stealSession(homeIndex)) {
+        return UniqueWiredTigerSession(stolenSession);
+    }
+
     // Outside of the cache partition lock, but on release will be put back on the cache
+    _sessionsCreated.fetchAndAdd(1);
     return UniqueWiredTigerSession(
         new WiredTigerSession(_conn, this, _epoch.load(), _cursorEpoch.load()));
 }
@@ -322,15 +371,22 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
 
     bool returnedToCache = false;
     uint64_t currentEpoch = _epoch.load();
+    invariant(session->_getEpoch() <= currentEpoch);
+
+    {
+        Shard& home = *_shards[_homeShardIndex()];
+        stdx::lock_guard<stdx::mutex> lock(home.lock);
+        home.cursorCacheHits += session->_cursorCacheHits;
+        home.cursorCacheMisses += session->_cursorCacheMisses;
+        session->_cursorCacheHits = 0;
+        session->_cursorCacheMisses = 0;
 
-    if (session->_getEpoch() == currentEpoch) {  // check outside of lock to reduce contention
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
         if (session->_getEpoch() == _epoch.load()) {  // recheck inside the lock for correctness
             returnedToCache = true;
-            _sessions.push_back(session);
+            home.sessions.push_back(session);
+            home.numCached.addAndFetch(1);
         }
-    } else
-        invariant(session->_getEpoch() < currentEpoch);
+    }
 
     if (!returnedToCache)
         delete session;
@@ -340,6 +396,58 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
 }
 
 
+size_t WiredTigerSessionCache::_homeShardIndex() const {
+    while (!homeShardPlusOne) {
+        homeShardPlusOne = nextHomeShard.fetchAndAdd(1) + 1;
+    }
+    return (homeShardPlusOne - 1) % _shards.size();
+}
+
+WiredTigerSession* WiredTigerSessionCache::_stealSession(size_t homeIndex) {
+    for (size_t i = 1; i < _shards.size(); i++) {
+        Shard& victim = *_shards[(homeIndex + i) % _shards.size()];
+        if (victim.numCached.load() == 0) {
+            continue;
+        }
+
+        stdx::lock_guard<stdx::mutex> lock(victim.lock);
+        if (!victim.sessions.empty()) {
+            WiredTigerSession* session = victim.sessions.back();
+            victim.sessions.pop_back();
+            victim.numCached.subtractAndFetch(1);
+            victim.sessionsStolen++;
+            return session;
+        }
+    }
+    return nullptr;
+}
+
+void WiredTigerSessionCache::appendStats(BSONObjBuilder* builder) const {
+    long long sessionsCached = 0;
+    long long sessionsReused = 0;
+    long long sessionsStolen = 0;
+    long long cursorCacheHits = 0;
+    long long cursorCacheMisses = 0;
+    for (auto&& shard : _shards) {
+        stdx::lock_guard<stdx::mutex> lock(shard->lock);
+        sessionsCached += shard->sessions.size();
+        sessionsReused += shard->sessionsReused;
+        sessionsStolen += shard->sessionsStolen;
+        cursorCacheHits += shard->cursorCacheHits;
+        cursorCacheMisses += shard->cursorCacheMisses;
+    }
+
+    BSONObjBuilder bob(builder->subobjStart("sessionCache"));
+    bob.append("shards", static_cast<int>(_shards.size()));
+    bob.append("sessionsCached", sessionsCached);
+    bob.append("sessionsCreated", static_cast<long long>(_sessionsCreated.load()));
+    bob.append("sessionsReused", sessionsReused);
+    bob.append("sessionsStolen", sessionsStolen);
+    bob.append("cursorCacheHits", cursorCacheHits);
+    bob.append("cursorCacheMisses", cursorCacheMisses);
+    bob.done();
+}
+
 void WiredTigerSessionCache::setJournalListener(JournalListener* jl) {
     stdx::unique_lock<stdx::mutex> lk(_journalListenerMutex);
     _journalListener = jl;
@@ -32,7 +32,9 @@
 #pragma once
 
 #include <list>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include <boost/thread/shared_mutex.hpp>
 #include <wiredtiger.h>
@@ -45,6 +47,7 @@
 
 namespace mongo {
 
+class BSONObjBuilder;
 class WiredTigerKVEngine;
 class WiredTigerSessionCache;
 
@@ -133,11 +136,20 @@ private:
     CursorCache _cursors;            // owned
     uint64_t _cursorGen;
     int _cursorsCached, _cursorsOut;
+
+    // Lookups in _cursors since this session was last returned to the cache. These are folded
+    // into the owning WiredTigerSessionCache's statistics on release.
+    uint64_t _cursorCacheHits, _cursorCacheMisses;
 };
 
 /**
  *  This cache implements a shared pool of WiredTiger sessions with the goal to amortize the
  *  cost of session creation and destruction over multiple uses.
+ *
+ *  The pool is split into one shard per CPU, each with its own lock. A thread always releases
+ *  sessions to and first acquires sessions from its home shard, so under many concurrent
+ *  operations threads rarely contend on the same lock. When the home shard is empty, a session
+ *  is taken from another shard before a new one is opened.
  */
 class WiredTigerSessionCache {
 public:
@@ -204,7 +216,42 @@ public:
         return _cursorEpoch.load();
     }
 
+    /**
+     * Appends counters describing how often sessions and their cached cursors were reused.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
 private:
+    /**
+     * A partition of the cached sessions, along with reuse counters for the threads that call it
+     * home. All members other than numCached are protected by lock.
+     */
+    struct Shard {
+        stdx::mutex lock;
+        std::vector<WiredTigerSession*> sessions;
+
+        // Mirrors sessions.size() so that threads looking for a session to steal can skip empty
+        // shards without taking their lock.
+        AtomicUInt32 numCached;
+
+        uint64_t sessionsReused = 0;
+        uint64_t sessionsStolen = 0;
+        uint64_t cursorCacheHits = 0;
+        uint64_t cursorCacheMisses = 0;
+    };
+
+    /**
+     * Returns the index in _shards of the shard the calling thread acquires sessions from and
+     * releases sessions to.
+     */
+    size_t _homeShardIndex() const;
+
+    /**
+     * Removes and returns the most recently released session of a shard other than the one at
+     * 'homeIndex', or nullptr if all other shards are empty.
+     */
+    WiredTigerSession* _stealSession(size_t homeIndex);
+
     WiredTigerKVEngine* _engine;  // not owned, might be NULL
     WT_CONNECTION* _conn;         // not owned
     WiredTigerSnapshotManager _snapshotManager;
@@ -215,9 +262,11 @@ private:
     AtomicUInt32 _shuttingDown;
     static const uint32_t kShuttingDownMask = 1 << 31;
 
-    stdx::mutex _cacheLock;
     typedef std::vector<WiredTigerSession*> SessionCache;
-    SessionCache _sessions;
+    std::vector<std::unique_ptr<Shard>> _shards;
+
+    // Number of sessions opened because no cached session was available.
+    AtomicUInt64 _sessionsCreated;
 
     // Bumped when all open sessions need to be closed
     AtomicUInt64 _epoch;  // atomic so we can check it outside of the lock
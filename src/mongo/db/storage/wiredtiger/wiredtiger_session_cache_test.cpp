@@ -0,0 +1,190 @@
+// wiredtiger_session_cache_test.cpp
+
+/**
+ *    Copyright (C) 2016 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+namespace {
+
+class WiredTigerSessionCacheTest : public unittest::Test {
+public:
+    WiredTigerSessionCacheTest() : _dbpath("wt_session_cache_test") {
+        ASSERT_OK(wtRCToStatus(
+            wiredtiger_open(_dbpath.path().c_str(), NULL, "create,cache_size=50M,", &_conn)));
+        _sessionCache = stdx::make_unique<WiredTigerSessionCache>(_conn);
+    }
+
+    ~WiredTigerSessionCacheTest() {
+        _sessionCache.reset();
+        _conn->close(_conn, NULL);
+    }
+
+protected:
+    WiredTigerSessionCache* sessionCache() {
+        return _sessionCache.get();
+    }
+
+    long long getStat(StringData name) {
+        BSONObjBuilder bob;
+        _sessionCache->appendStats(&bob);
+        return bob.obj()["sessionCache"].Obj()[name].numberLong();
+    }
+
+private:
+    unittest::TempDir _dbpath;
+    WT_CONNECTION* _conn;
+    std::unique_ptr<WiredTigerSessionCache> _sessionCache;
+};
+
+TEST_F(WiredTigerSessionCacheTest, ReleasedSessionIsReused) {
+    WiredTigerSession* first;
+    {
+        UniqueWiredTigerSession session = sessionCache()->getSession();
+        first = session.get();
+    }
+    ASSERT_EQ(1, getStat("sessionsCached"));
+
+    UniqueWiredTigerSession session = sessionCache()->getSession();
+    ASSERT_EQ(first, session.get());
+    ASSERT_EQ(1, getStat("sessionsCreated"));
+    ASSERT_EQ(1, getStat("sessionsReused"));
+    ASSERT_EQ(0, getStat("sessionsCached"));
+}
+
+TEST_F(WiredTigerSessionCacheTest, SessionReleasedByAnotherThreadIsReused) {
+    WiredTigerSession* released = nullptr;
+    stdx::thread([&] {
+        UniqueWiredTigerSession session = sessionCache()->getSession();
+        released = session.get();
+    }).join();
+
+    // Whether or not the other thread shared this thread's home shard, the cached session must be
+    // handed out rather than a new one being opened.
+    UniqueWiredTigerSession session = sessionCache()->getSession();
+    ASSERT_EQ(released, session.get());
+    ASSERT_EQ(1, getStat("sessionsCreated"));
+    ASSERT_EQ(1, getStat("sessionsReused") + getStat("sessionsStolen"));
+}
+
+TEST_F(WiredTigerSessionCacheTest, CloseAllDiscardsCachedAndOutstandingSessions) {
+    UniqueWiredTigerSession outstanding = sessionCache()->getSession();
+    sessionCache()->getSession().reset();
+    ASSERT_EQ(1, getStat("sessionsCached"));
+
+    sessionCache()->closeAll();
+    ASSERT_EQ(0, getStat("sessionsCached"));
+
+    // A session acquired before closeAll is not returned to the cache.
+    outstanding.reset();
+    ASSERT_EQ(0, getStat("sessionsCached"));
+
+    sessionCache()->getSession().reset();
+    ASSERT_EQ(3, getStat("sessionsCreated"));
+}
+
+TEST_F(WiredTigerSessionCacheTest, CursorCacheHitsAreCountedOnRelease) {
+    const std::string uri = "table:cursor_cache";
+    const uint64_t tableId = WiredTigerSession::genTableId();
+    {
+        UniqueWiredTigerSession session = sessionCache()->getSession();
+        WT_SESSION* wtSession = session->getSession();
+        ASSERT_OK(wtRCToStatus(wtSession->create(wtSession, uri.c_str(), NULL)));
+
+        WT_CURSOR* cursor = session->getCursor(uri, tableId, false);
+        ASSERT(cursor);
+        session->releaseCursor(tableId, cursor);
+
+        cursor = session->getCursor(uri, tableId, false);
+        ASSERT(cursor);
+        session->releaseCursor(tableId, cursor);
+
+        // Not reported until the session is released.
+        ASSERT_EQ(0, getStat("cursorCacheHits"));
+    }
+    ASSERT_EQ(1, getStat("cursorCacheHits"));
+    ASSERT_EQ(1, getStat("cursorCacheMisses"));
+
+    UniqueWiredTigerSession session = sessionCache()->getSession();
+    WT_CURSOR* cursor = session->getCursor(uri, tableId, false);
+    ASSERT(cursor);
+    session->releaseCursor(tableId, cursor);
+    session.reset();
+    ASSERT_EQ(2, getStat("cursorCacheHits"));
+    ASSERT_EQ(1, getStat("cursorCacheMisses"));
+}
+
+TEST_F(WiredTigerSessionCacheTest, ConcurrentGetReleaseThroughput) {
+    const int kIterations = 20000;
+    for (int numThreads : {1, 4, 16, 64}) {
+        Timer timer;
+        std::vector<stdx::thread> threads;
+        for (int i = 0; i < numThreads; i++) {
+            threads.emplace_back([&] {
+                for (int j = 0; j < kIterations; j++) {
+                    UniqueWiredTigerSession session = sessionCache()->getSession();
+                    invariant(session->getSession());
+                }
+            });
+        }
+        for (auto&& thread : threads) {
+            thread.join();
+        }
+
+        const long long micros = std::max(timer.micros(), 1LL);
+        log() << "getSession/releaseSession with " << numThreads << " threads: "
+              << (static_cast<long long>(numThreads) * kIterations * 1000 * 1000 / micros)
+              << " ops/sec, sessions created: " << getStat("sessionsCreated")
+              << ", stolen: " << getStat("sessionsStolen");
+
+        // No more sessions are cached than there were concurrent users.
+        ASSERT_LTE(getStat("sessionsCached"), numThreads);
+        sessionCache()->closeAll();
+    }
+}
+
+}  // namespace
+}  // namespace mongo
@@ -52,12 +52,15 @@
 #include "mongo/db/db.h"
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/lasterror.h"
+#include "mongo/db/repl/oplog_entry.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/db/storage/mmap_v1/dur_stats.h"
 #include "mongo/db/storage/mmap_v1/mmap.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/dbtests/framework_options.h"
 #include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/util/log.h"
 #include "mongo/util/timer.h"
@@ -450,6 +453,180 @@ public:
     }
 };
 
+/**
+ * Measures the number of index keys per second that can be converted to or compared as KeyStrings.
+ */
+class KeyStringBase : public B {
+public:
+    virtual int howLongMillis() {
+        return 1000;
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+    virtual unsigned batchSize() {
+        return 1000;
+    }
+
+protected:
+    static const size_t kNumKeys = 4096;
+
+    void prep() {
+        for (size_t i = 0; i < kNumKeys; i++) {
+            _keys.push_back(makeKey(i));
+        }
+    }
+
+    const BSONObj& nextKey() {
+        return _keys[_next++ % kNumKeys];
+    }
+
+    virtual BSONObj makeKey(size_t i) = 0;
+
+    const KeyString::Version _version = KeyString::Version::V1;
+    std::vector<BSONObj> _keys;
+    size_t _next = 0;
+};
+
+class keyStringEncodeNumeric : public KeyStringBase {
+public:
+    string name() {
+        return "keyString-encode-numeric";
+    }
+    BSONObj makeKey(size_t i) {
+        return BSON("" << static_cast<int>(i * 7919) << "" << static_cast<long long>(i) * 104729);
+    }
+    void timed() {
+        KeyString ks(_version, nextKey(), _ordering);
+        invariant(ks.getSize() > 0);
+    }
+
+private:
+    const Ordering _ordering = Ordering::make(BSON("a" << 1 << "b" << 1));
+};
+
+class keyStringEncodeString : public KeyStringBase {
+public:
+    string name() {
+        return "keyString-encode-string";
+    }
+    BSONObj makeKey(size_t i) {
+        return BSON("" << ("organization/region-eu-west/department/" + std::to_string(i % 16))
+                       << ""
+                       << "user-" + std::to_string(i));
+    }
+    void timed() {
+        KeyString ks(_version, nextKey(), _ordering);
+        invariant(ks.getSize() > 0);
+    }
+
+protected:
+    Ordering _ordering = Ordering::make(BSON("a" << 1 << "b" << 1));
+};
+
+class keyStringEncodeStringDescending : public keyStringEncodeString {
+public:
+    keyStringEncodeStringDescending() {
+        _ordering = Ordering::make(BSON("a" << -1 << "b" << -1));
+    }
+    string name() {
+        return "keyString-encode-string-descending";
+    }
+};
+
+class keyStringRoundtripStringDescending : public keyStringEncodeStringDescending {
+public:
+    string name() {
+        return "keyString-roundtrip-string-descending";
+    }
+    void timed() {
+        KeyString ks(_version, nextKey(), _ordering);
+        BSONObj decoded =
+            KeyString::toBson(ks.getBuffer(), ks.getSize(), _ordering, ks.getTypeBits());
+        invariant(decoded.nFields() == 2);
+    }
+};
+
+class keyStringCompareLongPrefix : public keyStringEncodeString {
+public:
+    string name() {
+        return "keyString-compare-long-prefix";
+    }
+    void prep() {
+        keyStringEncodeString::prep();
+        for (auto&& key : _keys) {
+            _encoded.push_back(stdx::make_unique<KeyString>(_version, key, _ordering));
+        }
+    }
+    void timed() {
+        const size_t i = _next++ % kNumKeys;
+        invariant(_encoded[i]->compare(*_encoded[(i + 16) % kNumKeys]) != 0);
+    }
+
+private:
+    std::vector<std::unique_ptr<KeyString>> _encoded;
+};
+
+/**
+ * Measures the number of update oplog entries per second that the applier can prepare for a
+ * batch: parsing each entry out of a shared getMore reply and extracting what writer assignment
+ * and batch bookkeeping use.
+ */
+class oplogEntryPrepareUpdate : public B {
+public:
+    string name() {
+        return "oplogEntry-prepare-update";
+    }
+    virtual int howLongMillis() {
+        return 1000;
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+    virtual unsigned batchSize() {
+        return 1000;
+    }
+    void prep() {
+        BSONObjBuilder reply;
+        {
+            BSONObjBuilder cursor(reply.subobjStart("cursor"));
+            BSONArrayBuilder nextBatch(cursor.subarrayStart("nextBatch"));
+            for (size_t i = 0; i < kNumOps; i++) {
+                nextBatch.append(BSON("ts" << Timestamp(1, i) << "t" << 1LL << "h" << 0LL << "v"
+                                           << 2
+                                           << "op"
+                                           << "u"
+                                           << "ns"
+                                           << "test.perf"
+                                           << "o2"
+                                           << BSON("_id" << static_cast<int>(i))
+                                           << "o"
+                                           << BSON("$set" << BSON("x" << static_cast<int>(i)))));
+            }
+        }
+        _reply = reply.obj();
+
+        // Like the Fetcher, hand out documents that share ownership of the reply buffer.
+        for (auto&& elem : _reply["cursor"].Obj()["nextBatch"].Obj()) {
+            BSONObj doc = elem.Obj();
+            doc.shareOwnershipWith(_reply);
+            _docs.push_back(doc);
+        }
+    }
+    void timed() {
+        repl::OplogEntry entry(_docs[_next++ % kNumOps]);
+        invariant(entry.isCrudOpType());
+        invariant(!entry.getIdElement().eoo());
+        invariant(!entry.getOpTime().isNull());
+    }
+
+private:
+    static const size_t kNumOps = 4096;
+
+    BSONObj _reply;
+    std::vector<BSONObj> _docs;
+    size_t _next = 0;
+};
 
 class All : public Suite {
 public:
@@ -463,6 +640,12 @@ public:
         add<boosttimed_mutexspeed>();
         add<stdmutexspeed>();
         add<stdtimed_mutexspeed>();
+        add<keyStringEncodeNumeric>();
+        add<keyStringEncodeString>();
+        add<keyStringEncodeStringDescending>();
+        add<keyStringRoundtripStringDescending>();
+        add<keyStringCompareLongPrefix>();
+        add<oplogEntryPrepareUpdate>();
     }
 } myall;
 }
@@ -204,17 +204,23 @@ ResponseStatus NetworkInterfaceASIO::AsyncCommand::response(AsyncOp* op,
                                                             Date_t now,
                                                             rpc::EgressMetadataHook* metadataHook) {
     auto& received = _toRecv;
+    int compressedSize = 0;
+    int decompressedSize = 0;
     if (received.operation() == dbCompressed) {
+        compressedSize = received.size();
         auto swm = conn().getCompressorManager().decompressMessage(received);
         if (!swm.isOK()) {
             return swm.getStatus();
         }
         received = std::move(swm.getValue());
+        decompressedSize = received.size();
     }
 
     auto rs = decodeRPC(&received, protocol, now - _start, _target, metadataHook);
     if (rs.isOK())
         op->setResponseMetadata(rs.metadata);
+    rs.compressedSizeBytes = compressedSize;
+    rs.decompressedSizeBytes = decompressedSize;
     return rs;
 }
 
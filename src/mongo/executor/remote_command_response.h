@@ -82,6 +82,11 @@ struct RemoteCommandResponse {
     BSONObj metadata;                        // Always owned. May point into message.
     boost::optional<Milliseconds> elapsedMillis;
     Status status = Status::OK();
+
+    // Sizes in bytes of the reply as read from the network and after decompression. Both are zero
+    // unless the reply arrived compressed.
+    int compressedSizeBytes = 0;
+    int decompressedSizeBytes = 0;
 };
 
 }  // namespace executor
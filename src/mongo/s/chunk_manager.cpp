@@ -32,6 +32,7 @@
 
 #include "mongo/s/chunk_manager.h"
 
+#include <algorithm>
 #include <iterator>
 #include <map>
 #include <set>
@@ -48,6 +49,7 @@
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/s/balancer_configuration.h"
 #include "mongo/s/catalog/catalog_cache.h"
@@ -115,6 +117,10 @@ private:
     ChunkManager* const _manager;
 };
 
+// The routing table orders shard key values by their KeyString encoding with all fields ascending,
+// which matches the order of the chunk map.
+const Ordering kAllAscending = Ordering::make(BSONObj());
+
 bool allOfType(BSONType type, const BSONObj& o) {
     BSONObjIterator it(o);
     while (it.more()) {
@@ -178,18 +184,17 @@ ChunkManager::ChunkManager(const string& ns,
       _defaultCollator(std::move(defaultCollator)),
       _unique(unique),
       _sequenceNumber(NextSequenceNumber.addAndFetch(1)),
-      _chunkMap(SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<std::shared_ptr<Chunk>>()),
-      _chunkRangeMap(
-          SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<ShardAndChunkRange>()) {}
+      _queryTargetingCache(std::make_shared<QueryTargetingCache>(_keyPattern, !_defaultCollator)),
+      _chunkMap(
+          SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<std::shared_ptr<Chunk>>()) {}
 
 ChunkManager::ChunkManager(OperationContext* txn, const CollectionType& coll)
     : _ns(coll.getNs().ns()),
       _keyPattern(coll.getKeyPattern()),
       _unique(coll.getUnique()),
       _sequenceNumber(NextSequenceNumber.addAndFetch(1)),
-      _chunkMap(SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<std::shared_ptr<Chunk>>()),
-      _chunkRangeMap(
-          SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<ShardAndChunkRange>()) {
+      _chunkMap(
+          SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<std::shared_ptr<Chunk>>()) {
     // coll does not have correct version. Use same initial version as _load and createFirstChunks.
     _version = ChunkVersion(0, 0, coll.getEpoch());
 
@@ -202,11 +207,21 @@ ChunkManager::ChunkManager(OperationContext* txn, const CollectionType& coll)
 
         _defaultCollator = std::move(statusWithCollator.getValue());
     }
+
+    _queryTargetingCache = std::make_shared<QueryTargetingCache>(_keyPattern, !_defaultCollator);
 }
 
 void ChunkManager::loadExistingRanges(OperationContext* txn, const ChunkManager* oldManager) {
     invariant(!_version.isSet());
 
+    if (oldManager &&
+        SimpleBSONObjComparator::kInstance.evaluate(_keyPattern.toBSON() ==
+                                                    oldManager->_keyPattern.toBSON()) &&
+        CollatorInterface::collatorsMatch(_defaultCollator.get(),
+                                          oldManager->_defaultCollator.get())) {
+        _queryTargetingCache = oldManager->_queryTargetingCache;
+    }
+
     int tries = 3;
 
     while (tries--) {
@@ -220,13 +235,14 @@ void ChunkManager::loadExistingRanges(OperationContext* txn, const ChunkManager*
         log() << "ChunkManager loading chunks for " << _ns << " sequenceNumber: " << _sequenceNumber
               << " based on: " << (oldManager ? oldManager->getVersion().toString() : "(empty)");
 
-        if (_load(txn, chunkMap, shardIds, &shardVersions, oldManager)) {
+        bool sameChunkBounds = false;
+        if (_load(txn, chunkMap, shardIds, &shardVersions, oldManager, &sameChunkBounds)) {
             // TODO: Merge into diff code above, so we validate in one place
             if (isChunkMapValid(chunkMap)) {
                 _chunkMap = std::move(chunkMap);
                 _shardIds = std::move(shardIds);
                 _shardVersions = std::move(shardVersions);
-                _chunkRangeMap = _constructRanges(_chunkMap);
+                _buildRoutingTable(sameChunkBounds ? oldManager : nullptr);
 
                 log() << "ChunkManager load took " << t.millis() << " ms and found version "
                       << _version;
@@ -251,7 +267,10 @@ bool ChunkManager::_load(OperationContext* txn,
                          ChunkMap& chunkMap,
                          set<ShardId>& shardIds,
                          ShardVersionMap* shardVersions,
-                         const ChunkManager* oldManager) {
+                         const ChunkManager* oldManager,
+                         bool* sameChunkBounds) {
+    *sameChunkBounds = false;
+
     // Reset the max version, but not the epoch, when we aren't loading from the oldManager
     _version = ChunkVersion(0, 0, _version.epoch());
 
@@ -279,7 +298,8 @@ bool ChunkManager::_load(OperationContext* txn,
                                              oldC->getLastmod(),
                                              oldC->getBytesWritten()));
 
-            chunkMap.insert(make_pair(oldC->getMax(), newC));
+            // The old map is already in order, so every chunk goes at the end.
+            chunkMap.insert(chunkMap.end(), make_pair(oldC->getMax(), newC));
         }
 
         LOG(2) << "loading chunk manager for collection " << _ns
@@ -313,6 +333,19 @@ bool ChunkManager::_load(OperationContext* txn,
         LOG(2) << "loaded " << diffsApplied << " chunks into new chunk manager for " << _ns
                << " with version " << _version;
 
+        // A diff that only moves chunks or bumps their versions, which is what a migration does,
+        // leaves the bounds of all chunks as they were.
+        if (oldManager && oldManager->getVersion().isSet()) {
+            const ChunkMap& oldChunkMap = oldManager->getChunkMap();
+            *sameChunkBounds = chunkMap.size() == oldChunkMap.size() &&
+                std::all_of(chunks.begin(), chunks.end(), [&](const ChunkType& chunk) {
+                    auto oldChunkIt = oldChunkMap.find(chunk.getMax());
+                    return oldChunkIt != oldChunkMap.end() &&
+                        SimpleBSONObjComparator::kInstance.evaluate(
+                            oldChunkIt->second->getMin() == chunk.getMin());
+                });
+        }
+
         // Add all existing shards we find to the shards set
         for (ShardVersionMap::iterator it = shardVersions->begin(); it != shardVersions->end();) {
             auto shardStatus = grid.shardRegistry()->getShard(txn, it->first);
@@ -500,13 +533,11 @@ StatusWith<shared_ptr<Chunk>> ChunkManager::findIntersectingChunk(OperationConte
             }
         }
 
-        BSONObj chunkMin;
         shared_ptr<Chunk> chunk;
         {
-            ChunkMap::const_iterator it = _chunkMap.upper_bound(shardKey);
-            if (it != _chunkMap.end()) {
-                chunkMin = it->first;
-                chunk = it->second;
+            const size_t index = _chunkMaxKeys->upperBound(shardKey);
+            if (index < _chunksByMaxKey.size()) {
+                chunk = _chunksByMaxKey[index];
             }
         }
 
@@ -515,7 +546,7 @@ StatusWith<shared_ptr<Chunk>> ChunkManager::findIntersectingChunk(OperationConte
                 return chunk;
             }
 
-            log() << redact(chunkMin.toString());
+            log() << redact(chunk->getMax().toString());
             log() << redact((*chunk).toString());
             log() << redact(shardKey);
 
@@ -547,6 +578,14 @@ void ChunkManager::getShardIdsForQuery(OperationContext* txn,
                                        const BSONObj& query,
                                        const BSONObj& collation,
                                        set<ShardId>* shardIds) const {
+    // Simple queries are targeted by substituting their constants into the cached bounds of their
+    // shape, without planning them.
+    auto cachedRanges = _queryTargetingCache->getRanges(query, collation);
+    if (cachedRanges) {
+        _getShardIdsForRanges(*cachedRanges, shardIds);
+        return;
+    }
+
     auto qr = stdx::make_unique<QueryRequest>(NamespaceString(_ns));
     qr->setFilter(query);
 
@@ -591,6 +630,10 @@ void ChunkManager::getShardIdsForQuery(OperationContext* txn,
     //   => Ranges { a : 1, b : 3 } => { a : 2, b : 4 }
     BoundList ranges = _keyPattern.flattenBounds(bounds);
 
+    _getShardIdsForRanges(ranges, shardIds);
+}
+
+void ChunkManager::_getShardIdsForRanges(const BoundList& ranges, set<ShardId>* shardIds) const {
     for (BoundList::const_iterator it = ranges.begin(); it != ranges.end(); ++it) {
         getShardIdsForRange(*shardIds, it->first /*min*/, it->second /*max*/);
 
@@ -603,26 +646,26 @@ void ChunkManager::getShardIdsForQuery(OperationContext* txn,
     // For now, we satisfy that assumption by adding a shard with no matches rather than returning
     // an empty set of shards.
     if (shardIds->empty()) {
-        shardIds->insert(_chunkRangeMap.begin()->second.getShardId());
+        shardIds->insert(_rangeShardIds.front());
     }
 }
 
 void ChunkManager::getShardIdsForRange(set<ShardId>& shardIds,
                                        const BSONObj& min,
                                        const BSONObj& max) const {
-    auto it = _chunkRangeMap.upper_bound(min);
-    auto end = _chunkRangeMap.upper_bound(max);
+    size_t index = _rangeMaxKeys.upperBound(min);
+    size_t end = _rangeMaxKeys.upperBound(max);
 
-    // The chunk range map must always cover the entire key space
-    invariant(it != _chunkRangeMap.end());
+    // The ranges must always cover the entire key space
+    invariant(index < _rangeShardIds.size());
 
     // We need to include the last chunk
-    if (end != _chunkRangeMap.cend()) {
+    if (end < _rangeShardIds.size()) {
         ++end;
     }
 
-    for (; it != end; ++it) {
-        shardIds.insert(it->second.getShardId());
+    for (; index < end; ++index) {
+        shardIds.insert(_rangeShardIds[index]);
 
         // No need to iterate through the rest of the ranges, because we already know we need to use
         // all shards.
@@ -780,43 +823,89 @@ string ChunkManager::toString() const {
     return sb.str();
 }
 
-ChunkManager::ChunkRangeMap ChunkManager::_constructRanges(const ChunkMap& chunkMap) {
-    ChunkRangeMap chunkRangeMap =
-        SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<ShardAndChunkRange>();
+void ChunkManager::_buildRoutingTable(const ChunkManager* sameBoundsManager) {
+    _chunksByMaxKey.clear();
+    _chunksByMaxKey.reserve(_chunkMap.size());
+    _rangeMaxKeys = KeyStringIndex();
+    _rangeShardIds.clear();
 
-    if (chunkMap.empty()) {
-        return chunkRangeMap;
+    for (const auto& chunkMapEntry : _chunkMap) {
+        _chunksByMaxKey.push_back(chunkMapEntry.second);
+    }
+
+    if (sameBoundsManager) {
+        invariant(sameBoundsManager->_chunkMaxKeys->size() == _chunkMap.size());
+        _chunkMaxKeys = sameBoundsManager->_chunkMaxKeys;
+    } else {
+        auto chunkMaxKeys = std::make_shared<KeyStringIndex>();
+        for (const auto& chunkMapEntry : _chunkMap) {
+            chunkMaxKeys->push_back(chunkMapEntry.first);
+        }
+        _chunkMaxKeys = std::move(chunkMaxKeys);
+    }
+
+    if (_chunkMap.empty()) {
+        return;
     }
 
-    ChunkMap::const_iterator current = chunkMap.cbegin();
+    ChunkMap::const_iterator current = _chunkMap.cbegin();
+    BSONObj previousRangeMax;
 
-    while (current != chunkMap.cend()) {
+    while (current != _chunkMap.cend()) {
         const auto rangeFirst = current;
         current = std::find_if(
-            current, chunkMap.cend(), [&rangeFirst](const ChunkMap::value_type& chunkMapEntry) {
+            current, _chunkMap.cend(), [&rangeFirst](const ChunkMap::value_type& chunkMapEntry) {
                 return chunkMapEntry.second->getShardId() != rangeFirst->second->getShardId();
             });
         const auto rangeLast = std::prev(current);
 
-        const BSONObj rangeMin = rangeFirst->second->getMin();
-        const BSONObj rangeMax = rangeLast->second->getMax();
+        const BSONObj& rangeMin = rangeFirst->second->getMin();
+        const BSONObj& rangeMax = rangeLast->second->getMax();
 
-        auto insertResult = chunkRangeMap.insert(std::make_pair(
-            rangeMax, ShardAndChunkRange(rangeMin, rangeMax, rangeFirst->second->getShardId())));
-        invariant(insertResult.second);
-        if (insertResult.first != chunkRangeMap.begin()) {
+        if (_rangeShardIds.empty()) {
+            invariant(allOfType(MinKey, rangeMin));
+        } else {
             // Make sure there are no gaps in the ranges
-            insertResult.first--;
-            invariant(
-                SimpleBSONObjComparator::kInstance.evaluate(insertResult.first->first == rangeMin));
+            invariant(SimpleBSONObjComparator::kInstance.evaluate(previousRangeMax == rangeMin));
         }
+
+        _rangeMaxKeys.push_back(rangeMax);
+        _rangeShardIds.push_back(rangeFirst->second->getShardId());
+        previousRangeMax = rangeMax;
     }
 
-    invariant(!chunkRangeMap.empty());
-    invariant(allOfType(MinKey, chunkRangeMap.begin()->second.getMin()));
-    invariant(allOfType(MaxKey, chunkRangeMap.rbegin()->first));
+    invariant(allOfType(MaxKey, previousRangeMax));
+}
+
+void ChunkManager::KeyStringIndex::push_back(const BSONObj& key) {
+    const KeyString encodedKey(KeyString::Version::V1, key, kAllAscending);
+    const StringData encoded(encodedKey.getBuffer(), encodedKey.getSize());
+    invariant(_ends.empty() || encoded.compare(_keyAt(_ends.size() - 1)) > 0);
+
+    _buffer.append(encoded.rawData(), encoded.size());
+    _ends.push_back(_buffer.size());
+}
+
+size_t ChunkManager::KeyStringIndex::upperBound(const BSONObj& key) const {
+    const KeyString encodedKey(KeyString::Version::V1, key, kAllAscending);
+    const StringData encoded(encodedKey.getBuffer(), encodedKey.getSize());
+
+    size_t low = 0;
+    size_t high = _ends.size();
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (_keyAt(mid).compare(encoded) <= 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
 
-    return chunkRangeMap;
+StringData ChunkManager::KeyStringIndex::_keyAt(size_t index) const {
+    const size_t begin = index == 0 ? 0 : _ends[index - 1];
+    return StringData(_buffer.data() + begin, _ends[index] - begin);
 }
 
 uint64_t ChunkManager::getCurrentDesiredChunkSize() const {
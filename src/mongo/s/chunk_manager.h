@@ -39,6 +39,7 @@
 #include "mongo/s/chunk.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/client/shard.h"
+#include "mongo/s/query_targeting_cache.h"
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/util/concurrency/ticketholder.h"
 
@@ -206,51 +207,54 @@ public:
 
 private:
     /**
-     * Represents a range of chunk keys [getMin(), getMax()) and the id of the shard on which they
-     * reside according to the metadata.
+     * The KeyString encodings of an ascending sequence of shard key values, stored back to back in
+     * one contiguous buffer. A lookup is a binary search of memcmp comparisons, which is much
+     * cheaper than BSONObj comparisons while walking the nodes of a tree.
      */
-    class ShardAndChunkRange {
+    class KeyStringIndex {
     public:
-        ShardAndChunkRange(const BSONObj& min, const BSONObj& max, ShardId inShardId)
-            : _range(min, max), _shardId(std::move(inShardId)) {}
+        // Appends 'key', which must be greater than all keys appended before.
+        void push_back(const BSONObj& key);
 
-        const BSONObj& getMin() const {
-            return _range.getMin();
-        }
-
-        const BSONObj& getMax() const {
-            return _range.getMax();
-        }
+        // Returns the position of the first key greater than 'key', or size() if there is none.
+        size_t upperBound(const BSONObj& key) const;
 
-        const ShardId& getShardId() const {
-            return _shardId;
+        size_t size() const {
+            return _ends.size();
         }
 
     private:
-        ChunkRange _range;
-        ShardId _shardId;
-    };
+        StringData _keyAt(size_t index) const;
 
-    // Contains a compressed map of what range of keys resides on which shard. The index is the max
-    // key of the respective range and the union of all ranges in a such constructed map must cover
-    // the complete space from [MinKey, MaxKey).
-    using ChunkRangeMap = BSONObjIndexedMap<ShardAndChunkRange>;
+        // All encoded keys, in order
+        std::string _buffer;
+        // _ends[i] is the offset in _buffer just past the end of the i-th key
+        std::vector<size_t> _ends;
+    };
 
     /**
-     * If load was successful, returns true and it is guaranteed that the _chunkMap and
-     * _chunkRangeMap are consistent with each other. If false is returned, it is not safe to use
-     * the chunk manager anymore.
+     * If load was successful, returns true. If false is returned, it is not safe to use the chunk
+     * manager anymore. Sets 'sameChunkBounds' to whether the loaded chunks have exactly the bounds
+     * of the chunks of 'oldManager'.
      */
     bool _load(OperationContext* txn,
                ChunkMap& chunks,
                std::set<ShardId>& shardIds,
                ShardVersionMap* shardVersions,
-               const ChunkManager* oldManager);
+               const ChunkManager* oldManager,
+               bool* sameChunkBounds);
 
     /**
-     * Merges consecutive chunks, which reside on the same shard into a single range.
+     * Builds the routing table from _chunkMap, merging consecutive chunks, which reside on the
+     * same shard, into a single range. If 'sameBoundsManager' is not null, its chunks have the same
+     * bounds as ours and its encoded chunk bounds are shared instead of encoded again.
      */
-    static ChunkRangeMap _constructRanges(const ChunkMap& chunkMap);
+    void _buildRoutingTable(const ChunkManager* sameBoundsManager);
+
+    /**
+     * Adds the ids of the shards owning any part of 'ranges' to 'shardIds'. Adds at least one.
+     */
+    void _getShardIdsForRanges(const BoundList& ranges, std::set<ShardId>* shardIds) const;
 
     // All members should be const for thread-safety
     const std::string _ns;
@@ -263,8 +267,23 @@ private:
     // connection-level versions to the most up to date value.
     const unsigned long long _sequenceNumber;
 
+    // Targets queries by their shape instead of planning them. It only depends on the shard key
+    // and the default collation, so reloaded chunk managers share it.
+    std::shared_ptr<QueryTargetingCache> _queryTargetingCache;
+
     ChunkMap _chunkMap;
-    ChunkRangeMap _chunkRangeMap;
+
+    // Routing table built from _chunkMap. The max keys of all chunks in ascending order and, at
+    // the same positions, the chunks. The keys are immutable once built, so chunk managers whose
+    // chunks have the same bounds, such as before and after a migration, share them.
+    std::shared_ptr<const KeyStringIndex> _chunkMaxKeys = std::make_shared<KeyStringIndex>();
+    std::vector<std::shared_ptr<Chunk>> _chunksByMaxKey;
+
+    // Compressed view of what range of keys resides on which shard. The max keys of the ranges in
+    // ascending order and, at the same positions, the ids of the shards owning them. The union of
+    // all ranges covers the complete space from [MinKey, MaxKey).
+    KeyStringIndex _rangeMaxKeys;
+    std::vector<ShardId> _rangeShardIds;
 
     std::set<ShardId> _shardIds;
 
@@ -39,6 +39,9 @@
 #include "mongo/s/chunk_manager.h"
 #include "mongo/s/write_ops/batched_command_request.h"
 #include "mongo/s/write_ops/batched_command_response.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -273,5 +276,191 @@ TEST_F(ChunkManagerTests, FullTest) {
     future.timed_get(kFutureTimeout);
 }
 
+/**
+ * Loads a collection with many chunks spread over several shards, checks that lookups find the
+ * right chunks and shards and logs how many lookups per second the routing table serves.
+ */
+TEST_F(ChunkManagerTests, RoutingTableLookups) {
+    OperationContextNoop txn;
+    const string keyName = "_id";
+    const int numShards = 4;
+    const int numChunks = 10000;
+    const int chunkWidth = 10;
+    const int chunksPerRange = 100;
+    const OID epoch = OID::gen();
+
+    std::vector<ShardId> shardIds;
+    std::vector<BSONObj> shards;
+    for (int i = 0; i < numShards; i++) {
+        shardIds.push_back(ShardId(str::stream() << "shard000" << i));
+        shards.push_back(BSON(
+            ShardType::name() << shardIds.back() << ShardType::host()
+                              << ConnectionString(HostAndPort(str::stream() << "host" << i, 27017))
+                                     .toString()));
+    }
+
+    // Chunk i covers [i * chunkWidth, (i + 1) * chunkWidth) and every run of chunksPerRange
+    // consecutive chunks lives on the same shard.
+    auto shardIdForKey = [&](int key) {
+        return shardIds[(key / chunkWidth / chunksPerRange) % numShards];
+    };
+    std::vector<BSONObj> chunks;
+    for (int i = 0; i < numChunks; i++) {
+        ChunkType chunk;
+        chunk.setNS(_collName);
+        chunk.setMin(i == 0 ? BSON(keyName << MINKEY) : BSON(keyName << i * chunkWidth));
+        chunk.setMax(i == numChunks - 1 ? BSON(keyName << MAXKEY)
+                                        : BSON(keyName << (i + 1) * chunkWidth));
+        chunk.setShard(shardIdForKey(i * chunkWidth));
+        chunk.setVersion(ChunkVersion(1, i, epoch));
+        chunks.push_back(chunk.toBSON());
+    }
+
+    CollectionType collType;
+    collType.setNs(NamespaceString{_collName});
+    collType.setEpoch(epoch);
+    collType.setUpdatedAt(jsTime());
+    collType.setKeyPattern(BSON(keyName << 1));
+    collType.setUnique(false);
+    collType.setDropped(false);
+
+    ChunkManager manager(&txn, collType);
+    auto future = launchAsync([&] {
+        manager.loadExistingRanges(operationContext(), nullptr);
+        ASSERT_EQ(numChunks, manager.numChunks());
+    });
+    expectFindOnConfigSendBSONObjVector(chunks);
+    expectFindOnConfigSendBSONObjVector(shards);
+    future.timed_get(kFutureTimeout);
+
+    const int numLookups = 200000;
+    const int keySpace = numChunks * chunkWidth;
+
+    Timer chunkTimer;
+    for (int i = 0; i < numLookups; i++) {
+        const int key = (i * 7919) % keySpace;
+        const BSONObj shardKey = BSON(keyName << key);
+        auto chunk = manager.findIntersectingChunkWithSimpleCollation(operationContext(), shardKey);
+        ASSERT_EQ(shardIdForKey(key), chunk->getShardId());
+    }
+    const long long chunkMicros = std::max(chunkTimer.micros(), 1LL);
+
+    Timer rangeTimer;
+    for (int i = 0; i < numLookups; i++) {
+        const int key = (i * 7919) % keySpace;
+        const BSONObj shardKey = BSON(keyName << key);
+        set<ShardId> rangeShardIds;
+        manager.getShardIdsForRange(rangeShardIds, shardKey, shardKey);
+        ASSERT_EQ(1U, rangeShardIds.size());
+        ASSERT_EQ(shardIdForKey(key), *rangeShardIds.begin());
+    }
+    const long long rangeMicros = std::max(rangeTimer.micros(), 1LL);
+
+    // A range spanning all keys targets every shard.
+    set<ShardId> allShardIds;
+    manager.getShardIdsForRange(allShardIds, BSON(keyName << MINKEY), BSON(keyName << MAXKEY));
+    ASSERT_EQ(static_cast<size_t>(numShards), allShardIds.size());
+
+    log() << "findIntersectingChunk: " << numLookups * 1000000LL / chunkMicros
+          << " lookups/sec, getShardIdsForRange: " << numLookups * 1000000LL / rangeMicros
+          << " lookups/sec over " << numChunks << " chunks";
+}
+
+/**
+ * Tests that chunk managers loaded from an old chunk manager route correctly after a migration,
+ * which keeps the bounds of all chunks, and after a split, which changes them.
+ */
+TEST_F(ChunkManagerTests, RoutingTableAfterIncrementalLoad) {
+    OperationContextNoop txn;
+    const string keyName = "_id";
+    const OID epoch = OID::gen();
+    const ShardId shard0("shard0000");
+    const ShardId shard1("shard0001");
+
+    std::vector<BSONObj> shards{
+        BSON(ShardType::name() << shard0 << ShardType::host()
+                               << ConnectionString(HostAndPort("host0", 27017)).toString()),
+        BSON(ShardType::name() << shard1 << ShardType::host()
+                               << ConnectionString(HostAndPort("host1", 27017)).toString())};
+
+    auto makeChunk = [&](BSONObj min, BSONObj max, const ShardId& shardId, ChunkVersion version) {
+        ChunkType chunk;
+        chunk.setNS(_collName);
+        chunk.setMin(min);
+        chunk.setMax(max);
+        chunk.setShard(shardId);
+        chunk.setVersion(version);
+        return chunk.toBSON();
+    };
+
+    // Chunks [MinKey, 10) and [10, 20) live on shard0, [20, 30) and [30, MaxKey) on shard1.
+    std::vector<BSONObj> chunks{
+        makeChunk(BSON(keyName << MINKEY), BSON(keyName << 10), shard0, ChunkVersion(1, 0, epoch)),
+        makeChunk(BSON(keyName << 10), BSON(keyName << 20), shard0, ChunkVersion(1, 1, epoch)),
+        makeChunk(BSON(keyName << 20), BSON(keyName << 30), shard1, ChunkVersion(1, 2, epoch)),
+        makeChunk(BSON(keyName << 30), BSON(keyName << MAXKEY), shard1, ChunkVersion(1, 3, epoch))};
+
+    CollectionType collType;
+    collType.setNs(NamespaceString{_collName});
+    collType.setEpoch(epoch);
+    collType.setUpdatedAt(jsTime());
+    collType.setKeyPattern(BSON(keyName << 1));
+    collType.setUnique(false);
+    collType.setDropped(false);
+
+    ChunkManager manager(&txn, collType);
+    auto future = launchAsync([&] { manager.loadExistingRanges(operationContext(), nullptr); });
+    expectFindOnConfigSendBSONObjVector(chunks);
+    expectFindOnConfigSendBSONObjVector(shards);
+    future.timed_get(kFutureTimeout);
+
+    auto shardIdsForRange = [&](const ChunkManager& cm, int min, int max) {
+        set<ShardId> shardIds;
+        cm.getShardIdsForRange(shardIds, BSON(keyName << min), BSON(keyName << max));
+        return shardIds;
+    };
+    ASSERT(set<ShardId>{shard0} == shardIdsForRange(manager, 0, 15));
+
+    // Migrate [10, 20) to shard1.
+    ChunkManager migratedManager(&txn, collType);
+    future = launchAsync([&] {
+        migratedManager.loadExistingRanges(operationContext(), &manager);
+
+        ASSERT_EQ(4, migratedManager.numChunks());
+        ASSERT_EQ(ChunkVersion(2, 1, epoch).toString(), migratedManager.getVersion().toString());
+        auto chunk = migratedManager.findIntersectingChunkWithSimpleCollation(
+            operationContext(), BSON(keyName << 15));
+        ASSERT_EQ(shard1, chunk->getShardId());
+        ASSERT(set<ShardId>{shard0} == shardIdsForRange(migratedManager, 0, 5));
+        ASSERT(set<ShardId>{shard1} == shardIdsForRange(migratedManager, 10, 35));
+        ASSERT_EQ(2U, shardIdsForRange(migratedManager, 5, 15).size());
+    });
+    expectFindOnConfigSendBSONObjVector(std::vector<BSONObj>{
+        makeChunk(BSON(keyName << 10), BSON(keyName << 20), shard1, ChunkVersion(2, 0, epoch)),
+        makeChunk(
+            BSON(keyName << MINKEY), BSON(keyName << 10), shard0, ChunkVersion(2, 1, epoch))});
+    future.timed_get(kFutureTimeout);
+
+    // The old manager still routes as before the migration.
+    ASSERT(set<ShardId>{shard0} == shardIdsForRange(manager, 0, 15));
+
+    // Split [20, 30) at 25.
+    ChunkManager splitManager(&txn, collType);
+    future = launchAsync([&] {
+        splitManager.loadExistingRanges(operationContext(), &migratedManager);
+
+        ASSERT_EQ(5, splitManager.numChunks());
+        auto chunk = splitManager.findIntersectingChunkWithSimpleCollation(operationContext(),
+                                                                          BSON(keyName << 27));
+        ASSERT_EQ(25, chunk->getMin()[keyName].numberInt());
+        ASSERT_EQ(shard1, chunk->getShardId());
+        ASSERT(set<ShardId>{shard1} == shardIdsForRange(splitManager, 10, 35));
+    });
+    expectFindOnConfigSendBSONObjVector(std::vector<BSONObj>{
+        makeChunk(BSON(keyName << 20), BSON(keyName << 25), shard1, ChunkVersion(2, 2, epoch)),
+        makeChunk(BSON(keyName << 25), BSON(keyName << 30), shard1, ChunkVersion(2, 3, epoch))});
+    future.timed_get(kFutureTimeout);
+}
+
 }  // namespace
 }  // namespace mongo
@@ -30,9 +30,13 @@
 
 #include "mongo/s/client/dbclient_multi_command.h"
 
+#include <set>
+#include <vector>
+
 #include "mongo/db/audit.h"
 #include "mongo/db/client.h"
 #include "mongo/db/dbmessage.h"
+#include "mongo/db/operation_context.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/rpc/factory.h"
 #include "mongo/rpc/request_builder_interface.h"
@@ -40,6 +44,8 @@
 #include "mongo/s/write_ops/batched_command_request.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/message_port.h"
+#include "mongo/util/net/socket_poll.h"
 
 namespace mongo {
 
@@ -72,6 +78,23 @@ bool hasBatchWriteFeature(DBClientBase* conn) {
     return conn->getMinWireVersion() <= BATCH_COMMANDS &&
         conn->getMaxWireVersion() >= BATCH_COMMANDS;
 }
+
+// Longest a single poll for responses waits before checking whether the operation was interrupted
+const Milliseconds kMaxPollInterval(1000);
+
+/**
+ * Returns the socket which the response to a command sent on the specified connection arrives on,
+ * or nullptr if the connection cannot be polled.
+ */
+Socket* getPollableSocket(DBClientBase* conn) {
+    DBClientConnection* const clientConn = dynamic_cast<DBClientConnection*>(conn);
+    if (!clientConn || clientConn->isFailed()) {
+        return nullptr;
+    }
+
+    MessagingPort* const port = dynamic_cast<MessagingPort*>(&clientConn->port());
+    return port ? &port->getSocket() : nullptr;
+}
 }
 
 // THROWS
@@ -148,7 +171,10 @@ void DBClientMultiCommand::sendAll() {
          it != _pendingCommands.end();
          ++it) {
         PendingCommand* command = *it;
-        dassert(!command->conn);
+
+        // Skip commands which were sent, or failed to send, by an earlier call
+        if (command->conn || !command->status.isOK())
+            continue;
 
         try {
             dassert(command->endpoint.type() == ConnectionString::MASTER ||
@@ -178,9 +204,107 @@ int DBClientMultiCommand::numPending() const {
     return static_cast<int>(_pendingCommands.size());
 }
 
+DBClientMultiCommand::PendingQueue::iterator DBClientMultiCommand::_waitForReadyCommand() {
+    // Responses from the same host are received in the order the commands were sent, so only the
+    // oldest pending command of each host is a candidate
+    std::vector<PendingQueue::iterator> candidates;
+    std::set<std::string> candidateHosts;
+    for (auto it = _pendingCommands.begin(); it != _pendingCommands.end(); ++it) {
+        if (candidateHosts.insert((*it)->endpoint.toString()).second) {
+            candidates.push_back(it);
+        }
+    }
+
+    if (candidates.size() == 1 || !isPollSupported()) {
+        return candidates.front();
+    }
+
+    std::vector<pollfd> pollInfos;
+
+    // The shortest socket timeout of the candidates, and which candidate it belongs to
+    Milliseconds soTimeout = Milliseconds::max();
+    size_t soTimeoutCandidate = 0;
+
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        PendingCommand* const command = *candidates[i];
+
+        // A command which failed to be sent has its error ready to be reported
+        if (!command->status.isOK() || !command->conn) {
+            return candidates[i];
+        }
+
+        DBClientBase* const actualConn =
+            (!_isConfig ? command->conn->get() : command->conn->getRawConn());
+
+        Socket* const socket = getPollableSocket(actualConn);
+        if (!socket) {
+            // Cannot tell when the response arrives, so just block on it
+            return candidates[i];
+        }
+
+        // Data already decrypted by SSL does not show up as readable on the descriptor
+        if (socket->hasBufferedData()) {
+            return candidates[i];
+        }
+
+        const double soTimeoutSecs = actualConn->getSoTimeout();
+        if (soTimeoutSecs > 0) {
+            const Milliseconds candidateTimeout(static_cast<long long>(soTimeoutSecs * 1000));
+            if (candidateTimeout < soTimeout) {
+                soTimeout = candidateTimeout;
+                soTimeoutCandidate = i;
+            }
+        }
+
+        pollfd pollInfo;
+        pollInfo.fd = socket->rawFD();
+        pollInfo.events = POLLIN;
+        pollInfo.revents = 0;
+        pollInfos.push_back(pollInfo);
+    }
+
+    const Date_t deadline =
+        (soTimeout == Milliseconds::max() ? Date_t::max() : Date_t::now() + soTimeout);
+    OperationContext* const txn = (haveClient() ? cc().getOperationContext() : nullptr);
+
+    while (true) {
+        const Date_t now = Date_t::now();
+        if (now >= deadline) {
+            // Let the receive on the connection whose socket timed out report the timeout
+            return candidates[soTimeoutCandidate];
+        }
+
+        if (txn) {
+            Status interruptStatus = txn->checkForInterruptNoAssert();
+            if (!interruptStatus.isOK()) {
+                // The response is abandoned, which makes the connection be discarded
+                (*candidates.front())->status = interruptStatus;
+                return candidates.front();
+            }
+        }
+
+        // Wait for the first response to start arriving. Errors and hangups are reported as events
+        // too, so the receive which follows will surface them.
+        const long long pollTimeoutMillis =
+            durationCount<Milliseconds>(std::min(deadline - now, kMaxPollInterval));
+        const int nEvents = socketPoll(pollInfos.data(), pollInfos.size(), pollTimeoutMillis);
+        if (nEvents < 0) {
+            // Polling failed, so fall back to blocking on the oldest command
+            return candidates.front();
+        }
+
+        for (size_t i = 0; nEvents > 0 && i < pollInfos.size(); ++i) {
+            if (pollInfos[i].revents) {
+                return candidates[i];
+            }
+        }
+    }
+}
+
 Status DBClientMultiCommand::recvAny(ConnectionString* endpoint, BSONSerializable* response) {
-    unique_ptr<PendingCommand> command(_pendingCommands.front());
-    _pendingCommands.pop_front();
+    PendingQueue::iterator readyIt = _waitForReadyCommand();
+    unique_ptr<PendingCommand> command(*readyIt);
+    _pendingCommands.erase(readyIt);
 
     *endpoint = command->endpoint;
     if (!command->status.isOK())
@@ -83,6 +83,14 @@ private:
 
     typedef std::deque<PendingCommand*> PendingQueue;
 
+    /**
+     * Blocks until the response to one of the pending commands starts arriving and returns that
+     * command. Commands to the same host are returned in the order they were added. Waits no longer
+     * than the shortest socket timeout of the connections, and gives up on a command when the
+     * operation is interrupted. Must only be called if there are pending commands.
+     */
+    PendingQueue::iterator _waitForReadyCommand();
+
     const bool _isConfig;
 
     PendingQueue _pendingCommands;
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <deque>
+#include <vector>
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/s/client/multi_command_dispatch.h"
@@ -112,14 +113,25 @@ public:
     /**
      * Returns an error response if the next pending endpoint returned has a corresponding
      * MockEndpoint.
+     *
+     * Endpoints marked slow only respond once nothing is pending on any other endpoint.
      */
     Status recvAny(ConnectionString* endpoint, BSONSerializable* response) override {
         BatchedCommandResponse* batchResponse =  //
             static_cast<BatchedCommandResponse*>(response);
 
-        *endpoint = _pending.front();
-        MockWriteResult* mockResponse = releaseByHost(_pending.front());
-        _pending.pop_front();
+        std::deque<ConnectionString>::iterator readyIt = _pending.begin();
+        while (readyIt != _pending.end() && isSlowHost(*readyIt)) {
+            ++readyIt;
+        }
+        if (readyIt == _pending.end()) {
+            readyIt = _pending.begin();
+        }
+
+        *endpoint = *readyIt;
+        MockWriteResult* mockResponse = releaseByHost(*readyIt);
+        _pending.erase(readyIt);
+        _received.push_back(*endpoint);
 
         if (NULL == mockResponse) {
             batchResponse->setOk(true);
@@ -137,7 +149,32 @@ public:
         return _mockEndpoints.vector();
     }
 
+    /**
+     * Makes responses from the given endpoint wait until no other endpoint has one pending.
+     */
+    void setSlowHost(const ConnectionString& endpoint) {
+        _slowHosts.push_back(endpoint);
+    }
+
+    /**
+     * Returns the endpoints of every response received so far, in the order they were received.
+     */
+    const std::vector<ConnectionString>& getReceivedOrder() const {
+        return _received;
+    }
+
 private:
+    bool isSlowHost(const ConnectionString& endpoint) const {
+        for (std::vector<ConnectionString>::const_iterator it = _slowHosts.begin();
+             it != _slowHosts.end();
+             ++it) {
+            if (it->toString() == endpoint.toString())
+                return true;
+        }
+
+        return false;
+    }
+
     // Find a MockEndpoint* by host, and release it so we don't see it again
     MockWriteResult* releaseByHost(const ConnectionString& endpoint) {
         std::vector<MockWriteResult*>& endpoints = _mockEndpoints.mutableVector();
@@ -158,6 +195,10 @@ private:
     OwnedPointerVector<MockWriteResult> _mockEndpoints;
 
     std::deque<ConnectionString> _pending;
+
+    std::vector<ConnectionString> _slowHosts;
+
+    std::vector<ConnectionString> _received;
 };
 
 }  // namespace mongo
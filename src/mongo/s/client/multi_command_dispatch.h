@@ -59,9 +59,10 @@ public:
                             const BSONObj& request) = 0;
 
     /**
-     * Sends all the commands in this dispatch to their endpoints, in undefined order and
-     * without waiting for responses.  May block on full send queue (though this should be
-     * rare).
+     * Sends all the commands in this dispatch which have not been sent yet to their endpoints,
+     * in undefined order and without waiting for responses.  May block on full send queue
+     * (though this should be rare).  Commands may be added and sent again while earlier ones
+     * are still pending.
      *
      * Any error which occurs during sendAll will be reported on recvAny, *does not throw.*
      */
@@ -74,7 +75,8 @@ public:
 
     /**
      * Blocks until a command response has come back.  Any outstanding command response may be
-     * returned with associated endpoint.
+     * returned with associated endpoint, but the responses from the same endpoint are returned in
+     * the order the commands were added.
      *
      * Returns !OK on send/recv/parse failure, otherwise command-level errors are returned in
      * the response object itself.
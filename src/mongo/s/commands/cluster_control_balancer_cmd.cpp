@@ -121,10 +121,18 @@ public:
         : BalancerControlCommand("balancerStatus", "_configsvrBalancerStatus", ActionType::find) {}
 };
 
+class BalancerExplainCommand : public BalancerControlCommand {
+public:
+    BalancerExplainCommand()
+        : BalancerControlCommand("balancerExplain", "_configsvrBalancerExplain", ActionType::find) {
+    }
+};
+
 MONGO_INITIALIZER(ClusterBalancerControlCommands)(InitializerContext* context) {
     new BalancerStartCommand();
     new BalancerStopCommand();
     new BalancerStatusCommand();
+    new BalancerExplainCommand();
 
     return Status::OK();
 }
@@ -32,10 +32,13 @@
 
 #include "mongo/s/query/async_results_merger.h"
 
+#include <algorithm>
+
 #include "mongo/client/remote_command_targeter.h"
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/killcursors_request.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/rpc/metadata/server_selection_metadata.h"
@@ -51,13 +54,19 @@ namespace {
 // Maximum number of retries for network and replication notMaster errors (per host).
 const int kMaxNumFailedHostRetryAttempts = 3;
 
+// Upper bound on the number of fields of a sort pattern, which an Ordering can describe. Sort keys
+// of wider sort patterns are merged without encoding them first.
+const int kMaxEncodedSortKeyFields = 32;
+
 }  // namespace
 
 AsyncResultsMerger::AsyncResultsMerger(executor::TaskExecutor* executor,
                                        ClusterClientCursorParams&& params)
     : _executor(executor),
       _params(std::move(params)),
-      _mergeQueue(MergingComparator(_remotes, _params.sort)) {
+      _encodedSortKeys(_params.sort.nFields() <= kMaxEncodedSortKeyFields),
+      _sortKeyOrdering(Ordering::make(_encodedSortKeys ? _params.sort : BSONObj())),
+      _mergeQueueComparator(_remotes, _params.sort, _encodedSortKeys) {
     for (const auto& remote : _params.remotes) {
         if (remote.shardId) {
             invariant(remote.cmdObj);
@@ -72,6 +81,10 @@ AsyncResultsMerger::AsyncResultsMerger(executor::TaskExecutor* executor,
         }
     }
 
+    if (!_params.sort.isEmpty()) {
+        _mergeQueue.reserve(_remotes.size());
+    }
+
     // Initialize command metadata to handle the read preference.
     if (_params.readPreference) {
         BSONObjBuilder metadataBuilder;
@@ -210,24 +223,44 @@ ClusterQueryResult AsyncResultsMerger::nextReadySorted() {
         return {};
     }
 
-    size_t smallestRemote = _mergeQueue.top();
-    _mergeQueue.pop();
+    std::pop_heap(_mergeQueue.begin(), _mergeQueue.end(), _mergeQueueComparator);
+    const size_t smallestRemote = _mergeQueue.back();
+    _mergeQueue.pop_back();
 
-    invariant(!_remotes[smallestRemote].docBuffer.empty());
-    invariant(_remotes[smallestRemote].status.isOK());
+    auto& remote = _remotes[smallestRemote];
+    invariant(!remote.docBuffer.empty());
+    invariant(remote.status.isOK());
 
-    ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
-    _remotes[smallestRemote].docBuffer.pop();
+    ClusterQueryResult front = std::move(remote.docBuffer.front());
+    remote.docBuffer.pop();
 
     // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
     // next result.
-    if (!_remotes[smallestRemote].docBuffer.empty()) {
-        _mergeQueue.push(smallestRemote);
+    if (!remote.docBuffer.empty()) {
+        pushToMergeQueue_inlock(smallestRemote);
     }
 
     return front;
 }
 
+void AsyncResultsMerger::pushToMergeQueue_inlock(size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+    invariant(remote.hasNext());
+
+    if (_encodedSortKeys) {
+        // The encoding ignores field names, like comparing the $sortKey documents against the sort
+        // pattern would. It does not need to account for a collator, since mongod has already
+        // mapped strings to their ICU comparison keys as part of the $sortKey meta projection.
+        const BSONObj sortKey =
+            (*remote.docBuffer.front().getResult())[ClusterClientCursorParams::kSortKeyField].Obj();
+        const KeyString encodedSortKey(KeyString::Version::V1, sortKey, _sortKeyOrdering);
+        remote.frontSortKey.assign(encodedSortKey.getBuffer(), encodedSortKey.getSize());
+    }
+
+    _mergeQueue.push_back(remoteIndex);
+    std::push_heap(_mergeQueue.begin(), _mergeQueue.end(), _mergeQueueComparator);
+}
+
 ClusterQueryResult AsyncResultsMerger::nextReadyUnsorted() {
     size_t remotesAttempted = 0;
     while (remotesAttempted < _remotes.size()) {
@@ -235,7 +268,7 @@ ClusterQueryResult AsyncResultsMerger::nextReadyUnsorted() {
         invariant(_remotes[_gettingFromRemote].status.isOK());
 
         if (_remotes[_gettingFromRemote].hasNext()) {
-            ClusterQueryResult front = _remotes[_gettingFromRemote].docBuffer.front();
+            ClusterQueryResult front = std::move(_remotes[_gettingFromRemote].docBuffer.front());
             _remotes[_gettingFromRemote].docBuffer.pop();
 
             if (_params.isTailable && !_remotes[_gettingFromRemote].hasNext()) {
@@ -546,15 +579,14 @@ void AsyncResultsMerger::handleBatchResponse(
             return;
         }
 
-        ClusterQueryResult result(obj);
-        remote.docBuffer.push(result);
+        remote.docBuffer.emplace(obj);
         ++remote.fetchedCount;
     }
 
     // If we're doing a sorted merge, then we have to make sure to put this remote onto the
     // merge queue.
     if (!_params.sort.isEmpty() && !cursorResponse.getBatch().empty()) {
-        _mergeQueue.push(remoteIndex);
+        pushToMergeQueue_inlock(remoteIndex);
     }
 
     // If the cursor is tailable and we just received an empty batch, the next return value should
@@ -718,7 +750,11 @@ std::shared_ptr<Shard> AsyncResultsMerger::RemoteCursorData::getShard() {
 // AsyncResultsMerger::MergingComparator
 //
 
-bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
+bool AsyncResultsMerger::MergingComparator::operator()(size_t lhs, size_t rhs) const {
+    if (_encodedSortKeys) {
+        return _remotes[lhs].frontSortKey > _remotes[rhs].frontSortKey;
+    }
+
     const ClusterQueryResult& leftDoc = _remotes[lhs].docBuffer.front();
     const ClusterQueryResult& rightDoc = _remotes[rhs].docBuffer.front();
 
@@ -30,11 +30,13 @@
 
 #include <boost/optional.hpp>
 #include <queue>
+#include <string>
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/bson/ordering.h"
 #include "mongo/db/cursor_id.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/s/query/cluster_client_cursor_params.h"
@@ -242,6 +244,12 @@ private:
         boost::optional<CursorId> cursorId;
 
         std::queue<ClusterQueryResult> docBuffer;
+
+        // KeyString encoding of the sort key of the document at the front of 'docBuffer'. Only
+        // used for sorted merges on sort patterns an Ordering can describe, and only valid while
+        // this remote is in the merge queue.
+        std::string frontSortKey;
+
         executor::TaskExecutor::CallbackHandle cbHandle;
         Status status = Status::OK();
 
@@ -260,17 +268,26 @@ private:
         boost::optional<HostAndPort> _shardHostAndPort;
     };
 
+    /**
+     * Orders the remotes in the merge queue so that the remote with the smallest sort key comes
+     * first. Compares the encoded sort keys of the documents at the front of their buffers, unless
+     * 'encodedSortKeys' is false, in which case the $sortKey documents themselves are compared.
+     */
     class MergingComparator {
     public:
-        MergingComparator(const std::vector<RemoteCursorData>& remotes, const BSONObj& sort)
-            : _remotes(remotes), _sort(sort) {}
+        MergingComparator(const std::vector<RemoteCursorData>& remotes,
+                          const BSONObj& sort,
+                          bool encodedSortKeys)
+            : _remotes(remotes), _sort(sort), _encodedSortKeys(encodedSortKeys) {}
 
-        bool operator()(const size_t& lhs, const size_t& rhs);
+        bool operator()(size_t lhs, size_t rhs) const;
 
     private:
         const std::vector<RemoteCursorData>& _remotes;
 
         const BSONObj& _sort;
+
+        const bool _encodedSortKeys;
     };
 
     enum LifecycleState { kAlive, kKillStarted, kKillComplete };
@@ -319,6 +336,13 @@ private:
     ClusterQueryResult nextReadySorted();
     ClusterQueryResult nextReadyUnsorted();
 
+    /**
+     * Encodes the sort key of the next buffered result of the remote at 'remoteIndex' and adds the
+     * remote to the merge queue. The remote must have a buffered result and must not already be
+     * in the merge queue.
+     */
+    void pushToMergeQueue_inlock(size_t remoteIndex);
+
     /**
      * When nextEvent() schedules remote work, it passes this method as a callback. The TaskExecutor
      * will call this function, passing the response from the remote.
@@ -365,9 +389,17 @@ private:
     // Data tracking the state of our communication with each of the remote nodes.
     std::vector<RemoteCursorData> _remotes;
 
-    // The top of this priority queue is the index into '_remotes' for the remote host that has the
-    // next document to return, according to the sort order. Used only if there is a sort.
-    std::priority_queue<size_t, std::vector<size_t>, MergingComparator> _mergeQueue;
+    // Ordering of the fields of the $sortKey documents, which is used to encode them as KeyStrings.
+    // Sort keys are encoded once per document, so that merging them takes memcmp comparisons only.
+    // Used only if there is a sort, and only if '_encodedSortKeys' is true.
+    const bool _encodedSortKeys;
+    const Ordering _sortKeyOrdering;
+
+    // Binary heap of the indexes into '_remotes' of the remote hosts, which have buffered results.
+    // The first entry is the remote that has the next document to return, according to the sort
+    // order. Used only if there is a sort.
+    std::vector<size_t> _mergeQueue;
+    const MergingComparator _mergeQueueComparator;
 
     // The index into '_remotes' for the remote from which we are currently retrieving results.
     // Used only if there is *not* a sort.
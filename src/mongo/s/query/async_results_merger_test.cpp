@@ -30,6 +30,8 @@
 
 #include "mongo/s/query/async_results_merger.h"
 
+#include <algorithm>
+
 #include "mongo/client/remote_command_targeter_factory_mock.h"
 #include "mongo/client/remote_command_targeter_mock.h"
 #include "mongo/db/json.h"
@@ -45,6 +47,7 @@
 #include "mongo/s/sharding_test_fixture.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -515,6 +518,71 @@ TEST_F(AsyncResultsMergerTest, ClusterFindCompoundSortKey) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, ClusterFindSortedMergesLargeBatches) {
+    const BSONObj sortPattern = BSON("a" << 1 << "b" << -1);
+    const int kDocsPerShard = 20000;
+
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: 1, b: -1}}");
+    makeCursorFromFindCmd(findCmd, kTestShardIds);
+
+    ASSERT_FALSE(arm->ready());
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    ASSERT_FALSE(arm->ready());
+
+    const auto sortKeyLess = [&sortPattern](const BSONObj& lhs, const BSONObj& rhs) {
+        return lhs[ClusterClientCursorParams::kSortKeyField].Obj().woCompare(
+                   rhs[ClusterClientCursorParams::kSortKeyField].Obj(), sortPattern, false) < 0;
+    };
+
+    // Every shard returns its whole result set in a single batch. Numbers of different types,
+    // which compare equal, are mixed across shards.
+    std::vector<BSONObj> allDocs;
+    std::vector<CursorResponse> responses;
+    for (size_t shard = 0; shard < kTestShardIds.size(); ++shard) {
+        std::vector<BSONObj> batch;
+        for (int i = 0; i < kDocsPerShard; ++i) {
+            const int b = (i * 7 + static_cast<int>(shard)) % 13;
+            BSONObjBuilder sortKey;
+            sortKey.append("", i / 4);
+            if (shard == 1) {
+                sortKey.append("", static_cast<double>(b));
+            } else {
+                sortKey.append("", b);
+            }
+            batch.push_back(BSON("shard" << static_cast<int>(shard) << "i" << i
+                                         << ClusterClientCursorParams::kSortKeyField
+                                         << sortKey.obj()));
+        }
+        std::sort(batch.begin(), batch.end(), sortKeyLess);
+        allDocs.insert(allDocs.end(), batch.begin(), batch.end());
+        responses.emplace_back(_nss, CursorId(0), batch);
+    }
+    std::stable_sort(allDocs.begin(), allDocs.end(), sortKeyLess);
+
+    scheduleNetworkResponses(std::move(responses), CursorResponse::ResponseType::InitialResponse);
+    executor()->waitForEvent(readyEvent);
+
+    Timer timer;
+    std::vector<BSONObj> merged;
+    merged.reserve(allDocs.size());
+    while (true) {
+        ASSERT_TRUE(arm->ready());
+        auto next = unittest::assertGet(arm->nextReady());
+        if (next.isEOF()) {
+            break;
+        }
+        merged.push_back(*next.getResult());
+    }
+    unittest::log() << "Merged " << merged.size() << " documents from " << kTestShardIds.size()
+                    << " shards in " << timer.micros() << " micros";
+
+    ASSERT_EQ(allDocs.size(), merged.size());
+    for (size_t i = 0; i < merged.size(); ++i) {
+        ASSERT_FALSE(sortKeyLess(merged[i], allDocs[i]));
+        ASSERT_FALSE(sortKeyLess(allDocs[i], merged[i]));
+    }
+}
+
 TEST_F(AsyncResultsMergerTest, ClusterFindSortedButNoSortKey) {
     BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: -1, b: 1}, batchSize: 2}");
     makeCursorFromFindCmd(findCmd, {kTestShardIds[0]});
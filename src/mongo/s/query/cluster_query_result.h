@@ -51,7 +51,7 @@ public:
         return !_resultObj && !_viewDefinition;
     }
 
-    boost::optional<BSONObj> getResult() const {
+    const boost::optional<BSONObj>& getResult() const {
         return _resultObj;
     }
 
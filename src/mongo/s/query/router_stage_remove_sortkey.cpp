@@ -34,7 +34,6 @@
 
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/s/query/cluster_client_cursor_params.h"
-#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
@@ -47,15 +46,22 @@ StatusWith<ClusterQueryResult> RouterStageRemoveSortKey::next() {
         return childResult;
     }
 
-    const auto& childObj = childResult.getValue().getResult();
-
-    BSONObjBuilder builder;
-    for (BSONElement elt : *childObj) {
-        if (!str::equals(elt.fieldName(), ClusterClientCursorParams::kSortKeyField)) {
-            builder.append(elt);
-        }
+    const BSONObj& childObj = *childResult.getValue().getResult();
+    const BSONElement sortKeyElt = childObj[ClusterClientCursorParams::kSortKeyField];
+    if (sortKeyElt.eoo()) {
+        return childResult;
     }
 
+    // Copy the fields before and after $sortKey as two contiguous byte ranges, rather than
+    // appending them one element at a time. The -1 leaves out the terminal EOO of 'childObj'.
+    const char* const sortKeyBegin = sortKeyElt.rawdata();
+    const char* const sortKeyEnd = sortKeyBegin + sortKeyElt.size();
+    const char* const fieldsBegin = childObj.objdata() + sizeof(int32_t);
+    const char* const fieldsEnd = childObj.objdata() + childObj.objsize() - 1;
+
+    BSONObjBuilder builder(childObj.objsize() - sortKeyElt.size());
+    builder.bb().appendBuf(fieldsBegin, sortKeyBegin - fieldsBegin);
+    builder.bb().appendBuf(sortKeyEnd, fieldsEnd - sortKeyEnd);
     return {builder.obj()};
 }
 
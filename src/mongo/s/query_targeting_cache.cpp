@@ -0,0 +1,353 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/query_targeting_cache.h"
+
+#include <algorithm>
+
+#include "mongo/base/counter.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/hasher.h"
+#include "mongo/db/query/collation/collation_spec.h"
+#include "mongo/db/server_parameters.h"
+
+namespace mongo {
+namespace {
+
+// Maximum number of query shapes cached per sharded collection
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryTargetingCacheSize, int, 500);
+
+Counter64 targetingCacheHits;
+Counter64 targetingCacheMisses;
+Counter64 targetingCacheNotTargetable;
+
+ServerStatusMetricField<Counter64> displayTargetingCacheHits("query.targetingCache.hits",
+                                                             &targetingCacheHits);
+ServerStatusMetricField<Counter64> displayTargetingCacheMisses("query.targetingCache.misses",
+                                                               &targetingCacheMisses);
+ServerStatusMetricField<Counter64> displayTargetingCacheNotTargetable(
+    "query.targetingCache.notTargetable", &targetingCacheNotTargetable);
+
+/**
+ * Returns whether documents compared against 'constant' can be targeted by the value of the
+ * constant alone. Excludes nulls, which match missing fields, arrays, which match their elements,
+ * and types whose comparisons have other special cases.
+ */
+bool isTargetableConstant(const BSONElement& constant) {
+    switch (constant.type()) {
+        case NumberInt:
+        case NumberLong:
+        case NumberDouble:
+        case NumberDecimal:
+        case String:
+        case jstOID:
+        case Date:
+        case bsonTimestamp:
+        case Bool:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool isComparisonOperator(StringData op) {
+    return op == "$eq" || op == "$gt" || op == "$gte" || op == "$lt" || op == "$lte" ||
+        op == "$ne";
+}
+
+/**
+ * Returns whether 'prefix' is a strict path prefix of 'path', such as "a" of "a.b".
+ */
+bool isPathPrefixOf(StringData prefix, StringData path) {
+    return path.size() > prefix.size() && path[prefix.size()] == '.' && path.startsWith(prefix);
+}
+
+/**
+ * Splits 'query' into the paths, operators and constants of its predicates, in query order, and
+ * appends the shape of the query to 'shape'. Implicit equalities have an empty operator. Returns
+ * false if the query is not a conjunction of comparisons of top-level paths against constants.
+ */
+bool parseSimpleQuery(const BSONObj& query,
+                      std::string* shape,
+                      std::vector<StringData>* paths,
+                      std::vector<StringData>* operators,
+                      std::vector<BSONElement>* constants) {
+    const auto addPredicate = [&](StringData path, StringData op, const BSONElement& constant) {
+        // Field names cannot contain null bytes, which makes the shape unambiguous.
+        shape->append(path.rawData(), path.size());
+        shape->push_back('\0');
+        shape->append(op.rawData(), op.size());
+        shape->push_back('\0');
+        shape->push_back(static_cast<char>(constant.type()));
+
+        paths->push_back(path);
+        operators->push_back(op);
+        constants->push_back(constant);
+    };
+
+    for (auto&& elem : query) {
+        const StringData path = elem.fieldNameStringData();
+        if (path.empty() || path[0] == '$') {
+            return false;
+        }
+
+        if (elem.type() != Object) {
+            if (!isTargetableConstant(elem)) {
+                return false;
+            }
+            addPredicate(path, StringData(), elem);
+            continue;
+        }
+
+        // An empty object or an object, which does not consist of operators only, is compared as
+        // a whole.
+        const BSONObj operand = elem.Obj();
+        if (operand.isEmpty()) {
+            return false;
+        }
+        for (auto&& operandElem : operand) {
+            const StringData op = operandElem.fieldNameStringData();
+            if (!isComparisonOperator(op) || !isTargetableConstant(operandElem)) {
+                return false;
+            }
+            addPredicate(path, op, operandElem);
+        }
+    }
+
+    return true;
+}
+
+}  // namespace
+
+QueryTargetingCache::QueryTargetingCache(const ShardKeyPattern& shardKeyPattern,
+                                         bool simpleDefaultCollation)
+    : _shardKeyPattern(shardKeyPattern.getKeyPattern()),
+      _simpleDefaultCollation(simpleDefaultCollation),
+      _entries(std::max(internalQueryTargetingCacheSize.load(), 1)) {
+    for (auto&& keyField : _shardKeyPattern.toBSON()) {
+        _shardKeyPaths.push_back(keyField.fieldName());
+    }
+}
+
+boost::optional<BoundList> QueryTargetingCache::getRanges(const BSONObj& query,
+                                                          const BSONObj& collation) {
+    if (!collation.isEmpty() &&
+        !SimpleBSONObjComparator::kInstance.evaluate(collation == CollationSpec::kSimpleSpec)) {
+        targetingCacheNotTargetable.increment();
+        return boost::none;
+    }
+    const bool simpleCollation = !collation.isEmpty() || _simpleDefaultCollation;
+
+    // The collation decides whether strings can be targeted, so it is part of the shape.
+    std::string shape(1, simpleCollation ? 's' : 'c');
+    std::vector<StringData> paths;
+    std::vector<StringData> operators;
+    std::vector<BSONElement> constants;
+    if (!parseSimpleQuery(query, &shape, &paths, &operators, &constants)) {
+        targetingCacheNotTargetable.increment();
+        return boost::none;
+    }
+
+    Entry entry;
+    bool cached = false;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+        Entry* cachedEntry;
+        if (_entries.get(shape, &cachedEntry).isOK()) {
+            entry = *cachedEntry;
+            cached = true;
+        }
+    }
+
+    if (!cached) {
+        entry = _makeEntry(paths, operators, constants, simpleCollation);
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _entries.add(shape, new Entry(entry));
+    }
+
+    // Each lookup is counted exactly once: as not targetable whether or not its shape was cached,
+    // otherwise as a hit or a miss
+    if (!entry.targetable) {
+        targetingCacheNotTargetable.increment();
+        return boost::none;
+    }
+
+    if (cached) {
+        targetingCacheHits.increment();
+    } else {
+        targetingCacheMisses.increment();
+    }
+
+    return _makeRanges(entry, constants);
+}
+
+size_t QueryTargetingCache::size() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _entries.size();
+}
+
+QueryTargetingCache::Entry QueryTargetingCache::_makeEntry(
+    const std::vector<StringData>& paths,
+    const std::vector<StringData>& operators,
+    const std::vector<BSONElement>& constants,
+    bool simpleCollation) const {
+    Entry entry;
+    entry.bounds.reserve(paths.size());
+
+    for (size_t i = 0; i < paths.size(); ++i) {
+        Bound bound{BoundType::kNone, 0};
+
+        for (size_t keyField = 0; keyField < _shardKeyPaths.size(); ++keyField) {
+            const StringData keyPath(_shardKeyPaths[keyField]);
+            if (paths[i] == keyPath) {
+                bound.shardKeyField = keyField;
+                if (operators[i].empty() || operators[i] == "$eq") {
+                    bound.type = BoundType::kEquality;
+                } else if (operators[i] == "$gt" || operators[i] == "$gte") {
+                    bound.type = BoundType::kLower;
+                } else if (operators[i] == "$lt" || operators[i] == "$lte") {
+                    bound.type = BoundType::kUpper;
+                }
+                break;
+            }
+
+            // Predicates on paths into or above a shard key field can match documents in ways
+            // which only planning accounts for, such as through arrays.
+            if (isPathPrefixOf(paths[i], keyPath) || isPathPrefixOf(keyPath, paths[i])) {
+                return Entry();
+            }
+        }
+
+        if (bound.type != BoundType::kNone) {
+            // Strings, which are equal under a non-simple collation, may differ in the shard key.
+            if (!simpleCollation && constants[i].type() == String) {
+                return Entry();
+            }
+
+            // Hashing does not preserve the order of the values.
+            if (_shardKeyPattern.isHashedPattern() && bound.type != BoundType::kEquality) {
+                bound.type = BoundType::kNone;
+            }
+        }
+
+        entry.bounds.push_back(bound);
+    }
+
+    entry.targetable = true;
+    return entry;
+}
+
+BoundList QueryTargetingCache::_makeRanges(const Entry& entry,
+                                           const std::vector<BSONElement>& constants) const {
+    invariant(entry.bounds.size() == constants.size());
+
+    // The greatest lower and the least upper bound of every shard key field. Equalities bound a
+    // field from both sides.
+    std::vector<BSONElement> lowerBounds(_shardKeyPaths.size());
+    std::vector<BSONElement> upperBounds(_shardKeyPaths.size());
+    for (size_t i = 0; i < constants.size(); ++i) {
+        const Bound& bound = entry.bounds[i];
+        if (bound.type == BoundType::kNone) {
+            continue;
+        }
+
+        BSONElement& lower = lowerBounds[bound.shardKeyField];
+        if (bound.type != BoundType::kUpper &&
+            (lower.eoo() || constants[i].woCompare(lower, false) > 0)) {
+            lower = constants[i];
+        }
+
+        BSONElement& upper = upperBounds[bound.shardKeyField];
+        if (bound.type != BoundType::kLower &&
+            (upper.eoo() || constants[i].woCompare(upper, false) < 0)) {
+            upper = constants[i];
+        }
+    }
+
+    BSONObjBuilder minBuilder;
+    BSONObjBuilder maxBuilder;
+
+    if (_shardKeyPattern.isHashedPattern()) {
+        // Hashed shard keys have a single field, which is only bounded by equalities.
+        invariant(_shardKeyPaths.size() == 1);
+        const StringData keyPath(_shardKeyPaths.front());
+
+        if (lowerBounds.front().eoo()) {
+            minBuilder.appendMinKey(keyPath);
+            maxBuilder.appendMaxKey(keyPath);
+        } else {
+            const long long hash = BSONElementHasher::hash64(lowerBounds.front(),
+                                                             BSONElementHasher::DEFAULT_HASH_SEED);
+            minBuilder.append(keyPath, hash);
+            maxBuilder.append(keyPath, hash);
+        }
+
+        return {{minBuilder.obj(), maxBuilder.obj()}};
+    }
+
+    // Once a shard key field is not bounded to a single value, the fields after it can have any
+    // value within the range.
+    bool pointPrefix = true;
+    for (size_t keyField = 0; keyField < _shardKeyPaths.size(); ++keyField) {
+        const StringData keyPath(_shardKeyPaths[keyField]);
+        const BSONElement& lower = lowerBounds[keyField];
+        const BSONElement& upper = upperBounds[keyField];
+
+        if (!pointPrefix || (lower.eoo() && upper.eoo())) {
+            minBuilder.appendMinKey(keyPath);
+            maxBuilder.appendMaxKey(keyPath);
+            pointPrefix = false;
+            continue;
+        }
+
+        // Comparisons only match values of the same canonical type as the constant.
+        if (lower.eoo()) {
+            minBuilder.appendMinForType(keyPath, upper.type());
+        } else {
+            minBuilder.appendAs(lower, keyPath);
+        }
+
+        if (upper.eoo()) {
+            maxBuilder.appendMaxForType(keyPath, lower.type());
+        } else {
+            maxBuilder.appendAs(upper, keyPath);
+        }
+
+        pointPrefix = !lower.eoo() && !upper.eoo() && lower.woCompare(upper, false) == 0;
+    }
+
+    return {{minBuilder.obj(), maxBuilder.obj()}};
+}
+
+}  // namespace mongo
@@ -0,0 +1,130 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/query/lru_key_value.h"
+#include "mongo/s/shard_key_pattern.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+/**
+ * Targets simple queries on mongos without canonicalizing and planning them against the shard key.
+ *
+ * Most queries routed by mongos differ only in their constants. The ranges of shard key values a
+ * query may touch depend on which of its predicates constrain which shard key field, which is
+ * fixed by the shape of the query, and on the constants of those predicates. This cache remembers
+ * per query shape which predicate bounds which shard key field, so that targeting another query of
+ * the same shape only substitutes its constants.
+ *
+ * Only conjunctions of comparisons of top-level paths against scalar constants are supported, such
+ * as {a: 5, b: {$gte: "x", $lt: "y"}}. All other queries must be planned.
+ *
+ * The computed ranges may be wider than the index bounds planning computes, but never narrower, so
+ * a query never misses a shard with matching documents.
+ *
+ * Thread-safe.
+ */
+class QueryTargetingCache {
+    MONGO_DISALLOW_COPYING(QueryTargetingCache);
+
+public:
+    /**
+     * 'simpleDefaultCollation' is whether the collection, which is sharded by 'shardKeyPattern',
+     * has the simple default collation.
+     */
+    QueryTargetingCache(const ShardKeyPattern& shardKeyPattern, bool simpleDefaultCollation);
+
+    /**
+     * Returns the ranges of shard key values, which documents matching 'query' with 'collation'
+     * may have, or boost::none if the query must be planned to target it. If 'collation' is empty,
+     * the collection default collation is used.
+     */
+    boost::optional<BoundList> getRanges(const BSONObj& query, const BSONObj& collation);
+
+    /**
+     * Returns the number of cached query shapes.
+     */
+    size_t size() const;
+
+private:
+    // How a constant of a query shape bounds the values of a shard key field.
+    enum class BoundType { kNone, kEquality, kLower, kUpper };
+
+    struct Bound {
+        BoundType type;
+
+        // Index of the shard key field, which is bounded. Unused for kNone.
+        size_t shardKeyField;
+    };
+
+    // The bounds of the constants of a query shape, in the order of the constants in the query.
+    // Shapes which cannot be targeted without planning are cached as well, as not 'targetable'.
+    struct Entry {
+        bool targetable = false;
+        std::vector<Bound> bounds;
+    };
+
+    /**
+     * Computes the entry for the query shape of the specified top-level paths, operators and
+     * constants. The strings of the constants are compared with the simple collation only if
+     * 'simpleCollation' is true.
+     */
+    Entry _makeEntry(const std::vector<StringData>& paths,
+                     const std::vector<StringData>& operators,
+                     const std::vector<BSONElement>& constants,
+                     bool simpleCollation) const;
+
+    /**
+     * Builds the range of shard key values, which documents matching a query with 'constants' may
+     * have, given the bounds of the query shape.
+     */
+    BoundList _makeRanges(const Entry& entry, const std::vector<BSONElement>& constants) const;
+
+    const ShardKeyPattern _shardKeyPattern;
+
+    // Dotted paths of the shard key fields, in shard key order
+    std::vector<std::string> _shardKeyPaths;
+
+    const bool _simpleDefaultCollation;
+
+    // Protects '_entries'
+    mutable stdx::mutex _mutex;
+
+    // Query shape -> how its constants bound the shard key fields
+    LRUKeyValue<std::string, Entry> _entries;
+};
+
+}  // namespace mongo
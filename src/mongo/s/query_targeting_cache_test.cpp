@@ -0,0 +1,191 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/query_targeting_cache.h"
+
+#include "mongo/db/hasher.h"
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+void assertSingleRange(const boost::optional<BoundList>& ranges,
+                       const BSONObj& min,
+                       const BSONObj& max) {
+    ASSERT(ranges);
+    ASSERT_EQ(1U, ranges->size());
+    ASSERT_BSONOBJ_EQ(min, ranges->front().first);
+    ASSERT_BSONOBJ_EQ(max, ranges->front().second);
+}
+
+TEST(QueryTargetingCacheTest, EqualityOnShardKeyTargetsSingleValue) {
+    QueryTargetingCache cache(ShardKeyPattern(BSON("a" << 1)), true);
+
+    assertSingleRange(cache.getRanges(fromjson("{a: 5, b: 'x'}"), BSONObj()),
+                      BSON("a" << 5),
+                      BSON("a" << 5));
+    assertSingleRange(cache.getRanges(fromjson("{a: {$eq: 7}, b: 'y'}"), BSONObj()),
+                      BSON("a" << 7),
+                      BSON("a" << 7));
+}
+
+TEST(QueryTargetingCacheTest, QueriesOfSameShapeShareEntry) {
+    QueryTargetingCache cache(ShardKeyPattern(BSON("a" << 1)), true);
+
+    assertSingleRange(
+        cache.getRanges(fromjson("{a: 5, b: 'x'}"), BSONObj()), BSON("a" << 5), BSON("a" << 5));
+    ASSERT_EQ(1U, cache.size());
+
+    // Only the constants differ, so the cached shape is used.
+    assertSingleRange(
+        cache.getRanges(fromjson("{a: 8, b: 'z'}"), BSONObj()), BSON("a" << 8), BSON("a" << 8));
+    ASSERT_EQ(1U, cache.size());
+
+    // A constant of another type makes another shape.
+    assertSingleRange(cache.getRanges(fromjson("{a: 'str', b: 'z'}"), BSONObj()),
+                      BSON("a"
+                           << "str"),
+                      BSON("a"
+                           << "str"));
+    ASSERT_EQ(2U, cache.size());
+}
+
+TEST(QueryTargetingCacheTest, RangeIsBracketedByType) {
+    QueryTargetingCache cache(ShardKeyPattern(BSON("a" << 1)), true);
+
+    assertSingleRange(cache.getRanges(fromjson("{a: {$gte: 5, $lt: 10}}"), BSONObj()),
+                      BSON("a" << 5),
+                      BSON("a" << 10));
+
+    BSONObjBuilder maxBuilder;
+    maxBuilder.appendMaxForType("a", NumberInt);
+    assertSingleRange(cache.getRanges(fromjson("{a: {$gt: 5}}"), BSONObj()),
+                      BSON("a" << 5),
+                      maxBuilder.obj());
+
+    BSONObjBuilder minBuilder;
+    minBuilder.appendMinForType("a", String);
+    assertSingleRange(cache.getRanges(fromjson("{a: {$lte: 'm'}}"), BSONObj()),
+                      minBuilder.obj(),
+                      BSON("a"
+                           << "m"));
+}
+
+TEST(QueryTargetingCacheTest, TightestBoundsOfSameFieldAreUsed) {
+    QueryTargetingCache cache(ShardKeyPattern(BSON("a" << 1)), true);
+
+    assertSingleRange(cache.getRanges(fromjson("{a: {$gt: 1, $gte: 3, $lt: 9, $lte: 7}}"),
+                                      BSONObj()),
+                      BSON("a" << 3),
+                      BSON("a" << 7));
+}
+
+TEST(QueryTargetingCacheTest, CompoundShardKey) {
+    QueryTargetingCache cache(ShardKeyPattern(BSON("a" << 1 << "b" << 1 << "c" << 1)), true);
+
+    assertSingleRange(cache.getRanges(fromjson("{c: 3, b: 2, a: 1}"), BSONObj()),
+                      BSON("a" << 1 << "b" << 2 << "c" << 3),
+                      BSON("a" << 1 << "b" << 2 << "c" << 3));
+
+    // The fields after the first one, which is not bounded to a single value, can have any value.
+    assertSingleRange(cache.getRanges(fromjson("{a: 1, b: {$gte: 2, $lte: 4}, c: 3}"), BSONObj()),
+                      BSON("a" << 1 << "b" << 2 << "c" << MINKEY),
+                      BSON("a" << 1 << "b" << 4 << "c" << MAXKEY));
+    assertSingleRange(cache.getRanges(fromjson("{a: 1, c: 3}"), BSONObj()),
+                      BSON("a" << 1 << "b" << MINKEY << "c" << MINKEY),
+                      BSON("a" << 1 << "b" << MAXKEY << "c" << MAXKEY));
+}
+
+TEST(QueryTargetingCacheTest, QueryWithoutShardKeyTargetsAllValues) {
+    QueryTargetingCache cache(ShardKeyPattern(BSON("a" << 1)), true);
+
+    assertSingleRange(
+        cache.getRanges(BSONObj(), BSONObj()), BSON("a" << MINKEY), BSON("a" << MAXKEY));
+    assertSingleRange(cache.getRanges(fromjson("{b: 1, ab: 2, a: {$ne: 3}}"), BSONObj()),
+                      BSON("a" << MINKEY),
+                      BSON("a" << MAXKEY));
+}
+
+TEST(QueryTargetingCacheTest, HashedShardKey) {
+    QueryTargetingCache cache(ShardKeyPattern(BSON("a"
+                                                   << "hashed")),
+                              true);
+
+    const long long hash = BSONElementHasher::hash64(BSON("" << 5).firstElement(),
+                                                     BSONElementHasher::DEFAULT_HASH_SEED);
+    assertSingleRange(
+        cache.getRanges(fromjson("{a: 5}"), BSONObj()), BSON("a" << hash), BSON("a" << hash));
+
+    // Ranges of values are spread over all hashes.
+    assertSingleRange(cache.getRanges(fromjson("{a: {$gt: 5}}"), BSONObj()),
+                      BSON("a" << MINKEY),
+                      BSON("a" << MAXKEY));
+}
+
+TEST(QueryTargetingCacheTest, UnsupportedQueriesMustBePlanned) {
+    QueryTargetingCache cache(ShardKeyPattern(BSON("a.b" << 1)), true);
+
+    ASSERT_FALSE(cache.getRanges(fromjson("{$or: [{'a.b': 1}, {'a.b': 2}]}"), BSONObj()));
+    ASSERT_FALSE(cache.getRanges(fromjson("{'a.b': {$in: [1, 2]}}"), BSONObj()));
+    ASSERT_FALSE(cache.getRanges(fromjson("{'a.b': /^x/}"), BSONObj()));
+    ASSERT_FALSE(cache.getRanges(fromjson("{'a.b': null}"), BSONObj()));
+    ASSERT_FALSE(cache.getRanges(fromjson("{'a.b': [1, 2]}"), BSONObj()));
+    ASSERT_FALSE(cache.getRanges(fromjson("{'a.b': {c: 1}}"), BSONObj()));
+    ASSERT_FALSE(cache.getRanges(fromjson("{c: {$exists: true}}"), BSONObj()));
+
+    // Predicates on paths into or above a shard key field.
+    ASSERT_FALSE(cache.getRanges(fromjson("{a: 1}"), BSONObj()));
+    ASSERT_FALSE(cache.getRanges(fromjson("{'a.b.c': 1}"), BSONObj()));
+    ASSERT_EQ(2U, cache.size());
+
+    assertSingleRange(cache.getRanges(fromjson("{'a.b': 1, 'a.c': 2}"), BSONObj()),
+                      BSON("a.b" << 1),
+                      BSON("a.b" << 1));
+}
+
+TEST(QueryTargetingCacheTest, StringsAreOnlyTargetedWithSimpleCollation) {
+    QueryTargetingCache cache(ShardKeyPattern(BSON("a" << 1)), false);
+
+    // The default collation of the collection is not simple.
+    ASSERT_FALSE(cache.getRanges(fromjson("{a: 'x'}"), BSONObj()));
+    assertSingleRange(
+        cache.getRanges(fromjson("{a: 1, b: 'x'}"), BSONObj()), BSON("a" << 1), BSON("a" << 1));
+
+    assertSingleRange(cache.getRanges(fromjson("{a: 'x'}"), fromjson("{locale: 'simple'}")),
+                      BSON("a"
+                           << "x"),
+                      BSON("a"
+                           << "x"));
+    ASSERT_FALSE(cache.getRanges(fromjson("{a: 1}"), fromjson("{locale: 'fr'}")));
+}
+
+}  // namespace
+}  // namespace mongo
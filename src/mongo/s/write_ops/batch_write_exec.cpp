@@ -32,12 +32,17 @@
 
 #include "mongo/s/write_ops/batch_write_exec.h"
 
+#include <algorithm>
+#include <deque>
+#include <map>
+
 #include "mongo/base/error_codes.h"
-#include "mongo/base/owned_pointer_map.h"
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/base/status.h"
 #include "mongo/bson/util/builder.h"
 #include "mongo/client/connection_string.h"
 #include "mongo/client/remote_command_targeter.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/client/multi_command_dispatch.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
@@ -47,7 +52,6 @@
 
 namespace mongo {
 
-using std::make_pair;
 using std::stringstream;
 using std::vector;
 
@@ -56,13 +60,39 @@ BatchWriteExec::BatchWriteExec(NSTargeter* targeter, MultiCommandDispatch* dispa
 
 namespace {
 
+// Number of child batches of an unordered write which may be outstanding on a single host at
+// once. The next batch for a host is sent as soon as the response to an earlier one comes back.
+MONGO_EXPORT_SERVER_PARAMETER(maxInFlightWriteBatchesPerShard, int, 2);
+
 //
-// Map which allows associating ConnectionString hosts with TargetedWriteBatches
+// The child batches of a round which are associated with a particular ConnectionString host.
 // This is needed since the dispatcher only returns hosts with responses.
 //
 
+struct HostBatches {
+    // Targeted, but not sent yet
+    std::deque<TargetedWriteBatch*> unsent;
+
+    // Sent, in the order the responses will be received
+    std::deque<TargetedWriteBatch*> pending;
+};
+
 // TODO: Unordered map?
-typedef OwnedPointerMap<ConnectionString, TargetedWriteBatch> OwnedHostBatchMap;
+typedef std::map<ConnectionString, HostBatches> HostBatchesMap;
+
+// Returns true if nothing has been targeted yet or if some host could have another batch in flight,
+// but has none queued to send to it. Slow hosts must not keep the others from getting more work.
+bool hasIdleHost(const HostBatchesMap& hostBatches, size_t maxInFlightPerHost) {
+    if (hostBatches.empty())
+        return true;
+
+    for (HostBatchesMap::const_iterator it = hostBatches.begin(); it != hostBatches.end(); ++it) {
+        if (it->second.unsent.empty() && it->second.pending.size() < maxInFlightPerHost)
+            return true;
+    }
+
+    return false;
+}
 }
 
 static void buildErrorFrom(const Status& status, WriteErrorDetail* error) {
@@ -125,191 +155,215 @@ void BatchWriteExec::executeBatch(OperationContext* txn,
         //    exactly when the metadata changed.
         //
 
+        // Every child batch targeted during this round, whether sent yet or not
         OwnedPointerVector<TargetedWriteBatch> childBatchesOwned;
-        vector<TargetedWriteBatch*>& childBatches = childBatchesOwned.mutableVector();
-
-        // If we've already had a targeting error, we've refreshed the metadata once and can
-        // record target errors definitively.
-        bool recordTargetErrors = refreshedTargeter;
-        Status targetStatus =
-            batchOp.targetBatch(txn, *_targeter, recordTargetErrors, &childBatches);
-        if (!targetStatus.isOK()) {
-            // Don't do anything until a targeter refresh
-            _targeter->noteCouldNotTarget();
-            refreshedTargeter = true;
-            ++stats->numTargetErrors;
-            dassert(childBatches.size() == 0u);
-        }
 
-        //
-        // Send all child batches
-        //
+        // Child batches of this round grouped by the host they need to be sent to
+        HostBatchesMap hostBatches;
 
-        size_t numSent = 0;
-        size_t numToSend = childBatches.size();
-        while (numSent != numToSend) {
-            // Collect batches out on the network, mapped by endpoint
-            OwnedHostBatchMap ownedPendingBatches;
-            OwnedHostBatchMap::MapType& pendingBatches = ownedPendingBatches.mutableMap();
+        // Unordered batches keep being targeted while earlier child batches are out on the
+        // network, so that every host always has its next batch ready to send. Ordered batches
+        // are targeted once per round, since later writes depend on the results of earlier ones.
+        bool targetMore = true;
+        const bool ordered = clientRequest.getOrdered();
+        const size_t maxInFlightPerHost =
+            ordered ? 1U : static_cast<size_t>(std::max(maxInFlightWriteBatchesPerShard.load(), 1));
 
+        while (true) {
             //
-            // Send side
+            // Target more child batches as soon as some host runs out of batches to send
             //
 
-            // Get as many batches as we can at once
-            for (vector<TargetedWriteBatch*>::iterator it = childBatches.begin();
-                 it != childBatches.end();
-                 ++it) {
-                //
-                // Collect the info needed to dispatch our targeted batch
-                //
+            if (targetMore && hasIdleHost(hostBatches, maxInFlightPerHost)) {
+                vector<TargetedWriteBatch*> childBatches;
+
+                // If we've already had a targeting error, we've refreshed the metadata once and
+                // can record target errors definitively.
+                bool recordTargetErrors = refreshedTargeter;
+                Status targetStatus =
+                    batchOp.targetBatch(txn, *_targeter, recordTargetErrors, &childBatches);
+                if (!targetStatus.isOK()) {
+                    // Don't do anything until a targeter refresh
+                    _targeter->noteCouldNotTarget();
+                    refreshedTargeter = true;
+                    ++stats->numTargetErrors;
+                    dassert(childBatches.size() == 0u);
+                }
 
-                TargetedWriteBatch* nextBatch = *it;
-                // If the batch is NULL, we sent it previously, so skip
-                if (nextBatch == NULL)
-                    continue;
+                if (!targetStatus.isOK() || ordered || childBatches.empty()) {
+                    targetMore = false;
+                }
+
+                for (vector<TargetedWriteBatch*>::iterator it = childBatches.begin();
+                     it != childBatches.end();
+                     ++it) {
+                    TargetedWriteBatch* nextBatch = *it;
+                    childBatchesOwned.mutableVector().push_back(nextBatch);
+
+                    // Figure out what host we need to dispatch our targeted batch
+                    const ReadPreferenceSetting readPref(ReadPreference::PrimaryOnly, TagSet());
+                    auto shardStatus = Grid::get(txn)->shardRegistry()->getShard(
+                        txn, nextBatch->getEndpoint().shardName);
 
-                // Figure out what host we need to dispatch our targeted batch
-                const ReadPreferenceSetting readPref(ReadPreference::PrimaryOnly, TagSet());
-                auto shardStatus = Grid::get(txn)->shardRegistry()->getShard(
-                    txn, nextBatch->getEndpoint().shardName);
-
-                bool resolvedHost = false;
-                ConnectionString shardHost;
-                if (!shardStatus.isOK()) {
-                    Status status(std::move(shardStatus.getStatus()));
-
-                    // Record a resolve failure
-                    // TODO: It may be necessary to refresh the cache if stale, or maybe just
-                    // cancel and retarget the batch
-                    WriteErrorDetail error;
-                    buildErrorFrom(status, &error);
-                    LOG(4) << "unable to send write batch to " << nextBatch->getEndpoint().shardName
-                           << causedBy(status);
-                    batchOp.noteBatchError(*nextBatch, error);
-                } else {
-                    auto shard = shardStatus.getValue();
-
-                    auto swHostAndPort = shard->getTargeter()->findHostNoWait(readPref);
-                    if (!swHostAndPort.isOK()) {
+                    bool resolvedHost = false;
+                    ConnectionString shardHost;
+                    if (!shardStatus.isOK()) {
+                        Status status(std::move(shardStatus.getStatus()));
 
                         // Record a resolve failure
                         // TODO: It may be necessary to refresh the cache if stale, or maybe just
                         // cancel and retarget the batch
                         WriteErrorDetail error;
-                        buildErrorFrom(swHostAndPort.getStatus(), &error);
+                        buildErrorFrom(status, &error);
                         LOG(4) << "unable to send write batch to "
-                               << nextBatch->getEndpoint().shardName
-                               << causedBy(swHostAndPort.getStatus());
+                               << nextBatch->getEndpoint().shardName << causedBy(status);
                         batchOp.noteBatchError(*nextBatch, error);
                     } else {
-                        shardHost = ConnectionString(std::move(swHostAndPort.getValue()));
-                        resolvedHost = true;
+                        auto shard = shardStatus.getValue();
+
+                        auto swHostAndPort = shard->getTargeter()->findHostNoWait(readPref);
+                        if (!swHostAndPort.isOK()) {
+
+                            // Record a resolve failure
+                            // TODO: It may be necessary to refresh the cache if stale, or maybe
+                            // just cancel and retarget the batch
+                            WriteErrorDetail error;
+                            buildErrorFrom(swHostAndPort.getStatus(), &error);
+                            LOG(4) << "unable to send write batch to "
+                                   << nextBatch->getEndpoint().shardName
+                                   << causedBy(swHostAndPort.getStatus());
+                            batchOp.noteBatchError(*nextBatch, error);
+                        } else {
+                            shardHost = ConnectionString(std::move(swHostAndPort.getValue()));
+                            resolvedHost = true;
+                        }
                     }
-                }
 
-                if (!resolvedHost) {
-                    ++stats->numResolveErrors;
+                    if (!resolvedHost) {
+                        // We're done with this batch
+                        ++stats->numResolveErrors;
+                        continue;
+                    }
 
-                    // We're done with this batch
-                    // Clean up when we can't resolve a host
-                    delete *it;
-                    *it = NULL;
-                    --numToSend;
-                    continue;
+                    hostBatches[shardHost].unsent.push_back(nextBatch);
                 }
+            }
 
-                // If we already have a batch for this host, wait until the next time
-                OwnedHostBatchMap::MapType::iterator pendingIt = pendingBatches.find(shardHost);
-                if (pendingIt != pendingBatches.end())
-                    continue;
-
-                //
-                // We now have all the info needed to dispatch the batch
-                //
+            //
+            // Send side
+            //
 
-                BatchedCommandRequest request(clientRequest.getBatchType());
-                batchOp.buildBatchRequest(*nextBatch, &request);
+            // Keep up to maxInFlightPerHost batches outstanding on each host. We'll only get
+            // several batches for the same host in one targeting pass if we have broadcast and
+            // non-broadcast endpoints for the same host.
+            for (HostBatchesMap::iterator it = hostBatches.begin(); it != hostBatches.end();
+                 ++it) {
+                const ConnectionString& shardHost = it->first;
+                HostBatches& batches = it->second;
 
-                // Internally we use full namespaces for request/response, but we send the
-                // command to a database with the collection name in the request.
-                NamespaceString nss(request.getNS());
-                request.setNS(nss);
+                while (!batches.unsent.empty() && batches.pending.size() < maxInFlightPerHost) {
+                    TargetedWriteBatch* nextBatch = batches.unsent.front();
+                    batches.unsent.pop_front();
 
-                LOG(4) << "sending write batch to " << shardHost.toString() << ": "
-                       << redact(request.toString());
+                    BatchedCommandRequest request(clientRequest.getBatchType());
+                    batchOp.buildBatchRequest(*nextBatch, &request);
 
-                _dispatcher->addCommand(shardHost, nss.db(), request.toBSON());
+                    // Internally we use full namespaces for request/response, but we send the
+                    // command to a database with the collection name in the request.
+                    NamespaceString nss(request.getNS());
+                    request.setNS(nss);
 
-                // Indicate we're done by setting the batch to NULL
-                // We'll only get duplicate hostEndpoints if we have broadcast and non-broadcast
-                // endpoints for the same host, so this should be pretty efficient without
-                // moving stuff around.
-                *it = NULL;
+                    LOG(4) << "sending write batch to " << shardHost.toString() << ": "
+                           << redact(request.toString());
 
-                // Recv-side is responsible for cleaning up the nextBatch when used
-                pendingBatches.insert(make_pair(shardHost, nextBatch));
+                    _dispatcher->addCommand(shardHost, nss.db(), request.toBSON());
+                    batches.pending.push_back(nextBatch);
+                }
             }
 
-            // Send them all out
+            // Send out everything which was added since the last time
             _dispatcher->sendAll();
-            numSent += pendingBatches.size();
+
+            if (_dispatcher->numPending() == 0) {
+                // Every child batch could have failed to resolve a host, in which case we may
+                // still have more to target
+                if (targetMore)
+                    continue;
+
+                break;
+            }
 
             //
             // Recv side
             //
 
-            while (_dispatcher->numPending() > 0) {
-                // Get the response
-                ConnectionString shardHost;
-                BatchedCommandResponse response;
-                Status dispatchStatus = _dispatcher->recvAny(&shardHost, &response);
-
-                // Get the TargetedWriteBatch to find where to put the response
-                dassert(pendingBatches.find(shardHost) != pendingBatches.end());
-                TargetedWriteBatch* batch = pendingBatches.find(shardHost)->second;
-
-                if (dispatchStatus.isOK()) {
-                    TrackedErrors trackedErrors;
-                    trackedErrors.startTracking(ErrorCodes::StaleShardVersion);
-
-                    LOG(4) << "write results received from " << shardHost.toString() << ": "
-                           << redact(response.toString());
-
-                    // Dispatch was ok, note response
-                    batchOp.noteBatchResponse(*batch, response, &trackedErrors);
-
-                    // Note if anything was stale
-                    const vector<ShardError*>& staleErrors =
-                        trackedErrors.getErrors(ErrorCodes::StaleShardVersion);
-
-                    if (staleErrors.size() > 0) {
-                        noteStaleResponses(staleErrors, _targeter);
-                        ++stats->numStaleBatches;
+            // Get the response
+            ConnectionString shardHost;
+            BatchedCommandResponse response;
+            Status dispatchStatus = _dispatcher->recvAny(&shardHost, &response);
+
+            // Responses from a host are received in the order its batches were sent
+            HostBatchesMap::iterator hostIt = hostBatches.find(shardHost);
+            dassert(hostIt != hostBatches.end() && !hostIt->second.pending.empty());
+            TargetedWriteBatch* batch = hostIt->second.pending.front();
+            hostIt->second.pending.pop_front();
+
+            if (dispatchStatus.isOK()) {
+                TrackedErrors trackedErrors;
+                trackedErrors.startTracking(ErrorCodes::StaleShardVersion);
+
+                LOG(4) << "write results received from " << shardHost.toString() << ": "
+                       << redact(response.toString());
+
+                // Dispatch was ok, note response
+                batchOp.noteBatchResponse(*batch, response, &trackedErrors);
+
+                // Note if anything was stale
+                const vector<ShardError*>& staleErrors =
+                    trackedErrors.getErrors(ErrorCodes::StaleShardVersion);
+
+                if (staleErrors.size() > 0) {
+                    noteStaleResponses(staleErrors, _targeter);
+                    ++stats->numStaleBatches;
+
+                    // Don't target anything else until the targeter has been refreshed at the end
+                    // of the round
+                    targetMore = false;
+
+                    // The batches not yet sent to this host would come back stale as well, so
+                    // retry their writes after the refresh instead of sending them
+                    WriteErrorDetail staleError;
+                    buildErrorFrom(Status(ErrorCodes::StaleShardVersion,
+                                          "write batch not sent after a stale response from its "
+                                          "host"),
+                                   &staleError);
+                    for (TargetedWriteBatch* unsentBatch : hostIt->second.unsent) {
+                        batchOp.noteBatchError(*unsentBatch, staleError);
                     }
+                    hostIt->second.unsent.clear();
+                }
 
-                    // Remember that we successfully wrote to this shard
-                    // NOTE: This will record lastOps for shards where we actually didn't update
-                    // or delete any documents, which preserves old behavior but is conservative
-                    stats->noteWriteAt(
-                        shardHost,
-                        response.isLastOpSet() ? response.getLastOp() : repl::OpTime(),
-                        response.isElectionIdSet() ? response.getElectionId() : OID());
-                } else {
-                    // Error occurred dispatching, note it
+                // Remember that we successfully wrote to this shard
+                // NOTE: This will record lastOps for shards where we actually didn't update
+                // or delete any documents, which preserves old behavior but is conservative
+                stats->noteWriteAt(
+                    shardHost,
+                    response.isLastOpSet() ? response.getLastOp() : repl::OpTime(),
+                    response.isElectionIdSet() ? response.getElectionId() : OID());
+            } else {
+                // Error occurred dispatching, note it
 
-                    stringstream msg;
-                    msg << "write results unavailable from " << shardHost.toString()
-                        << causedBy(dispatchStatus.toString());
+                stringstream msg;
+                msg << "write results unavailable from " << shardHost.toString()
+                    << causedBy(dispatchStatus.toString());
 
-                    WriteErrorDetail error;
-                    buildErrorFrom(Status(ErrorCodes::RemoteResultsUnavailable, msg.str()), &error);
+                WriteErrorDetail error;
+                buildErrorFrom(Status(ErrorCodes::RemoteResultsUnavailable, msg.str()), &error);
 
-                    LOG(4) << "unable to receive write results from " << shardHost.toString()
-                           << causedBy(redact(dispatchStatus.toString()));
+                LOG(4) << "unable to receive write results from " << shardHost.toString()
+                       << causedBy(redact(dispatchStatus.toString()));
 
-                    batchOp.noteBatchError(*batch, error);
-                }
+                batchOp.noteBatchError(*batch, error);
             }
         }
 
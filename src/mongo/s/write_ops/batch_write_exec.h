@@ -59,6 +59,9 @@ class OperationContext;
  * Both the targeter and dispatcher are assumed to be dedicated to this particular
  * BatchWriteExec instance.
  *
+ * Child batches of unordered writes are pipelined: the next batch for a shard is sent as soon
+ * as the response to an earlier one is received, up to maxInFlightWriteBatchesPerShard at once.
+ *
  */
 class BatchWriteExec {
     MONGO_DISALLOW_COPYING(BatchWriteExec);
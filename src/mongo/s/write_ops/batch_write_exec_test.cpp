@@ -52,8 +52,10 @@ using std::vector;
 namespace {
 
 const HostAndPort kTestShardHost = HostAndPort("FakeHost", 12345);
+const HostAndPort kTestShardHost2 = HostAndPort("FakeHost2", 12345);
 const HostAndPort kTestConfigShardHost = HostAndPort("FakeConfigHost", 12345);
 const string shardName = "FakeShard";
+const string shardName2 = "FakeShard2";
 
 /**
  * Mimics a single shard backend for a particular collection which can be initialized with a
@@ -79,11 +81,22 @@ public:
         targeterFactory()->addTargeterToReturn(ConnectionString(kTestShardHost),
                                                std::move(targeter));
 
-        // Set up the shard registry to contain the fake shard.
+        // Add a RemoteCommandTargeter for the second data shard.
+        std::unique_ptr<RemoteCommandTargeterMock> targeter2(
+            stdx::make_unique<RemoteCommandTargeterMock>());
+        targeter2->setConnectionStringReturnValue(ConnectionString(kTestShardHost2));
+        targeter2->setFindHostReturnValue(kTestShardHost2);
+        targeterFactory()->addTargeterToReturn(ConnectionString(kTestShardHost2),
+                                               std::move(targeter2));
+
+        // Set up the shard registry to contain the fake shards.
         ShardType shardType;
         shardType.setName(shardName);
         shardType.setHost(kTestShardHost.toString());
-        std::vector<ShardType> shards{shardType};
+        ShardType shardType2;
+        shardType2.setName(shardName2);
+        shardType2.setHost(kTestShardHost2.toString());
+        std::vector<ShardType> shards{shardType, shardType2};
         setupShards(shards);
 
         // Set up the namespace targeter to target the fake shard.
@@ -168,6 +181,100 @@ TEST_F(BatchWriteExecTest, SingleOpError) {
     ASSERT_EQUALS(stats.numRounds, 1);
 }
 
+TEST_F(BatchWriteExecTest, ManyChildBatchesOneRound) {
+    //
+    // An unordered write too large for a single child batch is sent in one round
+    //
+
+    BatchedCommandRequest request(BatchedCommandRequest::BatchType_Insert);
+    request.setNS(nss);
+    request.setOrdered(false);
+    request.setWriteConcern(BSONObj());
+    // Do single-target, multi doc batch write op spanning several child batches
+    const int numDocs = 2 * static_cast<int>(BatchedCommandRequest::kMaxWriteBatchSize) + 1;
+    for (int i = 0; i < numDocs; ++i) {
+        request.getInsertRequest()->addToDocuments(BSON("x" << i));
+    }
+
+    BatchedCommandResponse response;
+    BatchWriteExecStats stats;
+    exec->executeBatch(operationContext(), request, &response, &stats);
+    ASSERT(response.getOk());
+    ASSERT(!response.isErrDetailsSet());
+
+    ASSERT_EQUALS(stats.numRounds, 1);
+}
+
+TEST_F(BatchWriteExecTest, SlowShardDoesNotHoldBackOthers) {
+    //
+    // Responses are received from whichever shard answers first, and a shard which keeps
+    // answering is given more child batches while another shard is still busy
+    //
+
+    ShardEndpoint slowEndpoint(shardName, ChunkVersion::IGNORED());
+    ShardEndpoint fastEndpoint(shardName2, ChunkVersion::IGNORED());
+    vector<MockRange*> mockRanges;
+    mockRanges.push_back(new MockRange(slowEndpoint, nss, BSON("x" << MINKEY), BSON("x" << 0)));
+    mockRanges.push_back(new MockRange(fastEndpoint, nss, BSON("x" << 0), BSON("x" << MAXKEY)));
+    MockNSTargeter twoShardTargeter;
+    twoShardTargeter.init(mockRanges);
+
+    const ConnectionString slowHost(kTestShardHost);
+    dispatcher.setSlowHost(slowHost);
+
+    BatchedCommandRequest request(BatchedCommandRequest::BatchType_Insert);
+    request.setNS(nss);
+    request.setOrdered(false);
+    request.setWriteConcern(BSONObj());
+    // Interleave the documents so that every targeting pass has a child batch for each shard
+    const int numDocsPerShard = 3 * static_cast<int>(BatchedCommandRequest::kMaxWriteBatchSize);
+    for (int i = 0; i < numDocsPerShard; ++i) {
+        request.getInsertRequest()->addToDocuments(BSON("x" << -(i + 1)));
+        request.getInsertRequest()->addToDocuments(BSON("x" << i));
+    }
+
+    BatchWriteExec twoShardExec(&twoShardTargeter, &dispatcher);
+    BatchedCommandResponse response;
+    BatchWriteExecStats stats;
+    twoShardExec.executeBatch(operationContext(), request, &response, &stats);
+    ASSERT(response.getOk());
+    ASSERT(!response.isErrDetailsSet());
+
+    // Every child batch of the fast shard was answered before the slow shard answered at all
+    const vector<ConnectionString>& received = dispatcher.getReceivedOrder();
+    ASSERT_EQUALS(received.size(), 6U);
+    for (size_t i = 0; i < received.size(); ++i) {
+        ASSERT_EQUALS(received[i].toString(),
+                      i < 3 ? ConnectionString(kTestShardHost2).toString() : slowHost.toString());
+    }
+
+    ASSERT_EQUALS(stats.numRounds, 1);
+}
+
+TEST_F(BatchWriteExecTest, OrderedManyChildBatches) {
+    //
+    // An ordered write still sends one child batch per round
+    //
+
+    BatchedCommandRequest request(BatchedCommandRequest::BatchType_Insert);
+    request.setNS(nss);
+    request.setOrdered(true);
+    request.setWriteConcern(BSONObj());
+    // Do single-target, multi doc batch write op spanning several child batches
+    const int numDocs = 2 * static_cast<int>(BatchedCommandRequest::kMaxWriteBatchSize) + 1;
+    for (int i = 0; i < numDocs; ++i) {
+        request.getInsertRequest()->addToDocuments(BSON("x" << i));
+    }
+
+    BatchedCommandResponse response;
+    BatchWriteExecStats stats;
+    exec->executeBatch(operationContext(), request, &response, &stats);
+    ASSERT(response.getOk());
+    ASSERT(!response.isErrDetailsSet());
+
+    ASSERT_EQUALS(stats.numRounds, 3);
+}
+
 //
 // Test retryable errors
 //
@@ -202,6 +309,70 @@ TEST_F(BatchWriteExecTest, StaleOp) {
     ASSERT_EQUALS(stats.numStaleBatches, 1);
 }
 
+TEST_F(BatchWriteExecTest, StaleOpStopsSendingToHost) {
+    //
+    // Child batches not yet sent to a host which returned a stale error are retried in the next
+    // round instead of being sent
+    //
+
+    ShardEndpoint slowEndpoint(shardName, ChunkVersion::IGNORED());
+    ShardEndpoint fastEndpoint(shardName2, ChunkVersion::IGNORED());
+    vector<MockRange*> mockRanges;
+    mockRanges.push_back(new MockRange(slowEndpoint, nss, BSON("x" << MINKEY), BSON("x" << 0)));
+    mockRanges.push_back(new MockRange(fastEndpoint, nss, BSON("x" << 0), BSON("x" << MAXKEY)));
+    MockNSTargeter twoShardTargeter;
+    twoShardTargeter.init(mockRanges);
+
+    const ConnectionString slowHost(kTestShardHost);
+    dispatcher.setSlowHost(slowHost);
+
+    // The slow shard answers its first child batch with a stale error and its second one
+    // successfully. Whichever child batch it receives next fails with a non-retryable error.
+    const int maxBatchSize = static_cast<int>(BatchedCommandRequest::kMaxWriteBatchSize);
+    vector<MockWriteResult*> mockResults;
+    WriteErrorDetail staleError;
+    staleError.setErrCode(ErrorCodes::StaleShardVersion);
+    staleError.setErrMessage("mock stale error");
+    mockResults.push_back(new MockWriteResult(slowHost, staleError, maxBatchSize));
+    BatchedCommandResponse okResponse;
+    okResponse.setOk(true);
+    okResponse.setN(0);
+    mockResults.push_back(new MockWriteResult(slowHost, okResponse));
+    WriteErrorDetail unknownError;
+    unknownError.setErrCode(ErrorCodes::UnknownError);
+    unknownError.setErrMessage("mock error");
+    mockResults.push_back(new MockWriteResult(slowHost, unknownError, maxBatchSize));
+    setMockResults(mockResults);
+
+    BatchedCommandRequest request(BatchedCommandRequest::BatchType_Insert);
+    request.setNS(nss);
+    request.setOrdered(false);
+    request.setWriteConcern(BSONObj());
+    // Interleave the documents so that every targeting pass has a child batch for each shard
+    for (int i = 0; i < 3 * maxBatchSize; ++i) {
+        request.getInsertRequest()->addToDocuments(BSON("x" << -(i + 1)));
+        request.getInsertRequest()->addToDocuments(BSON("x" << i));
+    }
+
+    BatchWriteExec twoShardExec(&twoShardTargeter, &dispatcher);
+    BatchedCommandResponse response;
+    BatchWriteExecStats stats;
+    twoShardExec.executeBatch(operationContext(), request, &response, &stats);
+    ASSERT(response.getOk());
+
+    // The writes of the stale child batch are retried first, so they are the ones which fail. Had
+    // the third child batch been sent after the stale response, its writes would have failed.
+    ASSERT(response.isErrDetailsSet());
+    ASSERT_EQUALS(response.sizeErrDetails(), static_cast<size_t>(maxBatchSize));
+    for (size_t i = 0; i < response.sizeErrDetails(); ++i) {
+        ASSERT_EQUALS(response.getErrDetailsAt(i)->getErrCode(), ErrorCodes::UnknownError);
+        ASSERT_LESS_THAN(response.getErrDetailsAt(i)->getIndex(), 2 * maxBatchSize);
+    }
+
+    ASSERT_EQUALS(stats.numStaleBatches, 1);
+    ASSERT_EQUALS(stats.numRounds, 2);
+}
+
 TEST_F(BatchWriteExecTest, MultiStaleOp) {
     //
     // Retry op in exec multiple times b/c of stale config
@@ -136,6 +136,13 @@ public:
         return _psock->getSockCreationMicroSec();
     }
 
+    /**
+     * Returns the socket underneath this port, so that it can be polled together with others.
+     */
+    Socket& getSocket() {
+        return *_psock;
+    }
+
 private:
     // this is the parsed version of remote
     HostAndPort _remoteParsed;
@@ -649,6 +649,16 @@ const int Socket::errorPollIntervalSecs(5);
 
 // Patch to allow better tolerance of flaky network connections that get broken
 // while we aren't looking.
+bool Socket::hasBufferedData() const {
+#ifdef MONGO_CONFIG_SSL
+    if (_sslConnection) {
+        return SSL_pending(_sslConnection->ssl) > 0 ||
+            BIO_ctrl_pending(_sslConnection->internalBIO) > 0;
+    }
+#endif
+    return false;
+}
+
 // TODO: Remove when better async changes come.
 //
 // isStillConnected() polls the socket at max every Socket::errorPollIntervalSecs to determine
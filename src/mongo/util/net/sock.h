@@ -193,6 +193,12 @@ public:
     void setTimeout(double secs);
     bool isStillConnected();
 
+    /**
+     * Returns true if data was read off the socket, but not yet returned by recv(), as happens
+     * with SSL records. Polling the descriptor does not report such data.
+     */
+    bool hasBufferedData() const;
+
     void setHandshakeReceived() {
         _awaitingHandshake = false;
     }